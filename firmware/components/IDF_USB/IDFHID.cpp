@@ -24,14 +24,16 @@ typedef struct {
 } tinyusb_hid_device_t;
 
 SemaphoreHandle_t IDFHID::tinyusb_hid_device_input_sem = nullptr;
+static IDFHIDDevice *tinyusb_hid_devices[USB_HID_DEVICES_MAX] = {nullptr}; // Devices attached to each interface number
 bool tinyusb_hid_is_initialized = false;
 static hid_interface_protocol_enum_t tinyusb_interface_protocol = HID_ITF_PROTOCOL_NONE;
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
 static const char *tinyusb_hid_device_report_types[4] = {"INVALID", "INPUT", "OUTPUT", "FEATURE"};
 #endif
 
-IDFHID::IDFHID(uint8_t itf) {
+IDFHID::IDFHID(uint8_t itf, bool reportIds) {
   this->itf = itf;
+  this->reportIds = reportIds;
 
   //Temp setting for BOOT keyboard
   if(itf == 0){
@@ -67,6 +69,16 @@ bool IDFHID::ready() {
   return tud_hid_n_ready(itf);
 }
 
+void IDFHID::attach(IDFHIDDevice *device) {
+  if (itf < USB_HID_DEVICES_MAX) {
+    tinyusb_hid_devices[itf] = device;
+  }
+}
+
+IDFHIDDevice *IDFHID::getDevice(uint8_t itf) {
+  return (itf < USB_HID_DEVICES_MAX) ? tinyusb_hid_devices[itf] : nullptr;
+}
+
 
 bool IDFHID::SendReport(uint8_t id, const void *data, size_t len, uint32_t timeout_ms) {  
   // If we're configured to support boot protocol, and the host has requested boot protocol, prevent
@@ -76,6 +88,6 @@ bool IDFHID::SendReport(uint8_t id, const void *data, size_t len, uint32_t timeo
   //printf("Effective ID: %d %d\n\r", effective_id, itf);
   // DEBUG_SERIAL_PRINTF("Time sending queued keyboard character: %lld us\n", esp_timer_get_time());
 
-  return tud_hid_n_report(itf, 0, data, len);
+  return tud_hid_n_report(itf, reportIds ? effective_id : 0, data, len);
 
 }
\ No newline at end of file
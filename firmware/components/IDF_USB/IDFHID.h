@@ -59,7 +59,7 @@ class IDFHIDDevice {
 
 class IDFHID {
 public:
-  IDFHID(uint8_t itf = 0);
+  IDFHID(uint8_t itf = 0, bool reportIds = false);
   void begin(void);
   void end(void);
   bool lock();
@@ -67,8 +67,13 @@ public:
   bool ready(void);
   bool SendReport(uint8_t report_id, const void *data, size_t len, uint32_t timeout_ms = 100);
   static bool addDevice(IDFHIDDevice *device, uint16_t descriptor_len);
+
+  // Route the interface's GET/SET_REPORT requests to a device (see tud_hid_*_report_cb)
+  void attach(IDFHIDDevice *device);
+  static IDFHIDDevice *getDevice(uint8_t itf);
 private:
   uint8_t itf;
+  bool reportIds; // Interface descriptor declares report IDs, so prefix them on input reports
   static SemaphoreHandle_t tinyusb_hid_device_input_sem;
 
 };
\ No newline at end of file
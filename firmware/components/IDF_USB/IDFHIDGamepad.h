@@ -14,11 +14,7 @@
 
 #pragma once
 
-#include "soc/soc_caps.h"
-#if SOC_USB_OTG_SUPPORTED
-
-#include "USBHID.h"
-#if CONFIG_TINYUSB_HID_ENABLED
+#include "IDFHID.h"
 
 /// Standard Gamepad Buttons Naming from Linux input event codes
 /// https://github.com/torvalds/linux/blob/master/include/uapi/linux/input-event-codes.h
@@ -54,9 +50,9 @@
 #define HAT_LEFT       7
 #define HAT_UP_LEFT    8
 
-class USBHIDGamepad : public USBHIDDevice {
+class IDFHIDGamepad : public IDFHIDDevice {
 private:
-  USBHID hid;
+  IDFHID hid;
   int8_t _x;          ///< Delta x  movement of left analog-stick
   int8_t _y;          ///< Delta y  movement of left analog-stick
   int8_t _z;          ///< Delta z  movement of right analog-joystick
@@ -68,7 +64,7 @@ private:
   bool write();
 
 public:
-  USBHIDGamepad(void);
+  IDFHIDGamepad(uint8_t itf);
   void begin(void);
   void end(void);
 
@@ -84,10 +80,4 @@ public:
   bool releaseButton(uint8_t button);
 
   bool send(int8_t x, int8_t y, int8_t z, int8_t rz, int8_t rx, int8_t ry, uint8_t hat, uint32_t buttons);
-
-  // internal use
-  uint16_t _onGetDescriptor(uint8_t *buffer);
 };
-
-#endif /* CONFIG_TINYUSB_HID_ENABLED */
-#endif /* SOC_USB_OTG_SUPPORTED */
@@ -25,7 +25,7 @@
 
 const uint8_t report_descriptor[] = {TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(HID_REPORT_ID_KEYBOARD))};
 
-IDFHIDKeyboard::IDFHIDKeyboard(uint8_t itf) : hid(itf), _asciimap(KeyboardLayout_en_US), shiftKeyReports(false) {
+IDFHIDKeyboard::IDFHIDKeyboard(uint8_t itf) : hid(itf), _asciimap(KeyboardLayout_en_US), _unicodemap(nullptr), _unicodeFallback(UNICODE_FALLBACK_NONE), shiftKeyReports(false), _leds(0), _ledReports(0), _ledSemaphore(nullptr), _ledCallback(nullptr), _lockCompensation(true) {
   static bool initialized = false;
   if (!initialized) {
     //initialized = true;
@@ -34,14 +34,25 @@ IDFHIDKeyboard::IDFHIDKeyboard(uint8_t itf) : hid(itf), _asciimap(KeyboardLayout
   }
 }
 
-void IDFHIDKeyboard::begin(const uint8_t *layout) {
+void IDFHIDKeyboard::begin(const uint8_t *layout, const KeyboardUnicodeLayout *unicode) {
   _asciimap = layout;
+  _unicodemap = unicode;
+  if (_ledSemaphore == nullptr) {
+    _ledSemaphore = xSemaphoreCreateBinary();
+  }
+  hid.attach(this); // Receive the host's LED output reports
   hid.begin();
 }
 
 
 void IDFHIDKeyboard::end() {}
 
+// Switch layouts without restarting the device, only call this between characters
+void IDFHIDKeyboard::setLayout(const uint8_t *layout, const KeyboardUnicodeLayout *unicode) {
+  _asciimap = layout;
+  _unicodemap = unicode;
+}
+
 
 void IDFHIDKeyboard::sendReport(KeyReport *keys) {
   hid_keyboard_report_t report;
@@ -103,6 +114,108 @@ size_t IDFHIDKeyboard::releaseRaw(uint8_t k) {
   return 1;
 }
 
+void IDFHIDKeyboard::_onOutput(uint8_t report_id, const uint8_t *buffer, uint16_t len) {
+  if (len == 0) {
+    return;
+  }
+  uint8_t previous = _leds;
+  _leds = buffer[0];
+  _ledReports++;
+  if (_ledSemaphore != nullptr) {
+    xSemaphoreGive(_ledSemaphore);
+  }
+  if (_ledCallback != nullptr && previous != _leds) {
+    _ledCallback(_leds);
+  }
+}
+
+void IDFHIDKeyboard::onLedChange(IDFHIDKeyboardLedCallback callback) {
+  _ledCallback = callback;
+}
+
+void IDFHIDKeyboard::setLockCompensation(bool set) {
+  _lockCompensation = set;
+}
+
+// Flip the SHIFT flag of a letter's layout entry while the host has caps lock on,
+// so press() and release() produce the character the layout maps it to
+uint8_t IDFHIDKeyboard::lockAdjust(uint8_t k) {
+  uint8_t usage = k & ~SHIFT;
+  if (_lockCompensation && (_leds & LED_CAPSLOCK) && usage >= HID_KEY_A && usage <= HID_KEY_Z) {
+    return k ^ SHIFT;
+  }
+  return k;
+}
+
+uint8_t IDFHIDKeyboard::leds(void) {
+  return _leds;
+}
+
+// False until the host has sent at least one LED report, some hosts never do
+bool IDFHIDKeyboard::hostReportsLeds(void) {
+  return _ledReports > 0;
+}
+
+// Block until (leds & mask) == value or the timeout expires
+bool IDFHIDKeyboard::waitForLeds(uint8_t mask, uint8_t value, uint32_t timeout_ms) {
+  if (_ledSemaphore == nullptr) {
+    return false;
+  }
+
+  TickType_t start = xTaskGetTickCount();
+  TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+
+  while ((_leds & mask) != value) {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= timeout || xSemaphoreTake(_ledSemaphore, timeout - elapsed) != pdTRUE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Apply one raw key event to the held key report without sending it
+// Returns true only if the report changed, so repeated downs (or ups) of the same key cost nothing
+bool IDFHIDKeyboard::setRaw(uint8_t k, bool down) {
+  if (k >= 0xE0 && k < 0xE8) {
+    // it's a modifier key
+    uint8_t modifiers = down ? (_keyReport.modifiers | (1 << (k - 0xE0))) : (_keyReport.modifiers & ~(1 << (k - 0xE0)));
+    bool changed = modifiers != _keyReport.modifiers;
+    _keyReport.modifiers = modifiers;
+    return changed;
+  }
+
+  if (!k || k >= 0xA5) {
+    return false;
+  }
+
+  uint8_t slot = 6;
+  for (uint8_t i = 0; i < 6; i++) {
+    if (_keyReport.keys[i] == k) {
+      if (down) {
+        return false; // Already held
+      }
+      _keyReport.keys[i] = 0x00;
+      return true;
+    }
+    if (slot == 6 && _keyReport.keys[i] == 0x00) {
+      slot = i;
+    }
+  }
+
+  // Not held: a release is a no-op, a press needs a free slot (6KRO)
+  if (!down || slot == 6) {
+    return false;
+  }
+  _keyReport.keys[slot] = k;
+  return true;
+}
+
+// Send the held key report as is
+void IDFHIDKeyboard::sendState(void) {
+  sendReport(&_keyReport);
+}
+
 // press() adds the specified key (printing, non-printing, or modifier)
 // to the persistent key report and sends the report.  Because of the way
 // USB HID works, the host acts like the key remains pressed until we
@@ -118,6 +231,7 @@ size_t IDFHIDKeyboard::press(uint8_t k) {
     if (!k) {
       return 0;
     }
+    k = lockAdjust(k);
     if ((k & SHIFT) == SHIFT) {  // it's a capital letter or other character reached with shift
       // At boot, some PCs need a separate report with the shift key down like a real keyboard.
       if (shiftKeyReports) {
@@ -152,6 +266,7 @@ size_t IDFHIDKeyboard::release(uint8_t k) {
     if (!k) {
       return 0;
     }
+    k = lockAdjust(k);
     if ((k & SHIFT) == SHIFT) {  // it's a capital letter or other character reached with shift
       if (shiftKeyReports) {
         releaseRaw(k & 0x7F);    // Release key without shift modifier
@@ -211,7 +326,8 @@ size_t IDFHIDKeyboard::sendKeycode(uint8_t* encodedKeys, uint8_t numKeys) {
   
   uint8_t keyIndex = 0;
   
-  for (uint8_t i = 0; i < 6 && keyIndex < 6; i++) {
+  // Modifiers don't take a key slot, so walk every encoded key until the 6 slots are full
+  for (uint8_t i = 0; i < numKeys && keyIndex < 6; i++) {
     uint8_t k = encodedKeys[i];
     
     if (k >= 0x88) {  // Non-printing key (not a modifier)
@@ -240,10 +356,134 @@ size_t IDFHIDKeyboard::sendKeycode(uint8_t* encodedKeys, uint8_t numKeys) {
   }
   
   // Send the customReport
-  IDFHIDKeyboard keyboard; // Use your actual instance
-  keyboard.sendReport(&customReport);
+  sendReport(&customReport);
+
+  return keyIndex;
+}
+
+void IDFHIDKeyboard::setUnicodeFallback(uint8_t mode) {
+  _unicodeFallback = mode;
+}
+
+// Tap a code point table entry: its dead key first if it has one, then the key itself
+// The key is added to the held key state like press() does, so raw keys held by the client stay down throughout
+void IDFHIDKeyboard::tapEntry(uint16_t entry) {
+  uint8_t dead = UNI_DEAD_INDEX(entry);
+  if (dead) {
+    tapEntry(_unicodemap->deadKeys[dead]);
+  }
+
+  uint8_t usage = UNI_USAGE(entry);
+  bool shift = (entry & UNI_SHIFT) != 0;
+  if (_lockCompensation && (_leds & LED_CAPSLOCK) && usage >= HID_KEY_A && usage <= HID_KEY_Z) {
+    shift = !shift;
+  }
+
+  KeyReport report = _keyReport;
+  report.modifiers |= (shift ? 0x02 : 0) | ((entry & UNI_ALTGR) ? 0x40 : 0);
+  for (uint8_t i = 0; i < 6; i++) {
+    if (report.keys[i] == 0 || report.keys[i] == usage) {
+      report.keys[i] = usage;
+      break;
+    }
+  }
+  sendReport(&report);
+  sendReport(&_keyReport);
+}
+
+// Type the low <digits> hex digits of value through the layout, most significant first
+void IDFHIDKeyboard::tapHex(uint32_t value, uint8_t digits) {
+  while (digits--) {
+    write((uint8_t)"0123456789abcdef"[(value >> (digits * 4)) & 0x0F]);
+  }
+}
+
+// Map a decimal digit to its numeric keypad usage (keypad 1-9 are contiguous, 0 comes after 9)
+static uint8_t keypadDigit(uint8_t digit) {
+  return digit == 0 ? HID_KEY_KEYPAD_0 : (uint8_t)(HID_KEY_KEYPAD_1 + digit - 1);
+}
+
+// Ask the host OS to compose a character the layout has no key for
+size_t IDFHIDKeyboard::writeFallback(uint32_t codepoint) {
+  switch (_unicodeFallback) {
+    case UNICODE_FALLBACK_ALT_NUMPAD: {
+      if (codepoint > 0xFFFF) {
+        return 0;  // The numpad entry only reaches the BMP
+      }
+
+      // Numpad digits only compose with num lock on, restore the host's state afterwards
+      bool numLockToggled = false;
+      if (!(_leds & LED_NUMLOCK)) {
+        write(KEY_NUM_LOCK);
+        numLockToggled = waitForLeds(LED_NUMLOCK, LED_NUMLOCK, 100);
+      }
+
+      pressRaw(HID_KEY_ALT_LEFT);
+      if (codepoint >= 0xA0 && codepoint <= 0xFF) {
+        // Alt+0ddd goes through the ANSI code page, which matches Latin-1 in this range
+        uint8_t digits[4] = {0, (uint8_t)(codepoint / 100), (uint8_t)(codepoint / 10 % 10), (uint8_t)(codepoint % 10)};
+        for (uint8_t i = 0; i < 4; i++) {
+          pressRaw(keypadDigit(digits[i]));
+          releaseRaw(keypadDigit(digits[i]));
+        }
+      } else {
+        pressRaw(HID_KEY_KEYPAD_ADD);
+        releaseRaw(HID_KEY_KEYPAD_ADD);
+        tapHex(codepoint, 4);
+      }
+      releaseRaw(HID_KEY_ALT_LEFT);
+
+      if (numLockToggled) {
+        write(KEY_NUM_LOCK);
+        waitForLeds(LED_NUMLOCK, 0, 100);
+      }
+      return 1;
+    }
+
+    case UNICODE_FALLBACK_CTRL_SHIFT_U:
+      pressRaw(HID_KEY_CONTROL_LEFT);
+      pressRaw(HID_KEY_SHIFT_LEFT);
+      pressRaw(HID_KEY_U);
+      releaseAll();
+      tapHex(codepoint, codepoint > 0xFFFF ? 6 : 4);
+      write(' ');  // Commit the character
+      return 1;
+
+    case UNICODE_FALLBACK_MAC_HEX:
+      pressRaw(HID_KEY_ALT_LEFT);
+      if (codepoint > 0xFFFF) {
+        // Unicode Hex Input takes characters outside the BMP as a surrogate pair
+        codepoint -= 0x10000;
+        tapHex(0xD800 | (codepoint >> 10), 4);
+        tapHex(0xDC00 | (codepoint & 0x3FF), 4);
+      } else {
+        tapHex(codepoint, 4);
+      }
+      releaseRaw(HID_KEY_ALT_LEFT);
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+// Type one code point. The code point table is checked first since it also covers ASCII
+// characters the layout array can't reach (dead key + space, Shift+AltGr), then the
+// layout array, then the host's own Unicode input method
+size_t IDFHIDKeyboard::writeUnicode(uint32_t codepoint) {
+  uint16_t entry = keyboardUnicodeLookup(_unicodemap, codepoint);
+  if (entry) {
+    tapEntry(entry);
+    return 1;
+  }
+
+  if (codepoint < 0x80) {
+    if (_asciimap[codepoint] || codepoint < 0x20) {
+      return write((uint8_t)codepoint);
+    }
+  }
 
-  return 0;
+  return writeFallback(codepoint);
 }
 
 // bool IDFHIDKeyboard::lock() {
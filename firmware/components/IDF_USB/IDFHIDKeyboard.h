@@ -23,6 +23,7 @@
 
 #include "Print.h"
 #include "IDFHID.h"
+#include "KeyboardUnicode.h"
 
 typedef union {
   struct {
@@ -48,6 +49,23 @@ extern const uint8_t KeyboardLayout_da_DK[];
 extern const uint8_t KeyboardLayout_hu_HU[];
 extern const uint8_t KeyboardLayout_pt_BR[];
 
+// Code point tables for the same layouts, en_US needs none
+extern const KeyboardUnicodeLayout KeyboardUnicode_de_DE;
+extern const KeyboardUnicodeLayout KeyboardUnicode_es_ES;
+extern const KeyboardUnicodeLayout KeyboardUnicode_fr_FR;
+extern const KeyboardUnicodeLayout KeyboardUnicode_it_IT;
+extern const KeyboardUnicodeLayout KeyboardUnicode_pt_PT;
+extern const KeyboardUnicodeLayout KeyboardUnicode_sv_SE;
+extern const KeyboardUnicodeLayout KeyboardUnicode_da_DK;
+extern const KeyboardUnicodeLayout KeyboardUnicode_hu_HU;
+extern const KeyboardUnicodeLayout KeyboardUnicode_pt_BR;
+
+// How writeUnicode() types characters the layout has no key for
+#define UNICODE_FALLBACK_NONE         0  // Skip the character
+#define UNICODE_FALLBACK_ALT_NUMPAD   1  // Windows: Alt+0ddd, Alt+numpad plus and hex above U+00FF (EnableHexNumpad)
+#define UNICODE_FALLBACK_CTRL_SHIFT_U 2  // Linux IBus/GTK: Ctrl+Shift+U, hex, space
+#define UNICODE_FALLBACK_MAC_HEX      3  // macOS "Unicode Hex Input" source: hold Option, type 4 hex digits
+
 #define KEY_LEFT_CTRL   0x80
 #define KEY_LEFT_SHIFT  0x81
 #define KEY_LEFT_ALT    0x82
@@ -127,6 +145,9 @@ extern const uint8_t KeyboardLayout_pt_BR[];
 #define KEY_KP_0        0xEA
 #define KEY_KP_DOT      0xEB
 
+// Called with the new LED_* bits whenever the host changes its keyboard LEDs
+typedef void (*IDFHIDKeyboardLedCallback)(uint8_t leds);
+
 //  Low level key report: up to 6 keys and shift, ctrl etc at once
 export typedef struct {
   uint8_t modifiers;
@@ -140,17 +161,33 @@ private:
   KeyReport _keyReport;
   KeyReport customReport;
   const uint8_t *_asciimap;
+  const KeyboardUnicodeLayout *_unicodemap;
+  uint8_t _unicodeFallback;
   bool shiftKeyReports;
+  volatile uint8_t _leds;          // Last LED state reported by the host
+  volatile uint32_t _ledReports;   // LED output reports received so far
+  SemaphoreHandle_t _ledSemaphore; // Given on every LED output report
+  IDFHIDKeyboardLedCallback _ledCallback;
+  bool _lockCompensation;          // Type letters in the intended case while the host has caps lock on
+  uint8_t lockAdjust(uint8_t k);
+  void tapEntry(uint16_t entry);
+  void tapHex(uint32_t value, uint8_t digits);
+  size_t writeFallback(uint32_t codepoint);
 
 public:
   IDFHIDKeyboard(uint8_t itf = 0);
-  void begin(const uint8_t *layout = KeyboardLayout_en_US);
+  void begin(const uint8_t *layout = KeyboardLayout_en_US, const KeyboardUnicodeLayout *unicode = nullptr);
   void end(void);
+  void setLayout(const uint8_t *layout, const KeyboardUnicodeLayout *unicode = nullptr);
   size_t write(uint8_t k);
   size_t write(const uint8_t *buffer, size_t size);
   size_t press(uint8_t k);
   size_t release(uint8_t k);
   size_t sendKeycode(uint8_t* encodedKeys, uint8_t numKeys);
+
+  // Type a single Unicode code point through the layout tables, or the OS fallback
+  size_t writeUnicode(uint32_t codepoint);
+  void setUnicodeFallback(uint8_t mode);
   void releaseAll(void);
   void sendReport(KeyReport *keys);
   void setShiftKeyReports(bool set);
@@ -161,6 +198,17 @@ public:
   size_t pressRaw(uint8_t k);
   size_t releaseRaw(uint8_t k);
 
+  // Update the held key state without sending, returns true if the state changed
+  bool setRaw(uint8_t k, bool down);
+  void sendState(void);
+
+  // Host LED state (LED_* bits), delivered through SET_REPORT output reports
+  uint8_t leds(void);
+  bool hostReportsLeds(void);
+  bool waitForLeds(uint8_t mask, uint8_t value, uint32_t timeout_ms);
+  void onLedChange(IDFHIDKeyboardLedCallback callback);
+  void setLockCompensation(bool set);
+
   // internal use
-  //void _onOutput(uint8_t report_id, const uint8_t *buffer, uint16_t len);
+  void _onOutput(uint8_t report_id, const uint8_t *buffer, uint16_t len);
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "IDFHID.h"
+#include "IDFHIDTouchpad.h"
+
+#if TOUCHPAD_PTPHQA_ENABLED
+static_assert(CFG_TUD_HID_EP_BUFSIZE >= TOUCHPAD_PTPHQA_SIZE + 1, "CFG_TUD_HID_EP_BUFSIZE must hold the certification blob and its report ID");
+#endif
+
+IDFHIDTouchpad::IDFHIDTouchpad(uint8_t itf) : hid(itf, true), _inputMode(TOUCHPAD_INPUT_MODE_MOUSE), _functionSwitch(0x03) {
+  memset(&_report, 0, sizeof(_report));
+}
+
+void IDFHIDTouchpad::begin() {
+  hid.attach(this); // Receive the host's feature requests (input mode, contact count, certification)
+  hid.begin();
+}
+
+void IDFHIDTouchpad::end() {}
+
+// True once the host switched the interface into touchpad mode and left the surface enabled
+bool IDFHIDTouchpad::isActive() {
+  return _inputMode == TOUCHPAD_INPUT_MODE_TOUCHPAD && (_functionSwitch & 0x01);
+}
+
+// Fill one contact slot of the next report
+bool IDFHIDTouchpad::setContact(uint8_t slot, uint8_t contactId, bool tip, uint16_t x, uint16_t y) {
+  if (slot >= TOUCHPAD_MAX_CONTACTS) {
+    return false;
+  }
+
+  hid_touchpad_contact_t &contact = _report.contacts[slot];
+  contact.flags = TOUCHPAD_CONTACT_CONFIDENCE | (tip ? TOUCHPAD_CONTACT_TIP : 0);
+  contact.contact_id = contactId;
+  contact.x = (x > TOUCHPAD_LOGICAL_MAX) ? TOUCHPAD_LOGICAL_MAX : x;
+  contact.y = (y > TOUCHPAD_LOGICAL_MAX) ? TOUCHPAD_LOGICAL_MAX : y;
+  return true;
+}
+
+// Send the first <contactCount> slots as one frame, unused slots are cleared
+bool IDFHIDTouchpad::send(uint8_t contactCount, uint8_t buttons, uint16_t scanTime) {
+  if (contactCount > TOUCHPAD_MAX_CONTACTS) {
+    return false;
+  }
+
+  memset(&_report.contacts[contactCount], 0, (TOUCHPAD_MAX_CONTACTS - contactCount) * sizeof(hid_touchpad_contact_t));
+  _report.scan_time = scanTime;
+  _report.contact_count = contactCount;
+  _report.buttons = buttons & 0x01;
+  return hid.SendReport(TOUCHPAD_REPORT_ID_INPUT, &_report, sizeof(_report));
+}
+
+uint16_t IDFHIDTouchpad::_onGetFeature(uint8_t report_id, uint8_t *buffer, uint16_t len) {
+  if (len == 0) {
+    return 0;
+  }
+
+  switch (report_id) {
+    case TOUCHPAD_REPORT_ID_MAX_COUNT:
+      buffer[0] = TOUCHPAD_MAX_CONTACTS; // Pad type 0 (click pad) in the upper nibble
+      return 1;
+
+#if TOUCHPAD_PTPHQA_ENABLED
+    case TOUCHPAD_REPORT_ID_PTPHQA:
+      if (len < TOUCHPAD_PTPHQA_SIZE) {
+        return 0; // A truncated blob fails the check anyway
+      }
+      memcpy(buffer, touchpadCertificationBlob, TOUCHPAD_PTPHQA_SIZE);
+      return TOUCHPAD_PTPHQA_SIZE;
+#endif
+
+    case TOUCHPAD_REPORT_ID_INPUT_MODE:
+      buffer[0] = _inputMode;
+      return 1;
+
+    case TOUCHPAD_REPORT_ID_FUNCTION_SWITCH:
+      buffer[0] = _functionSwitch;
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+void IDFHIDTouchpad::_onSetFeature(uint8_t report_id, const uint8_t *buffer, uint16_t len) {
+  if (len == 0) {
+    return;
+  }
+
+  if (report_id == TOUCHPAD_REPORT_ID_INPUT_MODE) {
+    _inputMode = buffer[0];
+  }
+  else if (report_id == TOUCHPAD_REPORT_ID_FUNCTION_SWITCH) {
+    _functionSwitch = buffer[0] & 0x03;
+  }
+}
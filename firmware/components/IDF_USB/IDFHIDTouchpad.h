@@ -0,0 +1,214 @@
+#pragma once
+
+#include "IDFHID.h"
+
+// Precision Touchpad (multi-touch digitizer) interface
+// Follows the Windows Precision Touchpad report layout: parallel mode with a fixed number of finger
+// collections, a relative scan time, a contact count and one physical button. Hosts that never select
+// the touchpad input mode (macOS, BIOS, older Windows) keep using the relative mouse interface instead.
+
+#define TOUCHPAD_MAX_CONTACTS    5
+#define TOUCHPAD_LOGICAL_MAX     4095  // Contact coordinates are 0..4095 on both axes
+#define TOUCHPAD_PHYSICAL_MAX_X  1000  // 100.0 mm (unit is cm, exponent -2)
+#define TOUCHPAD_PHYSICAL_MAX_Y  650   // 65.0 mm
+#define TOUCHPAD_PTPHQA_SIZE     256   // Size of the Windows certification blob feature report
+
+// Windows only enables precision touchpad gestures once the device serves a valid certification blob (PTPHQA).
+// The blob is issued per device and its feature report is larger than TinyUSB's default HID buffer
+// (CFG_TUD_HID_EP_BUFSIZE, 64 bytes), so it is only described when a build provides both: set this to 1,
+// define touchpadCertificationBlob and raise CFG_TUD_HID_EP_BUFSIZE to at least TOUCHPAD_PTPHQA_SIZE + 1.
+// Without it Windows keeps the touchpad on the relative mouse fallback.
+#ifndef TOUCHPAD_PTPHQA_ENABLED
+#define TOUCHPAD_PTPHQA_ENABLED  0
+#endif
+
+// Report IDs used on the touchpad interface
+#define TOUCHPAD_REPORT_ID_INPUT           0x01
+#define TOUCHPAD_REPORT_ID_MAX_COUNT       0x02
+#define TOUCHPAD_REPORT_ID_PTPHQA          0x03
+#define TOUCHPAD_REPORT_ID_INPUT_MODE      0x04
+#define TOUCHPAD_REPORT_ID_FUNCTION_SWITCH 0x05
+
+// Input mode feature values (set by the host once it recognizes the device as a touchpad)
+#define TOUCHPAD_INPUT_MODE_MOUSE    0x00
+#define TOUCHPAD_INPUT_MODE_TOUCHPAD 0x03
+
+// Contact flags
+#define TOUCHPAD_CONTACT_CONFIDENCE  0x01
+#define TOUCHPAD_CONTACT_TIP         0x02
+
+// Digitizer page usages (HID Usage Tables, section 16)
+#define TOUCHPAD_USAGE_TOUCH_PAD         0x05
+#define TOUCHPAD_USAGE_DEVICE_CONFIG     0x0E
+#define TOUCHPAD_USAGE_FINGER            0x22
+#define TOUCHPAD_USAGE_TIP_SWITCH        0x42
+#define TOUCHPAD_USAGE_CONFIDENCE        0x47
+#define TOUCHPAD_USAGE_CONTACT_ID        0x51
+#define TOUCHPAD_USAGE_INPUT_MODE        0x52
+#define TOUCHPAD_USAGE_CONTACT_COUNT     0x54
+#define TOUCHPAD_USAGE_CONTACT_COUNT_MAX 0x55
+#define TOUCHPAD_USAGE_SCAN_TIME         0x56
+#define TOUCHPAD_USAGE_SURFACE_SWITCH    0x57
+#define TOUCHPAD_USAGE_BUTTON_SWITCH     0x58
+#define TOUCHPAD_USAGE_PAD_TYPE          0x59
+#define TOUCHPAD_USAGE_PTPHQA            0xC5
+
+// Feature: Windows certification status blob, left out unless the build provides one
+#if TOUCHPAD_PTPHQA_ENABLED
+#define TUD_HID_REPORT_DESC_TOUCHPAD_PTPHQA() \
+    HID_USAGE_PAGE_N ( HID_USAGE_PAGE_VENDOR, 2              ) ,\
+    HID_REPORT_ID    ( TOUCHPAD_REPORT_ID_PTPHQA             ) \
+    HID_USAGE        ( TOUCHPAD_USAGE_PTPHQA                 ) ,\
+    HID_LOGICAL_MAX_N( 0xFF, 2                               ) ,\
+    HID_REPORT_SIZE  ( 8                                     ) ,\
+    HID_REPORT_COUNT_N( TOUCHPAD_PTPHQA_SIZE, 2              ) ,\
+    HID_FEATURE      ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,
+#else
+#define TUD_HID_REPORT_DESC_TOUCHPAD_PTPHQA()
+#endif
+
+// A single finger collection: confidence, tip switch, contact id and absolute X/Y
+#define TUD_HID_REPORT_DESC_TOUCHPAD_FINGER() \
+  HID_USAGE_PAGE     ( HID_USAGE_PAGE_DIGITIZER              ) ,\
+  HID_USAGE          ( TOUCHPAD_USAGE_FINGER                 ) ,\
+  HID_COLLECTION     ( HID_COLLECTION_LOGICAL                ) ,\
+    HID_LOGICAL_MIN  ( 0                                     ) ,\
+    HID_LOGICAL_MAX  ( 1                                     ) ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_CONFIDENCE             ) ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_TIP_SWITCH             ) ,\
+    HID_REPORT_SIZE  ( 1                                     ) ,\
+    HID_REPORT_COUNT ( 2                                     ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    HID_REPORT_COUNT ( 6                                     ) ,\
+    HID_INPUT        ( HID_CONSTANT                          ) ,\
+    HID_LOGICAL_MAX  ( 15                                    ) ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_CONTACT_ID             ) ,\
+    HID_REPORT_SIZE  ( 8                                     ) ,\
+    HID_REPORT_COUNT ( 1                                     ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    HID_USAGE_PAGE   ( HID_USAGE_PAGE_DESKTOP                ) ,\
+    HID_LOGICAL_MAX_N( TOUCHPAD_LOGICAL_MAX, 2               ) ,\
+    HID_PHYSICAL_MIN ( 0                                     ) ,\
+    HID_UNIT_EXPONENT( 0x0E                                  ) ,\
+    HID_UNIT         ( 0x11                                  ) ,\
+    HID_REPORT_SIZE  ( 16                                    ) ,\
+    HID_USAGE        ( HID_USAGE_DESKTOP_X                   ) ,\
+    HID_PHYSICAL_MAX_N( TOUCHPAD_PHYSICAL_MAX_X, 2           ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    HID_USAGE        ( HID_USAGE_DESKTOP_Y                   ) ,\
+    HID_PHYSICAL_MAX_N( TOUCHPAD_PHYSICAL_MAX_Y, 2           ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+  HID_COLLECTION_END
+
+// Touchpad application collection followed by the configuration collection Windows uses to switch input modes
+#define TUD_HID_REPORT_DESC_TOUCHPAD() \
+  HID_USAGE_PAGE     ( HID_USAGE_PAGE_DIGITIZER              ) ,\
+  HID_USAGE          ( TOUCHPAD_USAGE_TOUCH_PAD              ) ,\
+  HID_COLLECTION     ( HID_COLLECTION_APPLICATION            ) ,\
+    HID_REPORT_ID    ( TOUCHPAD_REPORT_ID_INPUT              ) \
+    TUD_HID_REPORT_DESC_TOUCHPAD_FINGER() ,\
+    TUD_HID_REPORT_DESC_TOUCHPAD_FINGER() ,\
+    TUD_HID_REPORT_DESC_TOUCHPAD_FINGER() ,\
+    TUD_HID_REPORT_DESC_TOUCHPAD_FINGER() ,\
+    TUD_HID_REPORT_DESC_TOUCHPAD_FINGER() ,\
+    /* Relative scan time in 100us units */ \
+    HID_USAGE_PAGE   ( HID_USAGE_PAGE_DIGITIZER              ) ,\
+    HID_UNIT_EXPONENT( 0x0C                                  ) ,\
+    HID_UNIT_N       ( 0x1001, 2                             ) ,\
+    HID_LOGICAL_MAX_N( 0xFFFF, 3                             ) ,\
+    HID_PHYSICAL_MAX_N( 0xFFFF, 3                            ) ,\
+    HID_REPORT_SIZE  ( 16                                    ) ,\
+    HID_REPORT_COUNT ( 1                                     ) ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_SCAN_TIME              ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    HID_UNIT_EXPONENT( 0                                     ) ,\
+    HID_UNIT         ( 0                                     ) ,\
+    HID_PHYSICAL_MAX ( 0                                     ) ,\
+    /* Number of valid contacts in this report */ \
+    HID_LOGICAL_MAX  ( TOUCHPAD_MAX_CONTACTS                 ) ,\
+    HID_REPORT_SIZE  ( 8                                     ) ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_CONTACT_COUNT          ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    /* Physical click */ \
+    HID_USAGE_PAGE   ( HID_USAGE_PAGE_BUTTON                 ) ,\
+    HID_USAGE        ( 1                                     ) ,\
+    HID_LOGICAL_MAX  ( 1                                     ) ,\
+    HID_REPORT_SIZE  ( 1                                     ) ,\
+    HID_INPUT        ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    HID_REPORT_COUNT ( 7                                     ) ,\
+    HID_INPUT        ( HID_CONSTANT                          ) ,\
+    /* Feature: maximum contact count and pad type */ \
+    HID_USAGE_PAGE   ( HID_USAGE_PAGE_DIGITIZER              ) ,\
+    HID_REPORT_ID    ( TOUCHPAD_REPORT_ID_MAX_COUNT          ) \
+    HID_USAGE        ( TOUCHPAD_USAGE_CONTACT_COUNT_MAX      ) ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_PAD_TYPE               ) ,\
+    HID_LOGICAL_MAX  ( 15                                    ) ,\
+    HID_REPORT_SIZE  ( 4                                     ) ,\
+    HID_REPORT_COUNT ( 2                                     ) ,\
+    HID_FEATURE      ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    TUD_HID_REPORT_DESC_TOUCHPAD_PTPHQA() \
+  HID_COLLECTION_END ,\
+  HID_USAGE_PAGE     ( HID_USAGE_PAGE_DIGITIZER              ) ,\
+  HID_USAGE          ( TOUCHPAD_USAGE_DEVICE_CONFIG          ) ,\
+  HID_COLLECTION     ( HID_COLLECTION_APPLICATION            ) ,\
+    HID_REPORT_ID    ( TOUCHPAD_REPORT_ID_INPUT_MODE         ) \
+    HID_USAGE        ( TOUCHPAD_USAGE_FINGER                 ) ,\
+    HID_COLLECTION   ( HID_COLLECTION_LOGICAL                ) ,\
+      HID_USAGE      ( TOUCHPAD_USAGE_INPUT_MODE             ) ,\
+      HID_LOGICAL_MAX( 10                                    ) ,\
+      HID_REPORT_SIZE( 8                                     ) ,\
+      HID_REPORT_COUNT( 1                                    ) ,\
+      HID_FEATURE    ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+    HID_COLLECTION_END ,\
+    HID_USAGE        ( TOUCHPAD_USAGE_FINGER                 ) ,\
+    HID_COLLECTION   ( HID_COLLECTION_PHYSICAL               ) ,\
+      HID_REPORT_ID  ( TOUCHPAD_REPORT_ID_FUNCTION_SWITCH    ) \
+      HID_USAGE      ( TOUCHPAD_USAGE_SURFACE_SWITCH         ) ,\
+      HID_USAGE      ( TOUCHPAD_USAGE_BUTTON_SWITCH          ) ,\
+      HID_LOGICAL_MAX( 1                                     ) ,\
+      HID_REPORT_SIZE( 1                                     ) ,\
+      HID_REPORT_COUNT( 2                                    ) ,\
+      HID_FEATURE    ( HID_DATA | HID_VARIABLE | HID_ABSOLUTE ) ,\
+      HID_REPORT_COUNT( 6                                    ) ,\
+      HID_FEATURE    ( HID_CONSTANT                          ) ,\
+    HID_COLLECTION_END ,\
+  HID_COLLECTION_END
+
+typedef struct TU_ATTR_PACKED {
+  uint8_t flags;       // TOUCHPAD_CONTACT_CONFIDENCE | TOUCHPAD_CONTACT_TIP
+  uint8_t contact_id;
+  uint16_t x;
+  uint16_t y;
+} hid_touchpad_contact_t;
+
+typedef struct TU_ATTR_PACKED {
+  hid_touchpad_contact_t contacts[TOUCHPAD_MAX_CONTACTS];
+  uint16_t scan_time;
+  uint8_t contact_count;
+  uint8_t buttons;
+} hid_touchpad_report_t;
+
+#if TOUCHPAD_PTPHQA_ENABLED
+// The device's certification blob, there is no default: a blob of zeros fails Windows' check
+extern const uint8_t touchpadCertificationBlob[TOUCHPAD_PTPHQA_SIZE];
+#endif
+
+class IDFHIDTouchpad : public IDFHIDDevice {
+private:
+  IDFHID hid;
+  hid_touchpad_report_t _report;
+  uint8_t _inputMode;
+  uint8_t _functionSwitch;
+
+public:
+  IDFHIDTouchpad(uint8_t itf);
+  void begin(void);
+  void end(void);
+  bool isActive(void);
+  bool setContact(uint8_t slot, uint8_t contactId, bool tip, uint16_t x, uint16_t y);
+  bool send(uint8_t contactCount, uint8_t buttons, uint16_t scanTime);
+
+  // internal use
+  uint16_t _onGetFeature(uint8_t report_id, uint8_t *buffer, uint16_t len) override;
+  void _onSetFeature(uint8_t report_id, const uint8_t *buffer, uint16_t len) override;
+};
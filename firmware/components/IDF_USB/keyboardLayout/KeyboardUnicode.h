@@ -0,0 +1,136 @@
+/*
+  KeyboardUnicode.h
+
+  Code point tables for characters the ASCII layout arrays can't express:
+  anything outside 0..127, characters that need Shift and AltGr together,
+  and characters that are typed through a dead key.
+
+  == Entries ==
+
+  Each entry is 16 bits:
+
+      bits 0-7    HID usage of the key
+      bit 8       Shift
+      bit 9       AltGr
+      bits 10-13  Dead key to tap first (index into the layout's dead key
+                  array, 0 = none). Dead key entries use bits 0-9 only.
+
+  An entry of 0 means the character is not on the layout.
+
+  == Lookup ==
+
+  Tables are two level: the high byte of a BMP code point selects a page
+  through a 256 byte index, the low byte selects the entry within the
+  page. Only pages that hold at least one character are stored, and both
+  levels are built at compile time from a flat list of
+  {code point, entry} pairs, so a layout file is just that list:
+
+      static constexpr KeyboardUnicodeKey keys[] = {
+        {0x00E4, 0x34},                // ä
+        {0x00E1, 0x04 | UNI_DEAD(2)},  // á  dead ´ + a
+      };
+
+      KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_xx_YY, keys, deadKeys);
+
+  The tables are constexpr, so they stay in flash.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+#define UNI_SHIFT           0x0100
+#define UNI_ALTGR           0x0200
+#define UNI_DEAD(n)         ((uint16_t)((n) << 10))
+
+#define UNI_USAGE(e)        ((uint8_t)((e) & 0xFF))
+#define UNI_DEAD_INDEX(e)   (((e) >> 10) & 0x0F)
+
+#define UNICODE_NO_PAGE     0xFF
+
+typedef struct {
+  uint16_t codepoint;
+  uint16_t entry;
+} KeyboardUnicodeKey;
+
+typedef struct {
+  const uint8_t *pageIndex;                 // High byte of the code point -> page number
+  const std::array<uint16_t, 256> *pages;   // Entries indexed by the low byte
+  const uint16_t *deadKeys;                 // Dead key entries, index 0 unused
+} KeyboardUnicodeLayout;
+
+// Entry for a code point, 0 if the layout can't type it
+inline uint16_t keyboardUnicodeLookup(const KeyboardUnicodeLayout *layout, uint32_t codepoint) {
+  if (layout == nullptr || codepoint > 0xFFFF) {
+    return 0;
+  }
+  uint8_t page = layout->pageIndex[codepoint >> 8];
+  return (page == UNICODE_NO_PAGE) ? 0 : layout->pages[page][codepoint & 0xFF];
+}
+
+// Compile-time construction of the two table levels
+namespace KeyboardUnicodeBuilder {
+
+template <size_t N>
+constexpr std::array<uint8_t, 256> pageIndex(const KeyboardUnicodeKey (&keys)[N]) {
+  std::array<uint8_t, 256> index{};
+  for (size_t i = 0; i < 256; i++) {
+    index[i] = UNICODE_NO_PAGE;
+  }
+  uint8_t next = 0;
+  for (size_t i = 0; i < N; i++) {
+    uint8_t high = keys[i].codepoint >> 8;
+    if (index[high] == UNICODE_NO_PAGE) {
+      index[high] = next++;
+    }
+  }
+  return index;
+}
+
+template <size_t N>
+constexpr size_t pageCount(const KeyboardUnicodeKey (&keys)[N]) {
+  std::array<uint8_t, 256> index = pageIndex(keys);
+  size_t count = 0;
+  for (size_t i = 0; i < 256; i++) {
+    if (index[i] != UNICODE_NO_PAGE) {
+      count++;
+    }
+  }
+  return count;
+}
+
+template <size_t P, size_t N>
+constexpr std::array<std::array<uint16_t, 256>, P> pages(const KeyboardUnicodeKey (&keys)[N]) {
+  std::array<uint8_t, 256> index = pageIndex(keys);
+  std::array<std::array<uint16_t, 256>, P> result{};
+  for (size_t i = 0; i < N; i++) {
+    result[index[keys[i].codepoint >> 8]][keys[i].codepoint & 0xFF] = keys[i].entry;
+  }
+  return result;
+}
+
+// Every code point listed once, and every dead key index inside the dead key array
+template <size_t N, size_t D>
+constexpr bool valid(const KeyboardUnicodeKey (&keys)[N], const uint16_t (&)[D]) {
+  for (size_t i = 0; i < N; i++) {
+    if (keys[i].entry == 0 || UNI_DEAD_INDEX(keys[i].entry) >= D) {
+      return false;
+    }
+    for (size_t j = i + 1; j < N; j++) {
+      if (keys[i].codepoint == keys[j].codepoint) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace KeyboardUnicodeBuilder
+
+#define KEYBOARD_UNICODE_LAYOUT(name, keys, deadKeys)                                                   \
+  static_assert(KeyboardUnicodeBuilder::valid(keys, deadKeys), #name ": duplicate code point or bad dead key"); \
+  static constexpr auto name##_pageIndex = KeyboardUnicodeBuilder::pageIndex(keys);                     \
+  static constexpr auto name##_pages = KeyboardUnicodeBuilder::pages<KeyboardUnicodeBuilder::pageCount(keys)>(keys); \
+  extern const KeyboardUnicodeLayout name = {name##_pageIndex.data(), name##_pages.data(), deadKeys}
@@ -0,0 +1,65 @@
+/*
+ * German keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {
+  0x0000,
+  0x35,                    // 1: ^
+  0x2e,                    // 2: ´
+  0x2e | UNI_SHIFT,        // 3: `
+};
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x005E, 0x2c | UNI_DEAD(1)},               // ^  dead ^ + space
+  {0x0060, 0x2c | UNI_DEAD(3)},               // `  dead ` + space
+  {0x00A7, 0x20 | UNI_SHIFT},                 // §
+  {0x00B0, 0x35 | UNI_SHIFT},                 // °
+  {0x00B2, 0x1f | UNI_ALTGR},                 // ²
+  {0x00B3, 0x20 | UNI_ALTGR},                 // ³
+  {0x00B4, 0x2c | UNI_DEAD(2)},               // ´  dead ´ + space
+  {0x00B5, 0x10 | UNI_ALTGR},                 // µ
+  {0x00C0, 0x04 | UNI_SHIFT | UNI_DEAD(3)},   // À  dead ` + A
+  {0x00C1, 0x04 | UNI_SHIFT | UNI_DEAD(2)},   // Á  dead ´ + A
+  {0x00C2, 0x04 | UNI_SHIFT | UNI_DEAD(1)},   // Â  dead ^ + A
+  {0x00C4, 0x34 | UNI_SHIFT},                 // Ä
+  {0x00C8, 0x08 | UNI_SHIFT | UNI_DEAD(3)},   // È  dead ` + E
+  {0x00C9, 0x08 | UNI_SHIFT | UNI_DEAD(2)},   // É  dead ´ + E
+  {0x00CA, 0x08 | UNI_SHIFT | UNI_DEAD(1)},   // Ê  dead ^ + E
+  {0x00CC, 0x0c | UNI_SHIFT | UNI_DEAD(3)},   // Ì  dead ` + I
+  {0x00CD, 0x0c | UNI_SHIFT | UNI_DEAD(2)},   // Í  dead ´ + I
+  {0x00CE, 0x0c | UNI_SHIFT | UNI_DEAD(1)},   // Î  dead ^ + I
+  {0x00D2, 0x12 | UNI_SHIFT | UNI_DEAD(3)},   // Ò  dead ` + O
+  {0x00D3, 0x12 | UNI_SHIFT | UNI_DEAD(2)},   // Ó  dead ´ + O
+  {0x00D4, 0x12 | UNI_SHIFT | UNI_DEAD(1)},   // Ô  dead ^ + O
+  {0x00D6, 0x33 | UNI_SHIFT},                 // Ö
+  {0x00D9, 0x18 | UNI_SHIFT | UNI_DEAD(3)},   // Ù  dead ` + U
+  {0x00DA, 0x18 | UNI_SHIFT | UNI_DEAD(2)},   // Ú  dead ´ + U
+  {0x00DB, 0x18 | UNI_SHIFT | UNI_DEAD(1)},   // Û  dead ^ + U
+  {0x00DC, 0x2f | UNI_SHIFT},                 // Ü
+  {0x00DD, 0x1d | UNI_SHIFT | UNI_DEAD(2)},   // Ý  dead ´ + Y
+  {0x00DF, 0x2d},                             // ß
+  {0x00E0, 0x04 | UNI_DEAD(3)},               // à  dead ` + a
+  {0x00E1, 0x04 | UNI_DEAD(2)},               // á  dead ´ + a
+  {0x00E2, 0x04 | UNI_DEAD(1)},               // â  dead ^ + a
+  {0x00E4, 0x34},                             // ä
+  {0x00E8, 0x08 | UNI_DEAD(3)},               // è  dead ` + e
+  {0x00E9, 0x08 | UNI_DEAD(2)},               // é  dead ´ + e
+  {0x00EA, 0x08 | UNI_DEAD(1)},               // ê  dead ^ + e
+  {0x00EC, 0x0c | UNI_DEAD(3)},               // ì  dead ` + i
+  {0x00ED, 0x0c | UNI_DEAD(2)},               // í  dead ´ + i
+  {0x00EE, 0x0c | UNI_DEAD(1)},               // î  dead ^ + i
+  {0x00F2, 0x12 | UNI_DEAD(3)},               // ò  dead ` + o
+  {0x00F3, 0x12 | UNI_DEAD(2)},               // ó  dead ´ + o
+  {0x00F4, 0x12 | UNI_DEAD(1)},               // ô  dead ^ + o
+  {0x00F6, 0x33},                             // ö
+  {0x00F9, 0x18 | UNI_DEAD(3)},               // ù  dead ` + u
+  {0x00FA, 0x18 | UNI_DEAD(2)},               // ú  dead ´ + u
+  {0x00FB, 0x18 | UNI_DEAD(1)},               // û  dead ^ + u
+  {0x00FC, 0x2f},                             // ü
+  {0x00FD, 0x1d | UNI_DEAD(2)},               // ý  dead ´ + y
+  {0x20AC, 0x08 | UNI_ALTGR},                 // €
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_de_DE, keys, deadKeys);
@@ -0,0 +1,82 @@
+/*
+ * Spanish keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {
+  0x0000,
+  0x2f,                    // 1: `
+  0x2f | UNI_SHIFT,        // 2: ^
+  0x34,                    // 3: ´
+  0x34 | UNI_SHIFT,        // 4: ¨
+  0x21 | UNI_ALTGR,        // 5: ~
+};
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x005E, 0x2c | UNI_DEAD(2)},               // ^  dead ^ + space
+  {0x0060, 0x2c | UNI_DEAD(1)},               // `  dead ` + space
+  {0x007E, 0x2c | UNI_DEAD(5)},               // ~  dead ~ + space
+  {0x00A1, 0x2e},                             // ¡
+  {0x00A8, 0x2c | UNI_DEAD(4)},               // ¨  dead ¨ + space
+  {0x00AA, 0x35 | UNI_SHIFT},                 // ª
+  {0x00AC, 0x23 | UNI_ALTGR},                 // ¬
+  {0x00B4, 0x2c | UNI_DEAD(3)},               // ´  dead ´ + space
+  {0x00B7, 0x20 | UNI_SHIFT},                 // ·
+  {0x00BA, 0x35},                             // º
+  {0x00BF, 0x2e | UNI_SHIFT},                 // ¿
+  {0x00C0, 0x04 | UNI_SHIFT | UNI_DEAD(1)},   // À  dead ` + A
+  {0x00C1, 0x04 | UNI_SHIFT | UNI_DEAD(3)},   // Á  dead ´ + A
+  {0x00C2, 0x04 | UNI_SHIFT | UNI_DEAD(2)},   // Â  dead ^ + A
+  {0x00C3, 0x04 | UNI_SHIFT | UNI_DEAD(5)},   // Ã  dead ~ + A
+  {0x00C4, 0x04 | UNI_SHIFT | UNI_DEAD(4)},   // Ä  dead ¨ + A
+  {0x00C7, 0x31 | UNI_SHIFT},                 // Ç
+  {0x00C8, 0x08 | UNI_SHIFT | UNI_DEAD(1)},   // È  dead ` + E
+  {0x00C9, 0x08 | UNI_SHIFT | UNI_DEAD(3)},   // É  dead ´ + E
+  {0x00CA, 0x08 | UNI_SHIFT | UNI_DEAD(2)},   // Ê  dead ^ + E
+  {0x00CB, 0x08 | UNI_SHIFT | UNI_DEAD(4)},   // Ë  dead ¨ + E
+  {0x00CC, 0x0c | UNI_SHIFT | UNI_DEAD(1)},   // Ì  dead ` + I
+  {0x00CD, 0x0c | UNI_SHIFT | UNI_DEAD(3)},   // Í  dead ´ + I
+  {0x00CE, 0x0c | UNI_SHIFT | UNI_DEAD(2)},   // Î  dead ^ + I
+  {0x00CF, 0x0c | UNI_SHIFT | UNI_DEAD(4)},   // Ï  dead ¨ + I
+  {0x00D1, 0x33 | UNI_SHIFT},                 // Ñ
+  {0x00D2, 0x12 | UNI_SHIFT | UNI_DEAD(1)},   // Ò  dead ` + O
+  {0x00D3, 0x12 | UNI_SHIFT | UNI_DEAD(3)},   // Ó  dead ´ + O
+  {0x00D4, 0x12 | UNI_SHIFT | UNI_DEAD(2)},   // Ô  dead ^ + O
+  {0x00D5, 0x12 | UNI_SHIFT | UNI_DEAD(5)},   // Õ  dead ~ + O
+  {0x00D6, 0x12 | UNI_SHIFT | UNI_DEAD(4)},   // Ö  dead ¨ + O
+  {0x00D9, 0x18 | UNI_SHIFT | UNI_DEAD(1)},   // Ù  dead ` + U
+  {0x00DA, 0x18 | UNI_SHIFT | UNI_DEAD(3)},   // Ú  dead ´ + U
+  {0x00DB, 0x18 | UNI_SHIFT | UNI_DEAD(2)},   // Û  dead ^ + U
+  {0x00DC, 0x18 | UNI_SHIFT | UNI_DEAD(4)},   // Ü  dead ¨ + U
+  {0x00DD, 0x1c | UNI_SHIFT | UNI_DEAD(3)},   // Ý  dead ´ + Y
+  {0x00E0, 0x04 | UNI_DEAD(1)},               // à  dead ` + a
+  {0x00E1, 0x04 | UNI_DEAD(3)},               // á  dead ´ + a
+  {0x00E2, 0x04 | UNI_DEAD(2)},               // â  dead ^ + a
+  {0x00E3, 0x04 | UNI_DEAD(5)},               // ã  dead ~ + a
+  {0x00E4, 0x04 | UNI_DEAD(4)},               // ä  dead ¨ + a
+  {0x00E7, 0x31},                             // ç
+  {0x00E8, 0x08 | UNI_DEAD(1)},               // è  dead ` + e
+  {0x00E9, 0x08 | UNI_DEAD(3)},               // é  dead ´ + e
+  {0x00EA, 0x08 | UNI_DEAD(2)},               // ê  dead ^ + e
+  {0x00EB, 0x08 | UNI_DEAD(4)},               // ë  dead ¨ + e
+  {0x00EC, 0x0c | UNI_DEAD(1)},               // ì  dead ` + i
+  {0x00ED, 0x0c | UNI_DEAD(3)},               // í  dead ´ + i
+  {0x00EE, 0x0c | UNI_DEAD(2)},               // î  dead ^ + i
+  {0x00EF, 0x0c | UNI_DEAD(4)},               // ï  dead ¨ + i
+  {0x00F1, 0x33},                             // ñ
+  {0x00F2, 0x12 | UNI_DEAD(1)},               // ò  dead ` + o
+  {0x00F3, 0x12 | UNI_DEAD(3)},               // ó  dead ´ + o
+  {0x00F4, 0x12 | UNI_DEAD(2)},               // ô  dead ^ + o
+  {0x00F5, 0x12 | UNI_DEAD(5)},               // õ  dead ~ + o
+  {0x00F6, 0x12 | UNI_DEAD(4)},               // ö  dead ¨ + o
+  {0x00F9, 0x18 | UNI_DEAD(1)},               // ù  dead ` + u
+  {0x00FA, 0x18 | UNI_DEAD(3)},               // ú  dead ´ + u
+  {0x00FB, 0x18 | UNI_DEAD(2)},               // û  dead ^ + u
+  {0x00FC, 0x18 | UNI_DEAD(4)},               // ü  dead ¨ + u
+  {0x00FD, 0x1c | UNI_DEAD(3)},               // ý  dead ´ + y
+  {0x00FF, 0x1c | UNI_DEAD(4)},               // ÿ  dead ¨ + y
+  {0x20AC, 0x08 | UNI_ALTGR},                 // €
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_es_ES, keys, deadKeys);
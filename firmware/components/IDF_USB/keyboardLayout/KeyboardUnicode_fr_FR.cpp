@@ -0,0 +1,58 @@
+/*
+ * French keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {
+  0x0000,
+  0x2f,                    // 1: ^
+  0x2f | UNI_SHIFT,        // 2: ¨
+  0x24 | UNI_ALTGR,        // 3: `
+};
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x00A3, 0x30 | UNI_SHIFT},                 // £
+  {0x00A4, 0x30 | UNI_ALTGR},                 // ¤
+  {0x00A7, 0x38 | UNI_SHIFT},                 // §
+  {0x00A8, 0x2c | UNI_DEAD(2)},               // ¨  dead ¨ + space
+  {0x00B0, 0x2d | UNI_SHIFT},                 // °
+  {0x00B2, 0x35},                             // ²
+  {0x00B5, 0x31 | UNI_SHIFT},                 // µ
+  {0x00C0, 0x14 | UNI_SHIFT | UNI_DEAD(3)},   // À  dead ` + A
+  {0x00C2, 0x14 | UNI_SHIFT | UNI_DEAD(1)},   // Â  dead ^ + A
+  {0x00C4, 0x14 | UNI_SHIFT | UNI_DEAD(2)},   // Ä  dead ¨ + A
+  {0x00C8, 0x08 | UNI_SHIFT | UNI_DEAD(3)},   // È  dead ` + E
+  {0x00CA, 0x08 | UNI_SHIFT | UNI_DEAD(1)},   // Ê  dead ^ + E
+  {0x00CB, 0x08 | UNI_SHIFT | UNI_DEAD(2)},   // Ë  dead ¨ + E
+  {0x00CC, 0x0c | UNI_SHIFT | UNI_DEAD(3)},   // Ì  dead ` + I
+  {0x00CE, 0x0c | UNI_SHIFT | UNI_DEAD(1)},   // Î  dead ^ + I
+  {0x00CF, 0x0c | UNI_SHIFT | UNI_DEAD(2)},   // Ï  dead ¨ + I
+  {0x00D2, 0x12 | UNI_SHIFT | UNI_DEAD(3)},   // Ò  dead ` + O
+  {0x00D4, 0x12 | UNI_SHIFT | UNI_DEAD(1)},   // Ô  dead ^ + O
+  {0x00D6, 0x12 | UNI_SHIFT | UNI_DEAD(2)},   // Ö  dead ¨ + O
+  {0x00D9, 0x18 | UNI_SHIFT | UNI_DEAD(3)},   // Ù  dead ` + U
+  {0x00DB, 0x18 | UNI_SHIFT | UNI_DEAD(1)},   // Û  dead ^ + U
+  {0x00DC, 0x18 | UNI_SHIFT | UNI_DEAD(2)},   // Ü  dead ¨ + U
+  {0x00E0, 0x27},                             // à
+  {0x00E2, 0x14 | UNI_DEAD(1)},               // â  dead ^ + a
+  {0x00E4, 0x14 | UNI_DEAD(2)},               // ä  dead ¨ + a
+  {0x00E7, 0x26},                             // ç
+  {0x00E8, 0x24},                             // è
+  {0x00E9, 0x1f},                             // é
+  {0x00EA, 0x08 | UNI_DEAD(1)},               // ê  dead ^ + e
+  {0x00EB, 0x08 | UNI_DEAD(2)},               // ë  dead ¨ + e
+  {0x00EC, 0x0c | UNI_DEAD(3)},               // ì  dead ` + i
+  {0x00EE, 0x0c | UNI_DEAD(1)},               // î  dead ^ + i
+  {0x00EF, 0x0c | UNI_DEAD(2)},               // ï  dead ¨ + i
+  {0x00F2, 0x12 | UNI_DEAD(3)},               // ò  dead ` + o
+  {0x00F4, 0x12 | UNI_DEAD(1)},               // ô  dead ^ + o
+  {0x00F6, 0x12 | UNI_DEAD(2)},               // ö  dead ¨ + o
+  {0x00F9, 0x34},                             // ù
+  {0x00FB, 0x18 | UNI_DEAD(1)},               // û  dead ^ + u
+  {0x00FC, 0x18 | UNI_DEAD(2)},               // ü  dead ¨ + u
+  {0x00FF, 0x1c | UNI_DEAD(2)},               // ÿ  dead ¨ + y
+  {0x20AC, 0x08 | UNI_ALTGR},                 // €
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_fr_FR, keys, deadKeys);
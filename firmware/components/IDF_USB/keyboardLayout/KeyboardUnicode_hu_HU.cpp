@@ -0,0 +1,32 @@
+/*
+ * Hungarian keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {0x0000}; // No dead keys
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x00A7, 0x35 | UNI_SHIFT},                 // §
+  {0x00C1, 0x34 | UNI_SHIFT},                 // Á
+  {0x00C9, 0x33 | UNI_SHIFT},                 // É
+  {0x00CD, 0x64 | UNI_SHIFT},                 // Í
+  {0x00D3, 0x2e | UNI_SHIFT},                 // Ó
+  {0x00D6, 0x27 | UNI_SHIFT},                 // Ö
+  {0x00DA, 0x30 | UNI_SHIFT},                 // Ú
+  {0x00DC, 0x2d | UNI_SHIFT},                 // Ü
+  {0x00E1, 0x34},                             // á
+  {0x00E9, 0x33},                             // é
+  {0x00ED, 0x64},                             // í
+  {0x00F3, 0x2e},                             // ó
+  {0x00F6, 0x27},                             // ö
+  {0x00FA, 0x30},                             // ú
+  {0x00FC, 0x2d},                             // ü
+  {0x0150, 0x2f | UNI_SHIFT},                 // Ő
+  {0x0151, 0x2f},                             // ő
+  {0x0170, 0x31 | UNI_SHIFT},                 // Ű
+  {0x0171, 0x31},                             // ű
+  {0x20AC, 0x18 | UNI_ALTGR},                 // €
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_hu_HU, keys, deadKeys);
@@ -0,0 +1,25 @@
+/*
+ * Italian keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {0x0000}; // No dead keys
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x007B, 0x2f | UNI_SHIFT | UNI_ALTGR},     // {
+  {0x007D, 0x30 | UNI_SHIFT | UNI_ALTGR},     // }
+  {0x00A3, 0x20 | UNI_SHIFT},                 // £
+  {0x00A7, 0x31 | UNI_SHIFT},                 // §
+  {0x00B0, 0x34 | UNI_SHIFT},                 // °
+  {0x00E0, 0x34},                             // à
+  {0x00E7, 0x33 | UNI_SHIFT},                 // ç
+  {0x00E8, 0x2f},                             // è
+  {0x00E9, 0x2f | UNI_SHIFT},                 // é
+  {0x00EC, 0x2e},                             // ì
+  {0x00F2, 0x33},                             // ò
+  {0x00F9, 0x31},                             // ù
+  {0x20AC, 0x08 | UNI_ALTGR},                 // €
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_it_IT, keys, deadKeys);
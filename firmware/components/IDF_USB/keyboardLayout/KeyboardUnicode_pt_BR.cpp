@@ -0,0 +1,81 @@
+/*
+ * Brazilian Portuguese keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {
+  0x0000,
+  0x2f,                    // 1: ´
+  0x2f | UNI_SHIFT,        // 2: `
+  0x34,                    // 3: ~
+  0x34 | UNI_SHIFT,        // 4: ^
+  0x23 | UNI_SHIFT,        // 5: ¨
+};
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x00A2, 0x22 | UNI_ALTGR},                 // ¢
+  {0x00A3, 0x21 | UNI_ALTGR},                 // £
+  {0x00A7, 0x2e | UNI_ALTGR},                 // §
+  {0x00A8, 0x2c | UNI_DEAD(5)},               // ¨  dead ¨ + space
+  {0x00AA, 0x30 | UNI_ALTGR},                 // ª
+  {0x00AC, 0x23 | UNI_ALTGR},                 // ¬
+  {0x00B2, 0x1f | UNI_ALTGR},                 // ²
+  {0x00B3, 0x20 | UNI_ALTGR},                 // ³
+  {0x00B4, 0x2c | UNI_DEAD(1)},               // ´  dead ´ + space
+  {0x00B9, 0x1e | UNI_ALTGR},                 // ¹
+  {0x00BA, 0x31 | UNI_ALTGR},                 // º
+  {0x00C0, 0x04 | UNI_SHIFT | UNI_DEAD(2)},   // À  dead ` + A
+  {0x00C1, 0x04 | UNI_SHIFT | UNI_DEAD(1)},   // Á  dead ´ + A
+  {0x00C2, 0x04 | UNI_SHIFT | UNI_DEAD(4)},   // Â  dead ^ + A
+  {0x00C3, 0x04 | UNI_SHIFT | UNI_DEAD(3)},   // Ã  dead ~ + A
+  {0x00C4, 0x04 | UNI_SHIFT | UNI_DEAD(5)},   // Ä  dead ¨ + A
+  {0x00C7, 0x33 | UNI_SHIFT},                 // Ç
+  {0x00C8, 0x08 | UNI_SHIFT | UNI_DEAD(2)},   // È  dead ` + E
+  {0x00C9, 0x08 | UNI_SHIFT | UNI_DEAD(1)},   // É  dead ´ + E
+  {0x00CA, 0x08 | UNI_SHIFT | UNI_DEAD(4)},   // Ê  dead ^ + E
+  {0x00CB, 0x08 | UNI_SHIFT | UNI_DEAD(5)},   // Ë  dead ¨ + E
+  {0x00CC, 0x0c | UNI_SHIFT | UNI_DEAD(2)},   // Ì  dead ` + I
+  {0x00CD, 0x0c | UNI_SHIFT | UNI_DEAD(1)},   // Í  dead ´ + I
+  {0x00CE, 0x0c | UNI_SHIFT | UNI_DEAD(4)},   // Î  dead ^ + I
+  {0x00CF, 0x0c | UNI_SHIFT | UNI_DEAD(5)},   // Ï  dead ¨ + I
+  {0x00D1, 0x11 | UNI_SHIFT | UNI_DEAD(3)},   // Ñ  dead ~ + N
+  {0x00D2, 0x12 | UNI_SHIFT | UNI_DEAD(2)},   // Ò  dead ` + O
+  {0x00D3, 0x12 | UNI_SHIFT | UNI_DEAD(1)},   // Ó  dead ´ + O
+  {0x00D4, 0x12 | UNI_SHIFT | UNI_DEAD(4)},   // Ô  dead ^ + O
+  {0x00D5, 0x12 | UNI_SHIFT | UNI_DEAD(3)},   // Õ  dead ~ + O
+  {0x00D6, 0x12 | UNI_SHIFT | UNI_DEAD(5)},   // Ö  dead ¨ + O
+  {0x00D9, 0x18 | UNI_SHIFT | UNI_DEAD(2)},   // Ù  dead ` + U
+  {0x00DA, 0x18 | UNI_SHIFT | UNI_DEAD(1)},   // Ú  dead ´ + U
+  {0x00DB, 0x18 | UNI_SHIFT | UNI_DEAD(4)},   // Û  dead ^ + U
+  {0x00DC, 0x18 | UNI_SHIFT | UNI_DEAD(5)},   // Ü  dead ¨ + U
+  {0x00DD, 0x1c | UNI_SHIFT | UNI_DEAD(1)},   // Ý  dead ´ + Y
+  {0x00E0, 0x04 | UNI_DEAD(2)},               // à  dead ` + a
+  {0x00E1, 0x04 | UNI_DEAD(1)},               // á  dead ´ + a
+  {0x00E2, 0x04 | UNI_DEAD(4)},               // â  dead ^ + a
+  {0x00E3, 0x04 | UNI_DEAD(3)},               // ã  dead ~ + a
+  {0x00E4, 0x04 | UNI_DEAD(5)},               // ä  dead ¨ + a
+  {0x00E7, 0x33},                             // ç
+  {0x00E8, 0x08 | UNI_DEAD(2)},               // è  dead ` + e
+  {0x00E9, 0x08 | UNI_DEAD(1)},               // é  dead ´ + e
+  {0x00EA, 0x08 | UNI_DEAD(4)},               // ê  dead ^ + e
+  {0x00EB, 0x08 | UNI_DEAD(5)},               // ë  dead ¨ + e
+  {0x00EC, 0x0c | UNI_DEAD(2)},               // ì  dead ` + i
+  {0x00ED, 0x0c | UNI_DEAD(1)},               // í  dead ´ + i
+  {0x00EE, 0x0c | UNI_DEAD(4)},               // î  dead ^ + i
+  {0x00EF, 0x0c | UNI_DEAD(5)},               // ï  dead ¨ + i
+  {0x00F1, 0x11 | UNI_DEAD(3)},               // ñ  dead ~ + n
+  {0x00F2, 0x12 | UNI_DEAD(2)},               // ò  dead ` + o
+  {0x00F3, 0x12 | UNI_DEAD(1)},               // ó  dead ´ + o
+  {0x00F4, 0x12 | UNI_DEAD(4)},               // ô  dead ^ + o
+  {0x00F5, 0x12 | UNI_DEAD(3)},               // õ  dead ~ + o
+  {0x00F6, 0x12 | UNI_DEAD(5)},               // ö  dead ¨ + o
+  {0x00F9, 0x18 | UNI_DEAD(2)},               // ù  dead ` + u
+  {0x00FA, 0x18 | UNI_DEAD(1)},               // ú  dead ´ + u
+  {0x00FB, 0x18 | UNI_DEAD(4)},               // û  dead ^ + u
+  {0x00FC, 0x18 | UNI_DEAD(5)},               // ü  dead ¨ + u
+  {0x00FD, 0x1c | UNI_DEAD(1)},               // ý  dead ´ + y
+  {0x00FF, 0x1c | UNI_DEAD(5)},               // ÿ  dead ¨ + y
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_pt_BR, keys, deadKeys);
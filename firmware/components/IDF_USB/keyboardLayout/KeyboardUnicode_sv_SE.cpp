@@ -0,0 +1,81 @@
+/*
+ * Swedish keyboard layout, characters beyond the ASCII table (see KeyboardUnicode.h).
+ */
+
+#include "KeyboardUnicode.h"
+
+static constexpr uint16_t deadKeys[] = {
+  0x0000,
+  0x2e,                    // 1: ´
+  0x2e | UNI_SHIFT,        // 2: `
+  0x30,                    // 3: ¨
+  0x30 | UNI_SHIFT,        // 4: ^
+  0x30 | UNI_ALTGR,        // 5: ~
+};
+
+static constexpr KeyboardUnicodeKey keys[] = {
+  {0x005E, 0x2c | UNI_DEAD(4)},               // ^  dead ^ + space
+  {0x0060, 0x2c | UNI_DEAD(2)},               // `  dead ` + space
+  {0x007E, 0x2c | UNI_DEAD(5)},               // ~  dead ~ + space
+  {0x00A3, 0x20 | UNI_ALTGR},                 // £
+  {0x00A4, 0x21 | UNI_SHIFT},                 // ¤
+  {0x00A7, 0x35},                             // §
+  {0x00A8, 0x2c | UNI_DEAD(3)},               // ¨  dead ¨ + space
+  {0x00B4, 0x2c | UNI_DEAD(1)},               // ´  dead ´ + space
+  {0x00B5, 0x10 | UNI_ALTGR},                 // µ
+  {0x00BD, 0x35 | UNI_SHIFT},                 // ½
+  {0x00C0, 0x04 | UNI_SHIFT | UNI_DEAD(2)},   // À  dead ` + A
+  {0x00C1, 0x04 | UNI_SHIFT | UNI_DEAD(1)},   // Á  dead ´ + A
+  {0x00C2, 0x04 | UNI_SHIFT | UNI_DEAD(4)},   // Â  dead ^ + A
+  {0x00C3, 0x04 | UNI_SHIFT | UNI_DEAD(5)},   // Ã  dead ~ + A
+  {0x00C4, 0x34 | UNI_SHIFT},                 // Ä
+  {0x00C5, 0x2f | UNI_SHIFT},                 // Å
+  {0x00C8, 0x08 | UNI_SHIFT | UNI_DEAD(2)},   // È  dead ` + E
+  {0x00C9, 0x08 | UNI_SHIFT | UNI_DEAD(1)},   // É  dead ´ + E
+  {0x00CA, 0x08 | UNI_SHIFT | UNI_DEAD(4)},   // Ê  dead ^ + E
+  {0x00CB, 0x08 | UNI_SHIFT | UNI_DEAD(3)},   // Ë  dead ¨ + E
+  {0x00CC, 0x0c | UNI_SHIFT | UNI_DEAD(2)},   // Ì  dead ` + I
+  {0x00CD, 0x0c | UNI_SHIFT | UNI_DEAD(1)},   // Í  dead ´ + I
+  {0x00CE, 0x0c | UNI_SHIFT | UNI_DEAD(4)},   // Î  dead ^ + I
+  {0x00CF, 0x0c | UNI_SHIFT | UNI_DEAD(3)},   // Ï  dead ¨ + I
+  {0x00D1, 0x11 | UNI_SHIFT | UNI_DEAD(5)},   // Ñ  dead ~ + N
+  {0x00D2, 0x12 | UNI_SHIFT | UNI_DEAD(2)},   // Ò  dead ` + O
+  {0x00D3, 0x12 | UNI_SHIFT | UNI_DEAD(1)},   // Ó  dead ´ + O
+  {0x00D4, 0x12 | UNI_SHIFT | UNI_DEAD(4)},   // Ô  dead ^ + O
+  {0x00D5, 0x12 | UNI_SHIFT | UNI_DEAD(5)},   // Õ  dead ~ + O
+  {0x00D6, 0x33 | UNI_SHIFT},                 // Ö
+  {0x00D9, 0x18 | UNI_SHIFT | UNI_DEAD(2)},   // Ù  dead ` + U
+  {0x00DA, 0x18 | UNI_SHIFT | UNI_DEAD(1)},   // Ú  dead ´ + U
+  {0x00DB, 0x18 | UNI_SHIFT | UNI_DEAD(4)},   // Û  dead ^ + U
+  {0x00DC, 0x18 | UNI_SHIFT | UNI_DEAD(3)},   // Ü  dead ¨ + U
+  {0x00DD, 0x1c | UNI_SHIFT | UNI_DEAD(1)},   // Ý  dead ´ + Y
+  {0x00E0, 0x04 | UNI_DEAD(2)},               // à  dead ` + a
+  {0x00E1, 0x04 | UNI_DEAD(1)},               // á  dead ´ + a
+  {0x00E2, 0x04 | UNI_DEAD(4)},               // â  dead ^ + a
+  {0x00E3, 0x04 | UNI_DEAD(5)},               // ã  dead ~ + a
+  {0x00E4, 0x34},                             // ä
+  {0x00E5, 0x2f},                             // å
+  {0x00E8, 0x08 | UNI_DEAD(2)},               // è  dead ` + e
+  {0x00E9, 0x08 | UNI_DEAD(1)},               // é  dead ´ + e
+  {0x00EA, 0x08 | UNI_DEAD(4)},               // ê  dead ^ + e
+  {0x00EB, 0x08 | UNI_DEAD(3)},               // ë  dead ¨ + e
+  {0x00EC, 0x0c | UNI_DEAD(2)},               // ì  dead ` + i
+  {0x00ED, 0x0c | UNI_DEAD(1)},               // í  dead ´ + i
+  {0x00EE, 0x0c | UNI_DEAD(4)},               // î  dead ^ + i
+  {0x00EF, 0x0c | UNI_DEAD(3)},               // ï  dead ¨ + i
+  {0x00F1, 0x11 | UNI_DEAD(5)},               // ñ  dead ~ + n
+  {0x00F2, 0x12 | UNI_DEAD(2)},               // ò  dead ` + o
+  {0x00F3, 0x12 | UNI_DEAD(1)},               // ó  dead ´ + o
+  {0x00F4, 0x12 | UNI_DEAD(4)},               // ô  dead ^ + o
+  {0x00F5, 0x12 | UNI_DEAD(5)},               // õ  dead ~ + o
+  {0x00F6, 0x33},                             // ö
+  {0x00F9, 0x18 | UNI_DEAD(2)},               // ù  dead ` + u
+  {0x00FA, 0x18 | UNI_DEAD(1)},               // ú  dead ´ + u
+  {0x00FB, 0x18 | UNI_DEAD(4)},               // û  dead ^ + u
+  {0x00FC, 0x18 | UNI_DEAD(3)},               // ü  dead ¨ + u
+  {0x00FD, 0x1c | UNI_DEAD(1)},               // ý  dead ´ + y
+  {0x00FF, 0x1c | UNI_DEAD(3)},               // ÿ  dead ¨ + y
+  {0x20AC, 0x08 | UNI_ALTGR},                 // €
+};
+
+KEYBOARD_UNICODE_LAYOUT(KeyboardUnicode_sv_SE, keys, deadKeys);
@@ -221,6 +221,30 @@ int SecureSession::deriveAESKeyFromSecret(const char* base64pubKey)
     return ret;
 }
 
+// Copy out the session AES key, false if there is none
+bool SecureSession::exportSessionKey(uint8_t key[ENC_KEYSIZE]) const
+{
+    if (!aesKeyReady)
+        return false;
+
+    memcpy(key, aesKey, ENC_KEYSIZE);
+    return true;
+}
+
+// Continue an earlier session with its AES key (the client proves it holds the key before this is trusted)
+void SecureSession::resumeSessionKey(const uint8_t key[ENC_KEYSIZE])
+{
+    memcpy(aesKey, key, ENC_KEYSIZE);
+    aesKeyReady = true;
+}
+
+// Clear the session AES key from RAM
+void SecureSession::endSession()
+{
+    memset(aesKey, 0, ENC_KEYSIZE);
+    aesKeyReady = false;
+}
+
 // Encrypt a given text string using gcm
 int SecureSession::encrypt(
     const uint8_t* plaintext, // Text data to be encrypted
@@ -264,8 +288,14 @@ int SecureSession::decrypt(
     const uint8_t* ciphertext,
     const uint8_t tag[TAG_SIZE],
     uint8_t* plaintext_out,
-    const char* base64pubKey)
+    const char* base64pubKey,
+    const uint8_t* aad,
+    size_t aad_len)
 {
+    // Nothing decrypts before the session has a key
+    if (!aesKeyReady)
+        return -1;
+
     // Use the session AES key for decryption
     mbedtls_gcm_init(&gcm);
     int ret = mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, aesKey, ENC_KEYSIZE * 8);
@@ -276,7 +306,7 @@ int SecureSession::decrypt(
     ret = mbedtls_gcm_auth_decrypt(&gcm,
         ciphertext_len,
         iv, IV_SIZE,
-        nullptr, 0,
+        aad, aad_len,
         tag,
         TAG_SIZE,
         ciphertext,
@@ -452,3 +482,30 @@ bool SecureSession::setDeviceName(const char* deviceName){
     return ret;
 }
 
+// Get the keyboard layout a client last selected
+bool SecureSession::getClientLayout(const char* base64pubKey, uint8_t &layout){
+    preferences.begin("layouts", true);
+    String hashedKey = hashKey(base64pubKey);
+    bool ret = preferences.isKey(hashedKey.c_str());
+    if(ret){
+        layout = preferences.getUChar(hashedKey.c_str());
+    }
+
+    preferences.end();
+    return ret;
+}
+
+// Remember the keyboard layout a client selected
+bool SecureSession::setClientLayout(const char* base64pubKey, uint8_t layout){
+    preferences.begin("layouts", false);
+    String hashedKey = hashKey(base64pubKey);
+
+    // Skip the flash write if nothing changed
+    bool ret = preferences.isKey(hashedKey.c_str()) && preferences.getUChar(hashedKey.c_str()) == layout;
+    if(!ret){
+        ret = preferences.putUChar(hashedKey.c_str(), layout) == sizeof(layout);
+    }
+
+    preferences.end();
+    return ret;
+}
@@ -50,14 +50,16 @@ public:
         uint8_t TAG[TAG_SIZE],
         const char* base64pubKey);
 
-    // Decrypt ciphertext buffer using IV and auth tag
+    // Decrypt ciphertext buffer using IV and auth tag, <aad> is authenticated but not encrypted
     int decrypt(
         const uint8_t IV[IV_SIZE],
         size_t ciphertext_len,
         const uint8_t* ciphertext, 
         const uint8_t TAG[TAG_SIZE],
         uint8_t* plaintext_out,
-        const char* base64pubKey
+        const char* base64pubKey,
+        const uint8_t* aad = nullptr,
+        size_t aad_len = 0
     );
     
     int decrypt(toothpaste_DataPacket* packet, uint8_t* decrypted_out, const char* base64pubKey);
@@ -71,9 +73,20 @@ public:
     bool getDeviceName(String &deviceName);
     bool setDeviceName(const char* deviceName);
 
+    // Per-client settings, keyed by the client's public key
+    bool getClientLayout(const char* base64pubKey, uint8_t &layout);
+    bool setClientLayout(const char* base64pubKey, uint8_t layout);
+
     // Derive AES key from stored shared secret on-demand
     int deriveAESKeyFromSecret(const char* base64pubKey);
 
+    // Session resumption, a dropped session's AES key is carried over instead of deriving a new one
+    bool exportSessionKey(uint8_t key[ENC_KEYSIZE]) const;
+    void resumeSessionKey(const uint8_t key[ENC_KEYSIZE]);
+
+    // Forget the session AES key, decryption fails until a key is derived or resumed
+    void endSession();
+
 private:
 
     // The gcm context 
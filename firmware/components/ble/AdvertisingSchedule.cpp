@@ -0,0 +1,14 @@
+#include "AdvertisingSchedule.h"
+
+void AdvertisingSchedule::start(Tier first, bool directedPossible) {
+  current = first;
+  if (current == ADV_DIRECTED && !directedPossible) {
+    current = ADV_BURST;
+  }
+}
+
+void AdvertisingSchedule::expired() {
+  if (current < ADV_SLOW) {
+    current = (Tier)(current + 1);
+  }
+}
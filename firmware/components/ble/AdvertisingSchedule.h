@@ -0,0 +1,50 @@
+#ifndef ADVERTISING_SCHEDULE_H
+#define ADVERTISING_SCHEDULE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// One step of the advertising schedule, intervals in 0.625 ms units
+typedef struct {
+    uint16_t intervalMin;
+    uint16_t intervalMax;
+    uint32_t durationMs;            // 0 = until a client connects
+    bool directed;                  // High duty cycle directed advertising to the last client
+} AdvertisingTier;
+
+// Tiered advertising, a dropped client finds the device again within a few short intervals
+// and the device steps down to a slow interval once nobody has come back for it
+// Only the tier logic lives here so the host tools can replay it
+class AdvertisingSchedule {
+public:
+    enum Tier : uint8_t {
+        ADV_DIRECTED,   // Addressed to the client that just left, connectable by it alone
+        ADV_BURST,      // The first seconds after a drop or boot
+        ADV_FAST,       // Still likely to be looked for
+        ADV_SLOW,       // Idle, until a client connects
+        ADV_TIER_COUNT
+    };
+
+    static constexpr AdvertisingTier TIERS[ADV_TIER_COUNT] = {
+        { 0, 0, 1280, true },               // The controller picks the interval (<= 3.75 ms) and caps it at 1.28 s
+        { 32, 48, 5000, false },            // 20 - 30 ms for 5 s
+        { 244, 338, 30000, false },         // 152.5 - 211.25 ms for 30 s
+        { 1636, 2056, 0, false },           // 1022.5 - 1285 ms
+    };
+
+    AdvertisingSchedule() : current(ADV_SLOW) {}
+
+    // Start the schedule at <first>, directed advertising is skipped unless the last client can be addressed
+    void start(Tier first, bool directedPossible);
+
+    // The current tier ran its duration (or could not start), step down
+    void expired();
+
+    Tier tier() const { return current; }
+    const AdvertisingTier& params() const { return TIERS[current]; }
+
+private:
+    Tier current;
+};
+
+#endif // ADVERTISING_SCHEDULE_H
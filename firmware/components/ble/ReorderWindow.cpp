@@ -0,0 +1,79 @@
+#include "ReorderWindow.h"
+
+ReorderWindow::ReorderWindow() {
+  reset();
+}
+
+void ReorderWindow::reset() {
+  expected = 0;
+  heldCount = 0;
+  for (size_t i = 0; i < SIZE; i++) {
+    held[i] = false;
+    sequences[i] = 0;
+    slots[i].plaintext.clear();
+    slots[i].plaintext.shrink_to_fit();
+  }
+}
+
+void ReorderWindow::resume(uint16_t next) {
+  reset();
+  expected = next;
+}
+
+ReorderWindow::Result ReorderWindow::offer(uint16_t sequence, SequencedWrite& write) {
+  int16_t ahead = (int16_t)(sequence - expected);
+  if (ahead < 0) {
+    return REORDER_DUPLICATE;
+  }
+  if (ahead == 0) {
+    expected++;
+    return REORDER_DELIVER;
+  }
+  if (ahead > SIZE) {
+    return REORDER_TOO_FAR;
+  }
+
+  size_t slot = sequence % SIZE;
+  if (held[slot]) {
+    return REORDER_DUPLICATE;
+  }
+  held[slot] = true;
+  sequences[slot] = sequence;
+  slots[slot] = std::move(write);
+  heldCount++;
+  return REORDER_HELD;
+}
+
+bool ReorderWindow::next(SequencedWrite& write) {
+  if (!isHeld(expected)) {
+    return false;
+  }
+
+  size_t slot = expected % SIZE;
+
+  write = std::move(slots[slot]);
+  held[slot] = false;
+  heldCount--;
+  expected++;
+  return true;
+}
+
+bool ReorderWindow::skipGap() {
+  if (heldCount == 0) {
+    return false;
+  }
+  while (!isHeld(expected)) {
+    expected++;
+  }
+  return true;
+}
+
+uint32_t ReorderWindow::sackBits() const {
+  uint32_t bits = 0;
+  for (uint16_t i = 0; i < SIZE; i++) {
+    if (isHeld((uint16_t)(expected + 1 + i))) {
+      bits |= 1UL << i;
+    }
+  }
+  return bits;
+}
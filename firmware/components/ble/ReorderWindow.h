@@ -0,0 +1,64 @@
+#ifndef REORDER_WINDOW_H
+#define REORDER_WINDOW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// A decrypted write waiting for its turn
+typedef struct {
+    bool lean;                      // Lean frame body, otherwise a serialized EncryptedData
+    bool slowMode;
+    std::vector<uint8_t> plaintext;
+} SequencedWrite;
+
+// Receive window for sequenced writes, sequence numbers are 16 bit and wrap
+// Each sequence is delivered once and in order, writes that arrive ahead of a gap wait here for it
+// Only authenticated writes may be offered, a forged sequence number would otherwise block the real one
+class ReorderWindow {
+public:
+    static constexpr uint16_t SIZE = 32; // Writes held past a gap, one SACK bitmap covers them all
+
+    enum Result : uint8_t {
+        REORDER_DELIVER,    // Next in order, apply it then drain with next()
+        REORDER_HELD,       // Ahead of a gap, kept until the gap fills or is skipped
+        REORDER_DUPLICATE,  // Already delivered or already held
+        REORDER_TOO_FAR     // Beyond the window, the sender will see it unacknowledged and resend
+    };
+
+    ReorderWindow();
+
+    // Forget everything, the window starts at sequence 0 (a new session numbers its writes from 0)
+    void reset();
+
+    // Forget everything, the window continues at <next> (a resumed session, everything before was applied)
+    void resume(uint16_t next);
+
+    // Classify a write, a held write is moved into the window
+    Result offer(uint16_t sequence, SequencedWrite& write);
+
+    // The next held write if it is now in order
+    bool next(SequencedWrite& write);
+
+    // Give up on the missing writes before the first held one, false if nothing is held
+    bool skipGap();
+
+    bool hasGap() const { return heldCount > 0; }
+
+    // Last sequence delivered in order
+    uint16_t cumulative() const { return (uint16_t)(expected - 1); }
+
+    // Bit i set = sequence cumulative() + 2 + i is held
+    uint32_t sackBits() const;
+
+private:
+    bool isHeld(uint16_t sequence) const { return held[sequence % SIZE] && sequences[sequence % SIZE] == sequence; }
+
+    uint16_t expected;              // Next sequence to deliver
+    size_t heldCount;
+    bool held[SIZE];                // Indexed by sequence % SIZE, the next expected sequence is never held
+    uint16_t sequences[SIZE];       // so only it can share a slot with the last sequence the window takes
+    SequencedWrite slots[SIZE];
+};
+
+#endif // REORDER_WINDOW_H
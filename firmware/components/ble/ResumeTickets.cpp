@@ -0,0 +1,93 @@
+#include "ResumeTickets.h"
+
+#include <string.h>
+
+ResumeTickets::ResumeTickets() {
+  for (ResumeTicket& ticket : tickets) {
+    clear(ticket);
+  }
+}
+
+void ResumeTickets::clear(ResumeTicket& ticket) {
+  volatile uint8_t* key = ticket.key; // Don't let the wipe be optimized away
+  for (size_t i = 0; i < KEY_SIZE; i++) {
+    key[i] = 0;
+  }
+  memset(ticket.id, 0, ID_SIZE);
+  ticket.pubKey.clear();
+  ticket.owner = nullptr;
+  ticket.expires = 0;
+  ticket.nextSequence = 0;
+  ticket.valid = false;
+}
+
+void ResumeTickets::issue(const void* owner, const uint8_t id[ID_SIZE], const uint8_t key[KEY_SIZE], const std::string& pubKey) {
+  // The owner's own ticket, else a free one, else the ended session closest to lapsing
+  ResumeTicket* slot = nullptr;
+  for (ResumeTicket& ticket : tickets) {
+    if (ticket.valid && ticket.owner == owner) {
+      slot = &ticket;
+      break;
+    }
+  }
+  for (size_t i = 0; slot == nullptr && i < COUNT; i++) {
+    if (!tickets[i].valid) {
+      slot = &tickets[i];
+    }
+  }
+  if (slot == nullptr) {
+    for (ResumeTicket& ticket : tickets) {
+      if (ticket.owner == nullptr && (slot == nullptr || ticket.expires < slot->expires)) {
+        slot = &ticket;
+      }
+    }
+  }
+  if (slot == nullptr) {
+    return; // Every ticket belongs to a live session
+  }
+
+  clear(*slot);
+  memcpy(slot->id, id, ID_SIZE);
+  memcpy(slot->key, key, KEY_SIZE);
+  slot->pubKey = pubKey;
+  slot->owner = owner;
+  slot->valid = true;
+}
+
+void ResumeTickets::end(const void* owner, uint16_t nextSequence, int64_t now, int64_t lifetimeUs) {
+  for (ResumeTicket& ticket : tickets) {
+    if (ticket.valid && ticket.owner == owner) {
+      ticket.owner = nullptr;
+      ticket.nextSequence = nextSequence;
+      ticket.expires = now + lifetimeUs;
+    }
+  }
+}
+
+bool ResumeTickets::find(const uint8_t* id, size_t length, int64_t now, ResumeTicket& ticket) {
+  if (length != ID_SIZE) {
+    return false;
+  }
+
+  for (ResumeTicket& candidate : tickets) {
+    if (!candidate.valid || candidate.owner != nullptr || memcmp(candidate.id, id, ID_SIZE) != 0) {
+      continue;
+    }
+
+    if (now >= candidate.expires) {
+      clear(candidate); // Lapsed, nothing can redeem it any more
+      return false;
+    }
+    ticket = candidate;
+    return true;
+  }
+  return false;
+}
+
+void ResumeTickets::consume(const uint8_t id[ID_SIZE]) {
+  for (ResumeTicket& ticket : tickets) {
+    if (ticket.valid && ticket.owner == nullptr && memcmp(ticket.id, id, ID_SIZE) == 0) {
+      clear(ticket);
+    }
+  }
+}
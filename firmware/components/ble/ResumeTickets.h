@@ -0,0 +1,47 @@
+#ifndef RESUME_TICKETS_H
+#define RESUME_TICKETS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// A session a client can pick up again without authenticating, held in RAM only
+typedef struct {
+    uint8_t id[16];                 // Random, sent to the client with its CHALLENGE or RESUMED
+    uint8_t key[32];                // The session's AES key, the client proves it holds it by resuming
+    std::string pubKey;             // Base64 public key the session was authenticated with
+    const void* owner;              // Live session holding the ticket, null once it has ended
+    int64_t expires;                // Device time (us) the ticket lapses, counted from the end of the session
+    uint16_t nextSequence;          // First sequenced write the session did not apply
+    bool valid;
+} ResumeTicket;
+
+// Resumption tickets, one per session, redeemable once within a short time of the session ending
+class ResumeTickets {
+public:
+    static constexpr size_t COUNT = 4;      // More than the clients connected at once, so ended sessions have room
+    static constexpr size_t ID_SIZE = sizeof(ResumeTicket::id);
+    static constexpr size_t KEY_SIZE = sizeof(ResumeTicket::key);
+
+    ResumeTickets();
+
+    // Issue a ticket for <owner>'s live session, replacing any it holds
+    // Room comes from a free slot, then an ended session (the one closest to lapsing)
+    void issue(const void* owner, const uint8_t id[ID_SIZE], const uint8_t key[KEY_SIZE], const std::string& pubKey);
+
+    // <owner>'s session ended at <now>, its ticket can be redeemed until <now> + <lifetimeUs>
+    void end(const void* owner, uint16_t nextSequence, int64_t now, int64_t lifetimeUs);
+
+    // Copy out the ended, unexpired ticket with <id>, it stays until consume() so a write that fails to authenticate can't spend it
+    bool find(const uint8_t* id, size_t length, int64_t now, ResumeTicket& ticket);
+
+    // Remove the ticket with <id> once a resume with it has succeeded
+    void consume(const uint8_t id[ID_SIZE]);
+
+private:
+    void clear(ResumeTicket& ticket);
+
+    ResumeTicket tickets[COUNT];
+};
+
+#endif // RESUME_TICKETS_H
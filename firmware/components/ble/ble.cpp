@@ -2,194 +2,537 @@
 #include "NeoPixelRMT.h"
 #include "StateManager.h"
 #include "esp_system.h"
+#include "esp_random.h"
 #include "esp_log.h"
 
 #include "pb_decode.h"
 #include "pb_encode.h"
 #include "pb_common.h"
 
-BLEServer* bluServer = NULL;                      // Pointer to the BLE Server instance
-BLECharacteristic* inputCharacteristic = NULL;    // Characteristic for sensor data
-BLECharacteristic* responseCharacteristic = NULL; // Characteristic for LED control
-BLECharacteristic* macCharacteristic = NULL;
-
-QueueHandle_t packetQueue = xQueueCreate(50, sizeof(SharedSecretTaskParams*)); // Queue to manage RTOS task parameters
+#include "esp_bt.h"
+#include "nimble/nimble_port.h"
+#include "nimble/nimble_port_freertos.h"
+#include "host/ble_hs.h"
+#include "host/util/util.h"
+#include "services/gap/ble_svc_gap.h"
+#include "services/gatt/ble_svc_gatt.h"
+
+#if BLE_MAX_CLIENTS > CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+#error "BLE_MAX_CLIENTS exceeds the connections NimBLE is configured for"
+#endif
+static_assert(BLE_MAX_CLIENTS < ResumeTickets::COUNT, "every live session holds a ticket, ended ones need room too");
+static_assert(ResumeTickets::KEY_SIZE == SecureSession::ENC_KEYSIZE, "tickets hold session AES keys");
+
+// GATT UUIDs in NimBLE's little endian byte order
+static const ble_uuid128_t serviceUuid = BLE_UUID128_INIT(  // SERVICE_UUID
+  0x14, 0x12, 0x8a, 0x76, 0x04, 0xd1, 0x6c, 0x4f, 0x7e, 0x53, 0xf2, 0xe8, 0x00, 0x00, 0xb1, 0x19);
+static const ble_uuid128_t inputUuid = BLE_UUID128_INIT(    // TX_TO_TOOTHPASTE_CHARACTERISTIC
+  0x07, 0x59, 0x2c, 0xdd, 0x7d, 0xcf, 0x42, 0xbf, 0x5a, 0x45, 0x7b, 0x2c, 0x19, 0xe1, 0x56, 0x68);
+static const ble_uuid128_t responseUuid = BLE_UUID128_INIT( // RESPONSE_CHARACTERISTIC
+  0x08, 0x59, 0x2c, 0xdd, 0x7d, 0xcf, 0x42, 0xbf, 0x5a, 0x45, 0x7b, 0x2c, 0x19, 0xe1, 0x56, 0x68);
+static const ble_uuid128_t macUuid = BLE_UUID128_INIT(      // MAC_CHARACTERISTIC_UUID
+  0x14, 0x12, 0x8a, 0x76, 0x04, 0xd1, 0x6c, 0x4f, 0x7e, 0x53, 0xf2, 0xe8, 0x02, 0x00, 0xb1, 0x19);
+
+uint16_t inputHandle = 0;                         // Attribute handles, filled in when the service is registered
+uint16_t responseHandle = 0;
+uint16_t macHandle = 0;
+uint8_t macValue[6];                              // Value of the MAC address characteristic
+uint8_t ownAddrType = BLE_OWN_ADDR_PUBLIC;
+
+ClientContext clients[BLE_MAX_CLIENTS];           // Connected centrals, keyed by connection handle
+ClientContext* currentClient = nullptr;           // Client whose write the packet task is handling, its auth and session replies go to it
+TaskHandle_t packetTaskHandle = nullptr;          // Notified for every queued write, SACK tick and disconnect
 
 bool manualDisconnect = false; // Flag to indicate if the user manually disconnected
-std::string clientPubKey;  // safer than char*
+
+AdvertisingSchedule advertising;                  // Steps from fast to slow advertising after a drop
+ble_addr_t lastPeer = {};                         // Identity address of the client that left last
+
+esp_timer_handle_t gamepadAckTimer = nullptr; // Coalesces gamepad acknowledgements
+volatile uint32_t gamepadAckSequence = 0;     // Latest applied gamepad state
+ClientContext* gamepadAckClient = nullptr;    // Client that sent it
+ClientContext* scriptClient = nullptr;        // Client that started the running script, its disconnect stops it
+ClientContext* syncClient = nullptr;          // Client whose field the sync state mirrors
+
+ResumeTickets resumeTickets;                  // Sessions that can be resumed after a drop, only touched by the packet task
+
+esp_timer_handle_t hostStateTimer = nullptr;  // Coalesces host LED change notifications
+int16_t notifiedHostLeds = -1;                // Lock state the clients were last told about, -1 before the first
+
+MacroStore macroStore;                        // Encrypted macros in their own flash partition
+SecureSession* macroSession = nullptr;        // Session stored macros act on (device settings only, never the client key)
+volatile bool macroRunning = false;           // One macro plays at a time
+
+// Playout buffer, timestamped input is held for a fixed delay and applied at its original spacing
+typedef struct {
+  int64_t due;                          // Device time (us) to apply the packet
+  bool slowMode;
+  ClientContext* client;                // Client that sent it
+  uint32_t generation;                  // Its slot's generation when it was sent, a reset slot is somebody else
+  toothpaste_EncryptedData packet;
+} PlayoutItem;
+
+QueueHandle_t playoutQueue = nullptr;
+volatile int64_t playoutDelayUs = 0;    // 0 = timestamps are ignored
+esp_timer_handle_t playoutTimer = nullptr;
 
 // Create the persistent RTOS packet handler task
-void createPacketTask(SecureSession* sec) {
+void createPacketTask() {
   // Start the persistent RTOS task
   xTaskCreatePinnedToCore(
     packetTask,
     "PacketWorker",
     8192,
-    sec, // Persistent task shares 1 ECDH session
+    nullptr, // Each client brings its own session
     1,
-    nullptr,
+    &packetTaskHandle,
     1
   );
 }
 
+// The connected client holding <connHandle>, null if it has none
+ClientContext* findClient(uint16_t connHandle)
+{
+  for (ClientContext& client : clients) {
+    if (client.connected && client.connHandle == connHandle) {
+      return &client;
+    }
+  }
+  return nullptr;
+}
+
+// Number of connected clients
+size_t connectedClients()
+{
+  size_t count = 0;
+  for (ClientContext& client : clients) {
+    count += client.connected;
+  }
+  return count;
+}
 
 // Handle Connect
-void DeviceServerCallbacks::onConnect(BLEServer* bluServer)
+void clientConnected(uint16_t connHandle)
 {
-  int connectedCount = bluServer->getConnectedCount();
+  // Take a free slot, one the packet task has not reset yet still holds the last client's writes
+  ClientContext* client = nullptr;
+  for (ClientContext& slot : clients) {
+    if (!slot.connected && !slot.resetPending) {
+      client = &slot;
+      break;
+    }
+  }
+  if (client == nullptr) {
+    ble_gap_terminate(connHandle, BLE_ERR_RD_CONN_TERM_RESRC); // Every slot is taken
+    return;
+  }
+
+  bool first = connectedClients() == 0;
+  client->connHandle = connHandle;
+  client->linkFast = false;
+  client->connected = true;
+  esp_ble_tx_power_set((esp_ble_power_type_t)(ESP_BLE_PWR_TYPE_CONN_HDL0 + connHandle), ESP_PWR_LVL_P9); // Max power once connected (as per IDF API standard)
 
-  // If a device is not already connected
-  if (connectedCount == 0) {
-    esp_ble_tx_power_set(ESP_BLE_PWR_TYPE_CONN_HDL0, ESP_PWR_LVL_P9); // Max power once connected (as per IDF API standard)
+  // Ask for the 2M PHY and full length PDUs, a paste chunk then fits one PDU and goes out in half the air time
+  // Either can be refused by the central, the link keeps working at 1M PHY and 27 byte PDUs
+  ble_gap_set_prefered_le_phy(connHandle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+  ble_gap_set_data_len(connHandle, LINK_DATA_LENGTH, LINK_DATA_TIME);
+  linkActive(client); // The client is about to authenticate and type
 
+  if (first) {
     stateManager->setState(UNPAIRED);
   }
-  // (since WEB-BLE does not auto connect this means the device can be restarted for new connections)
-  // TODO: This will need to be improved later
-  else {
-    uint16_t newClient = bluServer->getConnId();
-    bluServer->disconnect(newClient);
+
+  // Keep advertising while there is room for another client
+  if (connectedClients() < BLE_MAX_CLIENTS) {
+    advertising.start(AdvertisingSchedule::ADV_FAST, false);
+    startAdvertising();
   }
-};
+}
 
-// Handle Disconnect
-void DeviceServerCallbacks::onDisconnect(BLEServer* bluServer)
+// Handle Disconnect, <peer> is the client's identity address
+void clientDisconnected(uint16_t connHandle, const ble_addr_t& peer)
 {
-  // If there are no devices connected (otherwise the disconnect was a result of a new client being rejected)
-  if (bluServer->getConnectedCount() <= 1) { // getConnectedCount() doesnt change until much later after the callback fires so clients will be 1 at disconnect time as well
-    if (manualDisconnect)
-    {
-      manualDisconnect = false;             // Reset the flag if the disconnection was manual
-      stateManager->setState(NOT_CONNECTED);
-      return;                               // Do not blink if the disconnection was manual
-    }
+  // Only a client's own disconnect counts (otherwise the disconnect was a result of a new client being rejected)
+  ClientContext* client = findClient(connHandle);
+  if (client == nullptr) {
+    return;
+  }
 
-    else
-    {
-      stateManager->setState(DISCONNECTED);
+  client->connected = false;
+  client->resetPending = true; // The packet task drops its queued writes, the next client numbers its writes from scratch
+  client->linkFast = false;    // Parameters belong to the connection
+  if (client->linkIdleTimer != nullptr) {
+    esp_timer_stop(client->linkIdleTimer);
+  }
+  if (gamepadAckClient == client) {
+    gamepadAckClient = nullptr;
+    resetGamepad(); // Its sticks and buttons go with it
+  }
+  if (scriptClient == client) {
+    scriptClient = nullptr;
+    stopScript(); // A script it started has nobody left to stop it
+  }
+  if (syncClient == client) {
+    syncClient = nullptr;
+    resetSync(); // The next client can't know what was typed into the field
+  }
+  client->releasePending = connectedClients() == 0; // Keys another client still holds stay pressed
+  xTaskNotifyGive(packetTaskHandle);
+
+  // Advertise straight to the client that left if its address is stable (public or static random), it is the one most likely to come back
+  lastPeer = peer;
+  bool directable = peer.type == BLE_ADDR_PUBLIC || (peer.type == BLE_ADDR_RANDOM && (peer.val[5] & 0xC0) == 0xC0);
+  advertising.start(AdvertisingSchedule::ADV_DIRECTED, directable);
+
+  // Other clients keep typing, only the last one leaving resets what a stored macro left behind
+  if (connectedClients() > 0) {
+    startAdvertising(); // The slot is free again
+    return;
+  }
+
+  resetGamepad();
+  resetSync();
+  stopScript();   // Nobody is left to stop a script a macro started
+
+  if (manualDisconnect)
+  {
+    manualDisconnect = false;             // Reset the flag if the disconnection was manual
+    stateManager->setState(NOT_CONNECTED);
+    return;                               // Do not blink if the disconnection was manual
+  }
+
+  else
+  {
+    stateManager->setState(DISCONNECTED);
+  }
+
+  startAdvertising(); // Restart advertising
+}
+
+// GAP events from the NimBLE host task
+int gapEvent(struct ble_gap_event* event, void* arg)
+{
+  switch (event->type) {
+    case BLE_GAP_EVENT_CONNECT:
+      if (event->connect.status == 0) {
+        clientConnected(event->connect.conn_handle);
+      }
+      else if (connectedClients() < BLE_MAX_CLIENTS) {
+        startAdvertising(); // The connection attempt failed
+      }
+      break;
+
+    case BLE_GAP_EVENT_DISCONNECT:
+      clientDisconnected(event->disconnect.conn.conn_handle, event->disconnect.conn.peer_id_addr);
+      break;
+
+    case BLE_GAP_EVENT_ADV_COMPLETE:
+      if (event->adv_complete.reason == BLE_HS_ETIMEOUT) {
+        advertising.expired(); // The tier ran its course, step down
+      }
+      if (connectedClients() < BLE_MAX_CLIENTS) {
+        startAdvertising();
+      }
+      break;
+
+    case BLE_GAP_EVENT_MTU:
+      DEBUG_SERIAL_PRINTF("MTU is now %d\n", event->mtu.value);
+      break;
+
+    default:
+      break;
+  }
+  return 0;
+}
+
+// Advertise the service UUID, the device name goes in the scan response
+// Intervals and duration come from the current advertising tier, running advertising is restarted with them
+void startAdvertising()
+{
+  if (ble_gap_adv_active()) {
+    ble_gap_adv_stop();
+  }
+
+  ble_hs_adv_fields fields = {};
+  fields.flags = BLE_HS_ADV_F_DISC_GEN | BLE_HS_ADV_F_BREDR_UNSUP;
+  fields.uuids128 = &serviceUuid;
+  fields.num_uuids128 = 1;
+  fields.uuids128_is_complete = 1;
+  int rc = ble_gap_adv_set_fields(&fields);
+  if (rc != 0) {
+    DEBUG_SERIAL_PRINTF("Setting advertising data failed: %d\n", rc);
+    return;
+  }
+
+  const char* name = ble_svc_gap_device_name();
+  ble_hs_adv_fields scanResponse = {};
+  scanResponse.name = (const uint8_t*)name;
+  scanResponse.name_len = strlen(name);
+  scanResponse.name_is_complete = 1;
+  ble_gap_adv_rsp_set_fields(&scanResponse);
+
+  const AdvertisingTier& tier = advertising.params();
+  ble_gap_adv_params params = {};
+  int32_t duration = tier.durationMs > 0 ? (int32_t)tier.durationMs : BLE_HS_FOREVER;
+  if (tier.directed) {
+    // Only the last client can connect, nothing to scan so the fields above go unused
+    params.conn_mode = BLE_GAP_CONN_MODE_DIR;
+    params.disc_mode = BLE_GAP_DISC_MODE_NON;
+    params.high_duty_cycle = 1;
+    rc = ble_gap_adv_start(ownAddrType, &lastPeer, duration, &params, gapEvent, nullptr);
+    if (rc != 0) {
+      DEBUG_SERIAL_PRINTF("Directed advertising failed: %d\n", rc);
+      advertising.expired(); // Fall back to undirected advertising
+      startAdvertising();
     }
+    return;
+  }
 
-    bluServer->startAdvertising(); // Restart advertising
+  params.conn_mode = BLE_GAP_CONN_MODE_UND;
+  params.disc_mode = BLE_GAP_DISC_MODE_GEN;
+  params.itvl_min = tier.intervalMin;
+  params.itvl_max = tier.intervalMax;
+  rc = ble_gap_adv_start(ownAddrType, nullptr, duration, &params, gapEvent, nullptr);
+  if (rc != 0 && rc != BLE_HS_EALREADY) {
+    DEBUG_SERIAL_PRINTF("Starting advertising failed: %d\n", rc);
   }
 }
 
-// Callback constructor for BLE Input Characteristic events
-InputCharacteristicCallbacks::InputCharacteristicCallbacks(SecureSession* session) : session(session) {}
+// Request connection parameters for a client, the central decides and may keep its own
+void requestLinkParams(ClientContext* client, bool fast) {
+  ble_gap_upd_params params = {};
+  params.itvl_min = fast ? LINK_ACTIVE_INTERVAL_MIN : LINK_IDLE_INTERVAL_MIN;
+  params.itvl_max = fast ? LINK_ACTIVE_INTERVAL_MAX : LINK_IDLE_INTERVAL_MAX;
+  params.latency = fast ? LINK_ACTIVE_LATENCY : LINK_IDLE_LATENCY;
+  params.supervision_timeout = LINK_SUPERVISION_TIMEOUT;
+
+  int rc = ble_gap_update_params(client->connHandle, &params);
+  if (rc != 0) {
+    DEBUG_SERIAL_PRINTF("Connection parameter update failed: %d\n", rc);
+  }
+}
+
+// Timer callback that relaxes a client's link once its input has stopped, input since the timer was armed pushes it back
+void relaxLink(void* arg) {
+  ClientContext* client = static_cast<ClientContext*>(arg);
+  if (!client->connected) {
+    return;
+  }
 
-// Callback handler for BLE Input Characteristic onWrite events
-void InputCharacteristicCallbacks::onWrite(BLECharacteristic* inputCharacteristic)
+  int64_t idle = esp_timer_get_time() - client->lastInputTime;
+  if (idle < LINK_IDLE_TIMEOUT_US) {
+    esp_timer_start_once(client->linkIdleTimer, LINK_IDLE_TIMEOUT_US - idle);
+    return;
+  }
+
+  client->linkFast = false;
+  requestLinkParams(client, false);
+}
+
+// Note input on a client's link, a relaxed link is switched back to the short interval
+// Called for every write, so it only touches the timer when the link changes speed
+void linkActive(ClientContext* client) {
+  client->lastInputTime = esp_timer_get_time();
+  if (client->linkFast) {
+    return;
+  }
+
+  if (client->linkIdleTimer == nullptr) {
+    esp_timer_create_args_t timer_args = {
+      .callback = &relaxLink,
+      .arg = client,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "linkIdle"
+    };
+    esp_timer_create(&timer_args, &client->linkIdleTimer);
+  }
+
+  client->linkFast = true;
+  requestLinkParams(client, true);
+  esp_timer_stop(client->linkIdleTimer);
+  esp_timer_start_once(client->linkIdleTimer, LINK_IDLE_TIMEOUT_US);
+}
+
+// Input characteristic access, a write is copied out of the mbuf chain straight into its client's queue
+int inputAccess(uint16_t connHandle, uint16_t attrHandle, struct ble_gatt_access_ctxt* ctxt, void* arg)
 {
+  if (ctxt->op != BLE_GATT_ACCESS_OP_WRITE_CHR) {
+    return 0; // Reads see an empty value
+  }
+
   int64_t t0 = esp_timer_get_time();
-  const uint8_t* bleData = inputCharacteristic->getData();
-  size_t bleLen = inputCharacteristic->getLength();
-  //std::string rawValue = std::string(inputCharacteristic->getValue().c_str(), inputCharacteristic->getLength()); // Convert to std::string for easier handling
-  // Receive base64 encoded value
-  if (bleLen != 0 && session != nullptr)
-  {
-    std::vector<uint8_t> rawCopy(bleData, bleData + bleLen); // allocate a heap copy of the received packet
-    auto* taskParams = new SharedSecretTaskParams{ session, std::move(rawCopy) }; // Create the parameters passed to the RTOS task
+  uint16_t bleLen = OS_MBUF_PKTLEN(ctxt->om);
+  ClientContext* client = findClient(connHandle);
+  if (bleLen == 0 || client == nullptr) {
+    return 0;
+  }
 
+  linkActive(client);
+  DEBUG_SERIAL_PRINTF("Received data on Input Characteristic: %d bytes\n\r", bleLen);
 
-    DEBUG_SERIAL_PRINTF("Received data on Input Characteristic: %d bytes\n\r", bleLen);
+  // Handle bad packets
+  if (bleLen < SecureSession::IV_SIZE + SecureSession::TAG_SIZE + SecureSession::HEADER_SIZE) {
+    DEBUG_SERIAL_PRINTLN("Characteristic too short!");
+    DEBUG_SERIAL_PRINTF("Received length: %d\n\r", bleLen);
+    stateManager->setState(DROP);
+    return 0;
+  }
 
-    // Handle bad packets
-    if (bleLen < SecureSession::IV_SIZE + SecureSession::TAG_SIZE + SecureSession::HEADER_SIZE) {
-      DEBUG_SERIAL_PRINTLN("Characteristic too short!");
-      DEBUG_SERIAL_PRINTF("Received length: %d\n\r", bleLen);
-      stateManager->setState(DROP);
-      return;
-    }
+  auto* taskParams = new SharedSecretTaskParams{ &client->session, std::vector<uint8_t>(bleLen) }; // Create the parameters passed to the RTOS task
+  ble_hs_mbuf_to_flat(ctxt->om, taskParams->rawValue.data(), bleLen, nullptr);
 
-    // Queue the received packet params in the task queue (should never failed due to BLE notification semaphore blocking, failure indicates sender is forcing data)
-    int64_t elapsed = esp_timer_get_time() - t0;
-    DEBUG_SERIAL_PRINTF("Packet Queuing took %lld us\n", elapsed);
-    
-    if (xQueueSend(packetQueue, &taskParams, 0) != pdTRUE) {
-      // Queue full, drop packet or handle error
-      DEBUG_SERIAL_PRINTLN("Packet queue full! Dropping packet.");
-      stateManager->setState(DROP);
-      //delete taskParams->rawValue;
-      delete taskParams;
-    }
+  // Queue the received packet params in the client's queue (should never failed due to BLE notification semaphore blocking, failure indicates sender is forcing data)
+  int64_t elapsed = esp_timer_get_time() - t0;
+  DEBUG_SERIAL_PRINTF("Packet Queuing took %lld us\n", elapsed);
+
+  if (xQueueSend(client->writes, &taskParams, 0) != pdTRUE) {
+    // Queue full, drop packet or handle error
+    DEBUG_SERIAL_PRINTLN("Packet queue full! Dropping packet.");
+    stateManager->setState(DROP);
+    delete taskParams;
+    return 0;
   }
+  xTaskNotifyGive(packetTaskHandle);
+  return 0;
+}
+
+// Access to the response and MAC address characteristics
+int infoAccess(uint16_t connHandle, uint16_t attrHandle, struct ble_gatt_access_ctxt* ctxt, void* arg)
+{
+  if (ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR && attrHandle == macHandle) {
+    return os_mbuf_append(ctxt->om, macValue, sizeof(macValue)) == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  }
+  return 0;
+}
+
+// The toothpaste service, NimBLE keeps pointers into these tables
+static const ble_gatt_chr_def toothpasteCharacteristics[] = {
+  {
+    .uuid = &inputUuid.u,
+    .access_cb = inputAccess,
+    .arg = nullptr,
+    .descriptors = nullptr,
+    .flags = BLE_GATT_CHR_F_READ |          // Client can read
+             BLE_GATT_CHR_F_WRITE_NO_RSP |  // Client can Write without Response
+             BLE_GATT_CHR_F_NOTIFY |        // Server can async notify
+             BLE_GATT_CHR_F_INDICATE,       // Server can notify with ACK
+    .min_key_size = 0,
+    .val_handle = &inputHandle,
+  },
+  {
+    .uuid = &responseUuid.u,                // HID Ready Semaphore Characteristic
+    .access_cb = infoAccess,
+    .arg = nullptr,
+    .descriptors = nullptr,
+    .flags = BLE_GATT_CHR_F_NOTIFY,
+    .min_key_size = 0,
+    .val_handle = &responseHandle,
+  },
+  {
+    .uuid = &macUuid.u,                     // MAC address characteristic
+    .access_cb = infoAccess,
+    .arg = nullptr,
+    .descriptors = nullptr,
+    .flags = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_NOTIFY,
+    .min_key_size = 0,
+    .val_handle = &macHandle,
+  },
+  {} // End of characteristics
+};
+
+static const ble_gatt_svc_def gattServices[] = {
+  {
+    .type = BLE_GATT_SVC_TYPE_PRIMARY,
+    .uuid = &serviceUuid.u,
+    .includes = nullptr,
+    .characteristics = toothpasteCharacteristics,
+  },
+  {} // End of services
+};
+
+// The host and controller are in sync, advertising can start
+void onHostSync()
+{
+  ble_hs_util_ensure_addr(0);
+  ble_hs_id_infer_auto(0, &ownAddrType);
+  advertising.start(AdvertisingSchedule::ADV_BURST, false); // Whoever powered the device on is probably about to connect
+  startAdvertising();
+}
+
+void onHostReset(int reason)
+{
+  DEBUG_SERIAL_PRINTF("BLE host reset: %d\n", reason);
+}
+
+// Runs the NimBLE host until nimble_port_stop()
+void hostTask(void* params)
+{
+  nimble_port_run();
+  nimble_port_freertos_deinit();
 }
 
+// Arduino releases the Bluetooth controller's memory at boot unless this says it is in use
+// The Arduino BLE library used to claim it, the host is now driven directly
+extern "C" bool btInUse() { return true; }
+
 // Create the BLE Device
 void bleSetup(SecureSession* session)
 {
   
-  createPacketTask(session); // Create the persistent RTOS packet handler task
+  for (ClientContext& client : clients) {
+    client.writes = xQueueCreate(PACKET_QUEUE_LENGTH, sizeof(SharedSecretTaskParams*));
+  }
+  createPacketTask(); // Create the persistent RTOS packet handler task
   startKeyboardTask();
+  onHostLedChange(hostLedsChanged); // Tell the client when the host's lock keys change
+  onPasteProgress(pasteProgressed); // Report bulk paste progress as chunks finish
+  macroStore.begin();
+  macroSession = session;
+
+  playoutQueue = xQueueCreate(PLAYOUT_QUEUE_LENGTH, sizeof(PlayoutItem));
+  xTaskCreatePinnedToCore(playoutTask, "PlayoutWorker", 6144, nullptr, 2, nullptr, 1);
   // Get the device name and start advertising 
   String deviceName;
   session->getDeviceName(deviceName); // Get the device name from memory
-
   DEBUG_SERIAL_PRINTF("Device Name is: %s", deviceName.c_str());
-  if (deviceName.length() < 1) {
-    BLEDevice::init(BLE_DEVICE_DEFAULT_NAME);
+
+  int rc = nimble_port_init();
+  if (rc != ESP_OK) {
+    DEBUG_SERIAL_PRINTF("NimBLE init failed: %d\n", rc);
+    return;
   }
-  else {
-    BLEDevice::init(deviceName.c_str()); // If the device name isn't set, fallback to default
-  }
-
-  //BLEDevice::setPower(ESP_PWR_LVL_N3); // low power for heat
-  // Create the BLE Server
-  bluServer = BLEDevice::createServer();
-  bluServer->setCallbacks(new DeviceServerCallbacks());
-
-  // Create the BLE Service
-  BLEService* pService = bluServer->createService(SERVICE_UUID);
-
-  // Create a BLE Characteristic
-  inputCharacteristic = pService->createCharacteristic(
-    TX_TO_TOOTHPASTE_CHARACTERISTIC,
-    BLECharacteristic::PROPERTY_READ |      // Client can read
-    BLECharacteristic::PROPERTY_WRITE_NR |  // Client can Write without Response
-    BLECharacteristic::PROPERTY_NOTIFY |    // Server can async notify
-    BLECharacteristic::PROPERTY_INDICATE);  // Server can notify with ACK
-
-  // Register the callback for the input data characteristic
-  inputCharacteristic->setCallbacks(new InputCharacteristicCallbacks(session));
-
-  // Create the HID Ready Semaphore Characteristic
-  responseCharacteristic = pService->createCharacteristic(
-    RESPONSE_CHARACTERISTIC,
-    BLECharacteristic::PROPERTY_NOTIFY);
-
-  // Create a MAC address characteristic
-  macCharacteristic = pService->createCharacteristic(
-    MAC_CHARACTERISTIC_UUID,
-    BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_NOTIFY
-  );
+  ble_hs_cfg.sync_cb = onHostSync;
+  ble_hs_cfg.reset_cb = onHostReset;
 
-  // Initialize with 8 bytes (all zeros here)
-  uint64_t mac = ESP.getEfuseMac();
+  ble_svc_gap_init();
+  ble_svc_gatt_init();
+  ble_svc_gap_device_name_set(deviceName.length() < 1 ? BLE_DEVICE_DEFAULT_NAME : deviceName.c_str()); // If the device name isn't set, fallback to default
 
-  // Convert to 6-byte array
-  uint8_t initialValue[6];
+  // MAC address characteristic value
+  uint64_t mac = ESP.getEfuseMac();
   for (int i = 0; i < 6; i++) {
-    initialValue[i] = (mac >> (8 * (5 - i))) & 0xFF;
+    macValue[i] = (mac >> (8 * (5 - i))) & 0xFF;
   }
 
-  // Set the BLE characteristic value
-  macCharacteristic->setValue(initialValue, 6);
-
-  // Start the service
-  pService->start();
-
-
-  BLEAdvertising* pAdvertising = BLEDevice::getAdvertising();
+  // Register the service, the handles are filled in when the host starts
+  rc = ble_gatts_count_cfg(gattServices);
+  if (rc == 0) {
+    rc = ble_gatts_add_svcs(gattServices);
+  }
+  if (rc != 0) {
+    DEBUG_SERIAL_PRINTF("Registering the GATT service failed: %d\n", rc);
+    return;
+  }
 
-  pAdvertising->addServiceUUID(SERVICE_UUID);
-  pAdvertising->setScanResponse(true); // Advertise the SERVICE_UUID, i.e. devices don't need to connect to find services
-  pAdvertising->setMinPreferred(0x0); // set value to 0x00 to not advertise this parameter
-  BLEDevice::startAdvertising();
+  nimble_port_freertos_init(hostTask); // Advertising starts once the host syncs with the controller
 }
 
 // Use the AUTH packet and peer public key to derive a new ecdh shared secret and AES key
-void generateSharedSecret(toothpaste_DataPacket* packet, SecureSession* session)
+void generateSharedSecret(toothpaste_DataPacket* packet, ClientContext* client)
 {
+  SecureSession* session = &client->session;
+
   // Store the base64 key as a byte array
   uint8_t peerKeyArray[66];
   size_t peerKeyLen = 0;
@@ -218,9 +561,11 @@ void generateSharedSecret(toothpaste_DataPacket* packet, SecureSession* session)
   if (!session->computeSharedSecret(peerKeyArray, peerKeyLen, base64Input.c_str()))
   {
     DEBUG_SERIAL_PRINTLN("Shared secret computed and AES key derived successfully");
-    clientPubKey = std::string((const char*)base64Input.c_str(), base64Input.length());
+    client->pubKey = std::string((const char*)base64Input.c_str(), base64Input.length());
     stateManager->setState(READY);
 
+    resetSequencing(client); // A new session numbers its writes from scratch
+    sessionStarted(client);
     notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_CHALLENGE, session->sessionSalt, sizeof(session->sessionSalt));
   }
   // If the shared secret computation or key derivation fails
@@ -237,121 +582,552 @@ void generateSharedSecret(toothpaste_DataPacket* packet, SecureSession* session)
   return;
 }
 
-// Decrypt a data packet and type the text content as a string
-void decryptSendString(toothpaste_DataPacket* packet, SecureSession* session) {
-  int64_t t0 = esp_timer_get_time();
- 
-  // Average decryption time: ~ 13000us (13ms)
-  // Average decryption time: ~ 377us (0.377ms) with new SecureSession optimizations (key caching, HKDF caching, etc..)
+// Act on a decrypted packet from <client>, or from a stored macro when it is null
+// Runs on the packet, playout and macro tasks, so replies go to <client> and never to currentClient
+void dispatchPacket(toothpaste_EncryptedData& decrypted, bool slowMode, ClientContext* client) {
+  SecureSession* session = (client != nullptr) ? &client->session : macroSession;
+  switch (decrypted.which_packetData) {
+    // A keyboard text packet (string data)
+    case toothpaste_EncryptedData_keyboardPacket_tag:
+    {
+      if (decrypted.packetData.keyboardPacket.pasteId != 0) {
+        sendPaste(decrypted.packetData.keyboardPacket);
+      }
+      else {
+        sendString(decrypted.packetData.keyboardPacket.message, decrypted.packetData.keyboardPacket.length, slowMode);
+      }
+      break;
+    }
 
-  std::vector<uint8_t> decrypted_bytes((packet->dataLen) + 2);
-  toothpaste_EncryptedData decrypted = toothpaste_EncryptedData_init_default;
- 
+    case toothpaste_EncryptedData_keycodePacket_tag:
+    {
+      //std::vector<uint8_t> keycode(decrypted.packetData.keycodePacket.code.bytes, decrypted.packetData.keycodePacket.code.size);
+      sendKeycode(decrypted.packetData.keycodePacket.code.bytes, decrypted.packetData.keycodePacket.code.size, slowMode, true);
+      break;
+    }
 
-  int ret = session->decrypt(packet, decrypted_bytes.data(), clientPubKey.c_str()); // Get the serialized form of the decrypted data
+    case toothpaste_EncryptedData_chordSequencePacket_tag:
+    {
+      sendChords(decrypted.packetData.chordSequencePacket);
+      break;
+    }
 
-  int64_t elapsed = esp_timer_get_time() - t0;
+    case toothpaste_EncryptedData_mousePacket_tag:
+    {
+      //std::vector<uint8_t> mouseCode(decrypted.packetData.mousePacket);
+      moveMouse(decrypted.packetData.mousePacket);
+      break;
+    }
 
-  DEBUG_SERIAL_PRINTF("Packet Decryption took %lld us\n", elapsed);
-  DEBUG_SERIAL_PRINTF("Decrypted data length: %d\n", decrypted_bytes.size());
+    case toothpaste_EncryptedData_renamePacket_tag:
+    {
+      std::string textString(decrypted.packetData.renamePacket.message, decrypted.packetData.renamePacket.length);
+      int ret = session->setDeviceName(textString.c_str()); // Set the device name in preferences
+      DEBUG_SERIAL_PRINTF("Device rename status code: %d\n", ret);
+      DEBUG_SERIAL_PRINTLN("Rebooting Toothpaste...");
+      esp_restart();
+      break;
+    }
 
-  DEBUG_SERIAL_PRINT("Raw Data (chars): ");
-  for (size_t i = 0; i < decrypted_bytes.size(); ++i) {
-    DEBUG_SERIAL_PRINTF("%c", decrypted_bytes[i]);
+    case toothpaste_EncryptedData_consumerControlPacket_tag:
+    {
+      //std::vector<uint8_t> keycode(decrypted.packetData.keycodePacket.code.bytes, decrypted.packetData.keycodePacket.code.size);
+      consumerControlPress(decrypted.packetData.consumerControlPacket);
+      break;
+    }
+
+    case toothpaste_EncryptedData_mouseJigglePacket_tag:
+    {
+      bool enable = decrypted.packetData.mouseJigglePacket.enable;
+      if (enable) {
+        startJiggle();
+      }
+      else {
+        stopJiggle();
+      }
+      break;
+    }
+
+    case toothpaste_EncryptedData_touchpadPacket_tag:
+    {
+      touchpadFrames(decrypted.packetData.touchpadPacket);
+      break;
+    }
+
+    case toothpaste_EncryptedData_keyEventPacket_tag:
+    {
+      sendKeyEvents(decrypted.packetData.keyEventPacket);
+      break;
+    }
+
+    case toothpaste_EncryptedData_syncPacket_tag:
+    {
+      syncClient = client;
+      sendSync(decrypted.packetData.syncPacket);
+      break;
+    }
+
+    case toothpaste_EncryptedData_clockSyncPacket_tag:
+    {
+      toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
+      responsePacket.responseType = toothpaste_ResponsePacket_ResponseType_CLOCK_SYNC;
+      responsePacket.clientTime = decrypted.packetData.clockSyncPacket.clientTime;
+      responsePacket.deviceTime = esp_timer_get_time();
+      if (client != nullptr) {
+        notifyResponsePacket(responsePacket, client);
+      }
+      break;
+    }
+
+    case toothpaste_EncryptedData_compositePacket_tag:
+    {
+      sendComposite(decrypted.packetData.compositePacket);
+      break;
+    }
+
+    case toothpaste_EncryptedData_scriptPacket_tag:
+    {
+      scriptClient = client;
+      sendScript(decrypted.packetData.scriptPacket);
+      break;
+    }
+
+    case toothpaste_EncryptedData_macroPacket_tag:
+    {
+      toothpaste_MacroPacket& macro = decrypted.packetData.macroPacket;
+      bool stored = macroStore.write(macro.slot, macro.offset, macro.data.bytes, macro.data.size, macro.done);
+
+      // Report the sealed slot, or the first failure
+      if (macro.done || !stored) {
+        toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
+        responsePacket.responseType = toothpaste_ResponsePacket_ResponseType_MACRO_STATUS;
+        responsePacket.macroSlot = macro.slot;
+        responsePacket.macroStored = stored;
+        if (client != nullptr) {
+          notifyResponsePacket(responsePacket, client);
+        }
+      }
+      break;
+    }
+
+    case toothpaste_EncryptedData_runMacroPacket_tag:
+    {
+      runMacro(decrypted.packetData.runMacroPacket.slot);
+      break;
+    }
+
+    case toothpaste_EncryptedData_configPacket_tag:
+    {
+      // Only the settings the packet carries change
+      if (decrypted.packetData.configPacket.has_ackTyping) {
+        setAckTyping(decrypted.packetData.configPacket.ackTyping);
+      }
+      if (decrypted.packetData.configPacket.has_unicodeFallback) {
+        setUnicodeFallback((uint8_t)decrypted.packetData.configPacket.unicodeFallback); // Values match UNICODE_FALLBACK_*
+      }
+      if (decrypted.packetData.configPacket.has_playoutDelayMs) {
+        playoutDelayUs = std::min(decrypted.packetData.configPacket.playoutDelayMs, (uint32_t)PLAYOUT_MAX_DELAY_MS) * 1000LL;
+      }
+
+      // Switch layouts behind any queued text and remember the choice for this client
+      toothpaste_ConfigPacket_KeyboardLayout layout = decrypted.packetData.configPacket.layout;
+      if (setKeyboardLayout(layout) && client != nullptr && !client->pubKey.empty()) {
+        session->setClientLayout(client->pubKey.c_str(), (uint8_t)layout);
+      }
+      break;
+    }
+
+    case toothpaste_EncryptedData_gamepadPacket_tag:
+    {
+      if (gamepadState(decrypted.packetData.gamepadPacket) && client != nullptr) {
+        gamepadAckClient = client;
+        queueGamepadAck(decrypted.packetData.gamepadPacket.sequence);
+      }
+      break;
+    }
+
+    default:
+      DEBUG_SERIAL_PRINTF("Unknown Packet Type: %d", decrypted.which_packetData);
+      break;
   }
+}
 
-  DEBUG_SERIAL_PRINTLN("");
+// Apply a serialized EncryptedData, plain input is streamed to HID and everything else is fully decoded
+void applyEncryptedData(const uint8_t* data, size_t length, bool slowMode, ClientContext* client) {
+  if (streamEncryptedData(data, length, slowMode)) {
+    return;
+  }
 
   // Average protobuf deserialization time: ~ 150us (0.15ms)
   // Deserialize the decrypted data into a protobuf packet
-  pb_istream_t stream = pb_istream_from_buffer(decrypted_bytes.data(), decrypted_bytes.size() - 2);
+  toothpaste_EncryptedData decrypted = toothpaste_EncryptedData_init_default;
+  pb_istream_t stream = pb_istream_from_buffer(data, length);
   if (!pb_decode(&stream, toothpaste_EncryptedData_fields, &decrypted)) {
     printf("Decoding encrypted data failed: %s\n", PB_GET_ERROR(&stream));
     return;
   }
-  
+
+  if (!schedulePlayout(decrypted, slowMode, client)) {
+    dispatchPacket(decrypted, slowMode, client);
+  }
+}
+
+// Decrypt a data packet and type the text content as a string
+void decryptSendString(const DataPacketView& packet, ClientContext* client) {
+  SecureSession* session = &client->session;
+  int64_t t0 = esp_timer_get_time();
+ 
+  // Average decryption time: ~ 13000us (13ms)
+  // Average decryption time: ~ 377us (0.377ms) with new SecureSession optimizations (key caching, HKDF caching, etc..)
+
+  if (packet.iv.size != SecureSession::IV_SIZE || packet.tag.size != SecureSession::TAG_SIZE) {
+    DEBUG_SERIAL_PRINTLN("Malformed data packet");
+    stateManager->setState(DROP);
+    return;
+  }
+
+  // A sequenced write authenticates its sequence number, so a forged one can't hold a slot in the reorder window
+  uint8_t aad[4] = { (uint8_t)packet.sequence, (uint8_t)(packet.sequence >> 8), (uint8_t)(packet.sequence >> 16), (uint8_t)(packet.sequence >> 24) };
+
+  std::vector<uint8_t> decrypted_bytes(packet.encryptedData.size + 1); // decrypt() terminates the plaintext
+  int ret = session->decrypt(packet.iv.bytes, packet.encryptedData.size, packet.encryptedData.bytes, packet.tag.bytes,
+                             decrypted_bytes.data(), client->pubKey.c_str(),
+                             packet.hasSequence ? aad : nullptr, packet.hasSequence ? sizeof(aad) : 0); // Get the serialized form of the decrypted data
+
+  int64_t elapsed = esp_timer_get_time() - t0;
+
+  DEBUG_SERIAL_PRINTF("Packet Decryption took %lld us\n", elapsed);
+  DEBUG_SERIAL_PRINTF("Decrypted data length: %d\n", packet.encryptedData.size);
+
   // If the decryption succeeds type the plaintext over HID    
   if (ret == 0)
   {
     // Reset the state so that we don't blink forever in an error state
     stateManager->setState(READY);
-    switch (decrypted.which_packetData) {
-      // A keyboard text packet (string data)
-      case toothpaste_EncryptedData_keyboardPacket_tag:
-      {
-        sendString(decrypted.packetData.keyboardPacket.message, decrypted.packetData.keyboardPacket.length, packet->slowMode);
-        break;
-      }
+    if (packet.hasSequence) {
+      decrypted_bytes.resize(packet.encryptedData.size);
+      SequencedWrite write = { false, packet.slowMode, std::move(decrypted_bytes) };
+      deliverSequenced((uint16_t)packet.sequence, write, client);
+    }
+    else {
+      applyEncryptedData(decrypted_bytes.data(), packet.encryptedData.size, packet.slowMode, client);
+    }
+  }
 
-      case toothpaste_EncryptedData_keycodePacket_tag:
-      {
-        //std::vector<uint8_t> keycode(decrypted.packetData.keycodePacket.code.bytes, decrypted.packetData.keycodePacket.code.size);
-        sendKeycode(decrypted.packetData.keycodePacket.code.bytes, packet->slowMode, true);
-        break;
-      }
+  // If the decryption fails
+  else
+  {
+    DEBUG_SERIAL_PRINT("Decryption failed with error code: ");
+    DEBUG_SERIAL_PRINTLN(ret);
+    stateManager->setState(DROP);
+  }
+}
 
-      case toothpaste_EncryptedData_mousePacket_tag:
-      {
-        //std::vector<uint8_t> mouseCode(decrypted.packetData.mousePacket);
-        moveMouse(decrypted.packetData.mousePacket);
-        break;
-      }
+// Act on one record of a lean frame body, records point into the decrypted body
+void applyLeanRecord(const LeanRecord& record, bool slowMode, ClientContext* client) {
+  switch (record.type) {
+    case LEAN_RECORD_PROTOBUF:
+    {
+      applyEncryptedData(record.value, record.length, slowMode, client);
+      break;
+    }
 
-      case toothpaste_EncryptedData_renamePacket_tag:
-      {
-        std::string textString(decrypted.packetData.renamePacket.message, decrypted.packetData.renamePacket.length);
-        int ret = session->setDeviceName(textString.c_str()); // Set the device name in preferences
-        DEBUG_SERIAL_PRINTF("Device rename status code: %d\n", ret);
-        DEBUG_SERIAL_PRINTLN("Rebooting Toothpaste...");
-        esp_restart();
-        break;
+    case LEAN_RECORD_TEXT:
+    {
+      // Queue items hold 255 bytes, split between UTF-8 characters
+      size_t pos = 0;
+      while (pos < record.length) {
+        size_t end = std::min(pos + UINT8_MAX, (size_t)record.length);
+        while (end < record.length && end > pos + 1 && (record.value[end] & 0xC0) == 0x80) {
+          end--;
+        }
+        sendString((const char*)record.value + pos, end - pos, slowMode);
+        pos = end;
       }
+      break;
+    }
 
-      case toothpaste_EncryptedData_consumerControlPacket_tag:
-      {
-        //std::vector<uint8_t> keycode(decrypted.packetData.keycodePacket.code.bytes, decrypted.packetData.keycodePacket.code.size);
-        consumerControlPress(decrypted.packetData.consumerControlPacket);
-        break;
-      }
+    case LEAN_RECORD_KEYCODE:
+    {
+      sendKeycode((uint8_t*)record.value, std::min(record.length, (uint16_t)UINT8_MAX), slowMode, true);
+      break;
+    }
 
-      case toothpaste_EncryptedData_mouseJigglePacket_tag:
-      {
-        bool enable = decrypted.packetData.mouseJigglePacket.enable;
-        if (enable) {
-          startJiggle();
-        }
-        else {
-          stopJiggle();
-        }
-        break;
-      }
+    case LEAN_RECORD_KEY_EVENTS:
+    {
+      sendKeyEvents(record.value, record.length);
+      break;
+    }
 
-      default:
-        DEBUG_SERIAL_PRINTF("Unknown Packet Type: %d", decrypted.which_packetData);
+    case LEAN_RECORD_MOUSE:
+    {
+      if (record.length < LEAN_MOUSE_HEADER_SIZE) {
+        DEBUG_SERIAL_PRINTLN("Lean mouse record too short");
         break;
+      }
+      moveMouse(record.value + LEAN_MOUSE_HEADER_SIZE, record.length - LEAN_MOUSE_HEADER_SIZE,
+                record.value[0] & LEAN_MOUSE_TIMED, record.value[1], record.value[2], (int8_t)record.value[3]);
+      break;
     }
+
+    default:
+      DEBUG_SERIAL_PRINTF("Skipping unknown lean record type: %d\n", record.type);
+      break;
   }
+}
 
-  // If the decryption fails
-  else
-  {
-    DEBUG_SERIAL_PRINT("Decryption failed with error code: ");
+// Decrypt a lean frame and apply its records in order, no protobuf decode unless a record carries one
+void decryptLeanFrame(const uint8_t* data, size_t length, ClientContext* client) {
+  LeanFrame frame;
+  LeanStatus status = frame.parse(data, length);
+  if (status != LEAN_OK) {
+    DEBUG_SERIAL_PRINTF("Bad lean frame: %d\n", status);
+    stateManager->setState(DROP);
+    return;
+  }
+
+  std::vector<uint8_t> body(frame.bodyLength + 1); // decrypt() terminates the plaintext
+  int ret = client->session.decrypt(frame.iv, frame.bodyLength, frame.body, frame.tag, body.data(), client->pubKey.c_str(),
+                             frame.header, LEAN_AAD_SIZE);
+  if (ret != 0) {
+    DEBUG_SERIAL_PRINT("Lean frame decryption failed with error code: ");
     DEBUG_SERIAL_PRINTLN(ret);
     stateManager->setState(DROP);
+    return;
   }
+
+  stateManager->setState(READY);
+
+  // Frames are always sequenced, resends and replays are dropped by the reorder window
+  body.resize(frame.bodyLength);
+  SequencedWrite write = { true, (bool)(frame.flags & LEAN_FLAG_SLOW_MODE), std::move(body) };
+  deliverSequenced(frame.sequence, write, client);
+}
+
+// Apply the records of a decrypted lean frame body in order
+void applyLeanBody(const uint8_t* body, size_t length, bool slowMode, ClientContext* client) {
+  LeanRecords records(body, length);
+  LeanRecord record;
+  while (records.next(record)) {
+    applyLeanRecord(record, slowMode, client);
+  }
+  if (records.truncated()) {
+    DEBUG_SERIAL_PRINTLN("Lean frame body ends inside a record");
+  }
+}
+
+// Apply a write the reorder window released
+void applySequenced(SequencedWrite& write, ClientContext* client) {
+  if (write.plaintext.empty()) {
+    return; // A resume with nothing to type
+  }
+  if (write.lean) {
+    applyLeanBody(write.plaintext.data(), write.plaintext.size(), write.slowMode, client);
+  }
+  else {
+    applyEncryptedData(write.plaintext.data(), write.plaintext.size(), write.slowMode, client);
+  }
+}
+
+// Apply the held writes that are now in order, a gap still open behind them restarts the gap timeout
+void drainReorderWindow(ClientContext* client) {
+  SequencedWrite write;
+  bool drained = false;
+  while (client->reorderWindow.next(write)) {
+    applySequenced(write, client);
+    drained = true;
+  }
+  if (drained) {
+    client->reorderGapSince = esp_timer_get_time();
+  }
+}
+
+// Hand an authenticated sequenced write to the client's reorder window, it is applied once everything before it has been
+void deliverSequenced(uint16_t sequence, SequencedWrite& write, ClientContext* client) {
+  ReorderWindow& window = client->reorderWindow;
+  bool gapOpen = window.hasGap();
+  switch (window.offer(sequence, write)) {
+    case ReorderWindow::REORDER_DELIVER:
+      applySequenced(write, client);
+      drainReorderWindow(client);
+      break;
+
+    case ReorderWindow::REORDER_HELD:
+      DEBUG_SERIAL_PRINTF("Holding write %u until %u arrives\n", sequence, (uint16_t)(window.cumulative() + 1));
+      if (!gapOpen) {
+        client->reorderGapSince = esp_timer_get_time();
+      }
+      break;
+
+    case ReorderWindow::REORDER_DUPLICATE:
+      DEBUG_SERIAL_PRINTF("Dropping duplicate write %u\n", sequence);
+      break;
+
+    case ReorderWindow::REORDER_TOO_FAR:
+      DEBUG_SERIAL_PRINTF("Dropping write %u, beyond the reorder window\n", sequence);
+      break;
+  }
+  queueSack(client);
+}
+
+// Forget the client's sequence numbers, a new session's sequenced writes start at 0
+void resetSequencing(ClientContext* client) {
+  client->reorderWindow.reset();
+  client->reorderGapSince = 0;
+}
+
+// Put the shared HID state in order for a new session (CHALLENGE or RESUMED), nothing carries over from the one before
+// The HID device is shared, so only a client that has it to itself does this, others keep its state and pick a layout with a ConfigPacket
+void sessionStarted(ClientContext* client) {
+  if (connectedClients() > 1) {
+    return; // Another client is typing or holding gamepad input on it
+  }
+
+  resetGamepad(); // Its gamepad sequence numbers start from scratch, and no stick or button is held for it
+  notifiedHostLeds = -1; // Its CHALLENGE or RESUMED carries the lock state, the next change is news whatever was last sent
+
+  // Restore the client's keyboard layout, clients that never picked one get the default
+  uint8_t layout;
+  if (!client->session.getClientLayout(client->pubKey.c_str(), layout)) {
+    layout = toothpaste_ConfigPacket_KeyboardLayout_EN_US;
+  }
+  setKeyboardLayout((toothpaste_ConfigPacket_KeyboardLayout)layout);
+}
+
+// Timer callback that wakes the packet task to acknowledge a client's sequenced writes
+// The window belongs to the packet task, the tick only flags the client
+void sackTick(void* arg) {
+  static_cast<ClientContext*>(arg)->sackDue = true;
+  xTaskNotifyGive(packetTaskHandle);
+}
+
+// Acknowledge sequenced writes, SACKs are coalesced to one per SACK_INTERVAL_US
+void queueSack(ClientContext* client) {
+  if (client->sackTimer == nullptr) {
+    esp_timer_create_args_t timer_args = {
+      .callback = &sackTick,
+      .arg = client,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "sack"
+    };
+    esp_timer_create(&timer_args, &client->sackTimer);
+  }
+
+  if (!esp_timer_is_active(client->sackTimer)) {
+    esp_timer_start_once(client->sackTimer, SACK_INTERVAL_US);
+  }
+}
+
+// Report what the client's reorder window holds, giving up on a gap that has been open too long
+// The client resends every sequence below the highest held one that is neither acknowledged nor held
+void sendSack(ClientContext* client) {
+  ReorderWindow& window = client->reorderWindow;
+  if (window.hasGap() && esp_timer_get_time() - client->reorderGapSince >= REORDER_GAP_TIMEOUT_US) {
+    DEBUG_SERIAL_PRINTF("Giving up on writes after %u\n", window.cumulative());
+    window.skipGap();
+    drainReorderWindow(client);
+  }
+
+  toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
+  responsePacket.responseType = toothpaste_ResponsePacket_ResponseType_SACK;
+  responsePacket.ackSequence = window.cumulative();
+  responsePacket.sackBits = window.sackBits();
+  notifyResponsePacket(responsePacket, client);
+
+  // Keep reporting while writes are missing, the client may have lost the last SACK too
+  if (window.hasGap()) {
+    queueSack(client);
+  }
+}
+
+// Drop a disconnected client's queued writes and sequence numbers, the slot can then take a new client
+void resetClient(ClientContext* client) {
+  SharedSecretTaskParams* taskParams = nullptr;
+  while (xQueueReceive(client->writes, &taskParams, 0) == pdTRUE) {
+    delete taskParams;
+  }
+  if (client->sackTimer != nullptr) {
+    esp_timer_stop(client->sackTimer);
+  }
+
+  // The session can be resumed for a while, from the first write that was not applied
+  ReorderWindow& window = client->reorderWindow;
+  resumeTickets.end(client, (uint16_t)(window.cumulative() + 1), esp_timer_get_time(), RESUME_TICKET_LIFETIME_US);
+  client->session.endSession(); // The next client in this slot has to authenticate
+  client->generation++;         // Playout items still queued for this client lose it
+
+  // Don't leave keys held by a raw key event stream pressed, queued here because the release can wait behind queued typing
+  if (client->releasePending) {
+    client->releasePending = false;
+    releaseKeys();
+  }
+
+  resetSequencing(client);
+  client->pubKey.clear();
+  client->sackDue = false;
+  client->resetPending = false;
+}
+
+// Pick up a dropped session from its ticket, in place of authenticating
+// The RESUME_PACKET's write is encrypted with the session's key, decrypting it is the proof the client holds it
+// No NVS read, key derivation or CHALLENGE round trip, the write is applied straight away
+void resumeSession(const DataPacketView& packet, ClientContext* client) {
+  ResumeTicket ticket;
+  if (packet.iv.size != SecureSession::IV_SIZE || packet.tag.size != SecureSession::TAG_SIZE || !packet.hasSequence ||
+      !resumeTickets.find(packet.resumeTicket.bytes, packet.resumeTicket.size, esp_timer_get_time(), ticket)) {
+    DEBUG_SERIAL_PRINTLN("Resume refused, the client has to authenticate");
+    notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_RESUME_FAILED, nullptr, 0);
+    return;
+  }
+
+  // The ticket and sequence are the additional data, so the write can't be replayed under another ticket or sequence
+  uint8_t aad[ResumeTickets::ID_SIZE + 4];
+  memcpy(aad, ticket.id, ResumeTickets::ID_SIZE);
+  for (int i = 0; i < 4; i++) {
+    aad[ResumeTickets::ID_SIZE + i] = (uint8_t)(packet.sequence >> (8 * i));
+  }
+
+  client->session.resumeSessionKey(ticket.key);
+  memset(ticket.key, 0, sizeof(ticket.key));
+  std::vector<uint8_t> plaintext(packet.encryptedData.size + 1); // decrypt() terminates the plaintext
+  int ret = client->session.decrypt(packet.iv.bytes, packet.encryptedData.size, packet.encryptedData.bytes, packet.tag.bytes,
+                                    plaintext.data(), ticket.pubKey.c_str(), aad, sizeof(aad));
+  if (ret != 0) {
+    DEBUG_SERIAL_PRINTF("Resume write failed to decrypt: %d\n", ret);
+    client->session.endSession(); // The ticket stays, whoever sent this write didn't hold its key
+    stateManager->setState(DROP);
+    notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_RESUME_FAILED, nullptr, 0);
+    return;
+  }
+
+  // A ticket is good for one resume, the RESUMED response carries the next one
+  resumeTickets.consume(ticket.id);
+
+  // Writes applied before the drop are duplicates now, the client resends from its oldest unacknowledged one
+  client->pubKey = ticket.pubKey;
+  resetSequencing(client);
+  client->reorderWindow.resume(ticket.nextSequence);
+  sessionStarted(client);
+  stateManager->setState(READY);
+  notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_RESUMED, nullptr, 0); // Carries the ticket for the next drop
+
+  plaintext.resize(packet.encryptedData.size);
+  SequencedWrite write = { false, packet.slowMode, std::move(plaintext) };
+  deliverSequenced((uint16_t)packet.sequence, write, client);
 }
 
 // Read an AUTH packet and check if the client public key and AES key are known
-void authenticateClient(toothpaste_DataPacket* packet, SecureSession* session) {
+void authenticateClient(toothpaste_DataPacket* packet, ClientContext* client) {
   DEBUG_SERIAL_PRINTLN("Entered authenticateClient");
+  SecureSession* session = &client->session;
 
   // The packet's "encryptedData" field contains the unencrypted public key in an AUTH packet
-  clientPubKey = std::string((const char*)packet->encryptedData.bytes, packet->encryptedData.size);
-  //ESP_LOGD("clientPubKey: %s\n\r", clientPubKey.c_str());
+  client->pubKey = std::string((const char*)packet->encryptedData.bytes, packet->encryptedData.size);
+  //ESP_LOGD("clientPubKey: %s\n\r", client->pubKey.c_str());
 
 
   // If we don't know the shared secret for the given public key, set Device Status to UNPAIRED
-  if (!session->loadIfEnrolled(clientPubKey.c_str())) {
+  if (!session->loadIfEnrolled(client->pubKey.c_str())) {
     DEBUG_SERIAL_PRINTLN("Client is not enrolled");
 
     notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_PEER_UNKNOWN, nullptr, 0);
@@ -365,7 +1141,7 @@ void authenticateClient(toothpaste_DataPacket* packet, SecureSession* session) {
     DEBUG_SERIAL_PRINTLN("Client is enrolled");
 
     // Derive the session AES key from the stored shared secret
-    int ret = session->deriveAESKeyFromSecret(clientPubKey.c_str());
+    int ret = session->deriveAESKeyFromSecret(client->pubKey.c_str());
     if (ret != 0) {
       DEBUG_SERIAL_PRINTF("Failed to derive session AES key: %d\n", ret);
       notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_PEER_UNKNOWN, nullptr, 0);
@@ -374,6 +1150,8 @@ void authenticateClient(toothpaste_DataPacket* packet, SecureSession* session) {
     }
 
     // Send the session salt as a challenge to the client to agree on the AES key
+    resetSequencing(client); // A new session numbers its writes from scratch
+    sessionStarted(client);
     notifyResponsePacket(toothpaste_ResponsePacket_ResponseType_CHALLENGE, session->sessionSalt, sizeof(session->sessionSalt));
 
     stateManager->setState(READY);
@@ -382,14 +1160,9 @@ void authenticateClient(toothpaste_DataPacket* packet, SecureSession* session) {
 
 // Notify using a toothPaste.responsePacket protobuf message
 void notifyResponsePacket(toothpaste_ResponsePacket_ResponseType responseType, const uint8_t* challengeData, size_t challengeDataLen) {
-  uint8_t buffer[256];
-  pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
-  
-  // Initialize the response packet with the firmware version and response type, and copy the challenge data if provided
+  // Initialize the response packet with the response type, and copy the challenge data if provided
   toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
-  strncpy(responsePacket.firmwareVersion, FIRMWARE_VERSION, sizeof(responsePacket.firmwareVersion) - 1);
-  responsePacket.firmwareVersion[sizeof(responsePacket.firmwareVersion) - 1] = '\0';
-  
+
   // Set response type
   responsePacket.responseType = (toothpaste_ResponsePacket_ResponseType)responseType;
   
@@ -402,76 +1175,359 @@ void notifyResponsePacket(toothpaste_ResponsePacket_ResponseType responseType, c
     memcpy(responsePacket.challengeData.bytes, challengeData, copyLen);
     responsePacket.challengeData.size = copyLen;
   }
-  
+
+  notifyResponsePacket(responsePacket);
+}
+
+// Describe what this receiver supports, for the client to pick its protocol features
+void fillCapabilities(ClientContext* client, toothpaste_Capabilities& capabilities) {
+  uint16_t mtu = ble_att_mtu(client->connHandle);
+  capabilities.maxWriteSize = mtu > BLE_ATT_HEADER_SIZE ? std::min(mtu - BLE_ATT_HEADER_SIZE, BLE_MAX_WRITE_SIZE) : 0;
+  capabilities.queueCredits = uxQueueSpacesAvailable(client->writes);
+  capabilities.wireFormats = CAPABILITY_WIRE_PROTOBUF | CAPABILITY_WIRE_LEAN;
+  capabilities.compression = CAPABILITY_COMPRESSION_LZ;
+  capabilities.nkro = false; // Boot protocol keyboard
+  capabilities.absolutePointer = TOOTHPASTE_TOUCHPAD_ENABLED;
+  capabilities.keyReportIntervalUs = KEYBOARD_POLL_INTERVAL_MS * 1000;
+  capabilities.slowModeDelayMs = SLOWMODE_DELAY_MS;
+  capabilities.macroSlots = MacroStore::SLOT_COUNT;
+  capabilities.macroSlotSize = MacroStore::MAX_LENGTH;
+  capabilities.features = CAPABILITY_SCRIPT | CAPABILITY_COMPOSITE | CAPABILITY_PACKED_MOUSE | CAPABILITY_PLAYOUT |
+                          CAPABILITY_SYNC | CAPABILITY_CHORDS | CAPABILITY_KEY_EVENTS | CAPABILITY_MACROS |
+                          CAPABILITY_PASTE_RESUME | CAPABILITY_SACK | CAPABILITY_RESUME;
+#if TOOTHPASTE_GAMEPAD_ENABLED
+  capabilities.features |= CAPABILITY_GAMEPAD;
+#endif
+}
+
+// Give <client>'s session a fresh resumption ticket, replacing the one it held
+void issueResumeTicket(ClientContext* client, toothpaste_ResponsePacket& responsePacket) {
+  uint8_t key[ResumeTickets::KEY_SIZE];
+  if (!client->session.exportSessionKey(key)) {
+    return;
+  }
+
+  uint8_t id[ResumeTickets::ID_SIZE];
+  esp_fill_random(id, sizeof(id));
+  resumeTickets.issue(client, id, key, client->pubKey);
+  memset(key, 0, sizeof(key));
+
+  memcpy(responsePacket.resumeTicket.bytes, id, sizeof(id));
+  responsePacket.resumeTicket.size = sizeof(id);
+}
+
+// Notify a filled in response packet to the client the packet task is serving
+void notifyResponsePacket(toothpaste_ResponsePacket& responsePacket) {
+  if (currentClient != nullptr) {
+    notifyResponsePacket(responsePacket, currentClient);
+  }
+}
+
+// Stamp the firmware version on a filled in response packet and notify it to <client>
+void notifyResponsePacket(toothpaste_ResponsePacket& responsePacket, ClientContext* client) {
+  uint8_t buffer[toothpaste_ResponsePacket_size];
+  pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+
+  strncpy(responsePacket.firmwareVersion, FIRMWARE_VERSION, sizeof(responsePacket.firmwareVersion) - 1);
+  responsePacket.firmwareVersion[sizeof(responsePacket.firmwareVersion) - 1] = '\0';
+  responsePacket.hostLeds = hostLeds(); // Every response carries the lock state so the client can type the right case
+  pasteProgress(responsePacket.pasteId, responsePacket.pasteOffset); // And the bulk paste position, so a reconnecting client can resume
+
+  // The challenge starts a session, tell the client what it can use
+  if (responsePacket.responseType == toothpaste_ResponsePacket_ResponseType_CHALLENGE) {
+    responsePacket.has_capabilities = true;
+    fillCapabilities(client, responsePacket.capabilities);
+  }
+
+  // A started or resumed session gets a ticket to resume it after a drop
+  if (responsePacket.responseType == toothpaste_ResponsePacket_ResponseType_CHALLENGE ||
+      responsePacket.responseType == toothpaste_ResponsePacket_ResponseType_RESUMED) {
+    issueResumeTicket(client, responsePacket);
+  }
+
   if (!pb_encode(&stream, toothpaste_ResponsePacket_fields, &responsePacket)) {
     printf("Encoding response packet failed: %s\n", PB_GET_ERROR(&stream));
     return;
   }
   
   // Send the encoded buffer to the client
-  responseCharacteristic->setValue(buffer, stream.bytes_written);  // Set the data to be notified
-  responseCharacteristic->notify();                      // Notify the semaphor characteristic
+  if (!client->connected) {
+    return;
+  }
+  struct os_mbuf* om = ble_hs_mbuf_from_flat(buffer, stream.bytes_written);
+  if (om == nullptr || ble_gatts_notify_custom(client->connHandle, responseHandle, om) != 0) { // Frees <om> either way
+    DEBUG_SERIAL_PRINTLN("Response notification failed");
+  }
 }
 
-// Persistent RTOS that waits for packets
-void packetTask(void* params)
-{
+// Notify a response about the shared HID device to every connected client
+void notifyAllClients(toothpaste_ResponsePacket& responsePacket) {
+  for (ClientContext& client : clients) {
+    if (client.connected) {
+      notifyResponsePacket(responsePacket, &client);
+    }
+  }
+}
+
+// Timer callback that acknowledges the latest applied gamepad state
+void sendGamepadAck(void* arg) {
+  toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
+  responsePacket.responseType = toothpaste_ResponsePacket_ResponseType_GAMEPAD_ACK;
+  responsePacket.ackSequence = gamepadAckSequence;
+  ClientContext* client = gamepadAckClient;
+  if (client != nullptr) {
+    notifyResponsePacket(responsePacket, client);
+  }
+}
+
+// Acknowledge an applied gamepad state, acks are coalesced to one per GAMEPAD_ACK_INTERVAL_US
+// The client diffs its next packet against the acknowledged state
+void queueGamepadAck(uint32_t sequence) {
+  gamepadAckSequence = sequence;
+
+  if (gamepadAckTimer == nullptr) {
+    esp_timer_create_args_t timer_args = {
+      .callback = &sendGamepadAck,
+      .arg = nullptr,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "gamepadAck"
+    };
+    esp_timer_create(&timer_args, &gamepadAckTimer);
+  }
+
+  if (!esp_timer_is_active(gamepadAckTimer)) {
+    esp_timer_start_once(gamepadAckTimer, GAMEPAD_ACK_INTERVAL_US);
+  }
+}
+
+// Timer callback that reports the settled host lock state
+void sendHostState(void* arg) {
+  uint8_t leds = hostLeds() & HOST_STATE_LED_MASK;
+  if (leds == notifiedHostLeds) {
+    return;
+  }
+  notifiedHostLeds = leds;
+
+  toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
+  responsePacket.responseType = toothpaste_ResponsePacket_ResponseType_HOST_STATE;
+  notifyAllClients(responsePacket);
+}
+
+// Report how far the current bulk paste got (called from the keyboard task after each chunk)
+// notifyResponsePacket stamps the paste id and offset, every client sees it since they share the host
+void pasteProgressed(uint32_t id, uint32_t offset) {
+  toothpaste_ResponsePacket responsePacket = toothpaste_ResponsePacket_init_default;
+  responsePacket.responseType = toothpaste_ResponsePacket_ResponseType_PASTE_PROGRESS;
+  notifyAllClients(responsePacket);
+}
+
+// Host LED callback, runs in the USB task so the notification is deferred to a timer
+void hostLedsChanged(uint8_t leds) {
+  if (hostStateTimer == nullptr) {
+    esp_timer_create_args_t timer_args = {
+      .callback = &sendHostState,
+      .arg = nullptr,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "hostState"
+    };
+    esp_timer_create(&timer_args, &hostStateTimer);
+  }
+
+  if (!esp_timer_is_active(hostStateTimer)) {
+    esp_timer_start_once(hostStateTimer, HOST_STATE_NOTIFY_DELAY_US);
+  }
+}
+
+// Hold a timestamped packet in the playout buffer, false if it should be applied right away
+// Packets are due <playoutDelayUs> after their capture time, a late packet plays as soon as it reaches the front
+bool schedulePlayout(toothpaste_EncryptedData& decrypted, bool slowMode, ClientContext* client) {
+  int64_t delay = playoutDelayUs;
+  if (delay == 0 || decrypted.timestamp == 0 || playoutQueue == nullptr) {
+    return false;
+  }
+
+  // A timestamp far outside the window means the client's clock offset is stale, play it now
+  int64_t now = esp_timer_get_time();
+  int64_t due = (int64_t)decrypted.timestamp + delay;
+  if (due > now + 2 * delay || due < now - PLAYOUT_MAX_LATE_US) {
+    return false;
+  }
+
+  static PlayoutItem item; // Only the packet task schedules, keep the copy off its stack
+  item.due = due;
+  item.slowMode = slowMode;
+  item.client = client;
+  item.generation = (client != nullptr) ? client->generation : 0;
+  item.packet = decrypted;
+  if (xQueueSend(playoutQueue, &item, 0) != pdTRUE) {
+    DEBUG_SERIAL_PRINTLN("Playout buffer full, applying packet now");
+    return false;
+  }
+  return true;
+}
 
-  // Share the same securesession for the whole task
-  SecureSession* session = static_cast<SecureSession*>(params);
+// RTOS task that applies buffered packets when they fall due
+void playoutTask(void* params) {
+  static PlayoutItem item;
   while (true) {
-    SharedSecretTaskParams* taskParams = nullptr; // The queue fills in this pointer as packets become available
-
-    // Wait indefinitely for next packet pointer
-    if (xQueueReceive(packetQueue, &taskParams, portMAX_DELAY) == pdTRUE) {
-      if (taskParams) {
-        DEBUG_SERIAL_PRINTF("Time entering packet decode: %lld us\n", esp_timer_get_time());
-        // Decode protobuf
-        toothpaste_DataPacket toothPacket = toothpaste_DataPacket_init_default;
-        pb_istream_t istream = pb_istream_from_buffer(taskParams->rawValue.data(), taskParams->rawValue.size());
-        if (!pb_decode(&istream, toothpaste_DataPacket_fields, &toothPacket)) {
-          printf("Decoding toothPacket failed: %s\n", PB_GET_ERROR(&istream));
-        }
+    if (xQueueReceive(playoutQueue, &item, portMAX_DELAY) == pdTRUE) {
+      sleepUntil(item.due, playoutTimer);
 
-        //delete rawValue; // Free string memory
-
-        // Debug prints...
-        DEBUG_SERIAL_PRINTLN("BLE Data Received.");
-        DEBUG_SERIAL_PRINTF("Data length: %ld\r\n", toothPacket.dataLen);
-        DEBUG_SERIAL_PRINTF("ID: %d\r\nSlowMode: %d\r\nPacket Number: %ld\r\nTotal Packets: %ld\r\n",
-          toothPacket.packetID,
-          toothPacket.slowMode,
-          toothPacket.packetNumber,
-          toothPacket.totalPackets
-        );
-        DEBUG_SERIAL_PRINTLN();
-
-        // Print raw data as characters (not useful for encrypted data but good for debugging using unencrypted packets)
-        DEBUG_SERIAL_PRINT("Raw Data (chars): ");
-        for (size_t i = 0; i < toothPacket.dataLen; ++i) {
-          DEBUG_SERIAL_PRINTF("%c", toothPacket.encryptedData.bytes[i]);
-        }
-        DEBUG_SERIAL_PRINTLN("");
+      // Input from a client that has since left is still played, its replies have nowhere to go
+      ClientContext* client = item.client;
+      if (client != nullptr && (!client->connected || client->generation != item.generation)) {
+        client = nullptr;
+      }
+      dispatchPacket(item.packet, item.slowMode, client);
+    }
+  }
+}
 
+// Play one macro record: honour its delay once earlier records are typed, then act on it like a client packet
+void playMacroRecord(uint16_t delayMs, const uint8_t* record, size_t length, void* arg) {
+  if (delayMs > 0) {
+    while (!keyboardIdle()) {
+      vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    vTaskDelay(pdMS_TO_TICKS(delayMs));
+  }
 
-        // Handle different types of packets
-        if (toothPacket.packetID == toothpaste_DataPacket_PacketID_DATA_PACKET) {
-          decryptSendString(&toothPacket, session);
-        }
-        else if (toothPacket.packetID == toothpaste_DataPacket_PacketID_AUTH_PACKET) {
-          if (stateManager->getState() == PAIRING) {
-            generateSharedSecret(&toothPacket, session);
-          }
-          else {
-            authenticateClient(&toothPacket, session);
-          }
+  if (streamEncryptedData(record, length, *(bool*)arg)) {
+    return;
+  }
+
+  toothpaste_EncryptedData decrypted = toothpaste_EncryptedData_init_default;
+  pb_istream_t istream = pb_istream_from_buffer(record, length);
+  if (!pb_decode(&istream, toothpaste_EncryptedData_fields, &decrypted)) {
+    DEBUG_SERIAL_PRINTF("Decoding macro record failed: %s\n", PB_GET_ERROR(&istream));
+    return;
+  }
+
+  // Macros can't rewrite or start macros
+  if (decrypted.which_packetData == toothpaste_EncryptedData_macroPacket_tag ||
+      decrypted.which_packetData == toothpaste_EncryptedData_runMacroPacket_tag) {
+    return;
+  }
+  dispatchPacket(decrypted, *(bool*)arg, nullptr);
+}
+
+// RTOS task that plays a single macro slot and exits
+void macroTask(void* params) {
+  uint32_t slot = (uint32_t)(uintptr_t)params;
+  bool slowMode = false;
+
+  if (!macroStore.play(slot, playMacroRecord, &slowMode)) {
+    DEBUG_SERIAL_PRINTF("Macro slot %lu not played\n", slot);
+  }
+  macroRunning = false;
+  vTaskDelete(nullptr);
+}
+
+// Play a stored macro in the background, ignored while another macro is playing
+bool runMacro(uint32_t slot) {
+  if (macroRunning || !macroStore.isStored(slot)) {
+    return false;
+  }
+
+  macroRunning = true;
+  if (xTaskCreatePinnedToCore(macroTask, "MacroPlayer", 6144, (void*)(uintptr_t)slot, 1, nullptr, 1) != pdPASS) {
+    macroRunning = false;
+    return false;
+  }
+  return true;
+}
+
+// Decode and act on one write from <client>
+void handleWrite(SharedSecretTaskParams* taskParams, ClientContext* client)
+{
+  DEBUG_SERIAL_PRINTF("Time entering packet decode: %lld us\n", esp_timer_get_time());
+
+  // Lean frames skip the DataPacket and EncryptedData decodes
+  if (LeanFrame::detect(taskParams->rawValue.data(), taskParams->rawValue.size())) {
+    decryptLeanFrame(taskParams->rawValue.data(), taskParams->rawValue.size(), client);
+    return;
+  }
+
+  // Read the header fields in place, data packets are decrypted straight from the received buffer
+  DataPacketView view;
+  if (!scanDataPacket(taskParams->rawValue.data(), taskParams->rawValue.size(), view)) {
+    DEBUG_SERIAL_PRINTLN("Malformed data packet");
+    stateManager->setState(DROP);
+    return; // The view may hold a packet ID with fields missing
+  }
+
+  // Debug prints...
+  DEBUG_SERIAL_PRINTLN("BLE Data Received.");
+  DEBUG_SERIAL_PRINTF("Data length: %d\r\n", view.encryptedData.size);
+  DEBUG_SERIAL_PRINTF("ID: %d\r\nSlowMode: %d\r\n", view.packetID, view.slowMode);
+  DEBUG_SERIAL_PRINTLN();
+
+  // Handle different types of packets
+  if (view.packetID == toothpaste_DataPacket_PacketID_DATA_PACKET) {
+    decryptSendString(view, client);
+  }
+  else if (view.packetID == toothpaste_DataPacket_PacketID_AUTH_PACKET) {
+    // Pairing and authentication are rare, they keep the full struct
+    toothpaste_DataPacket toothPacket = toothpaste_DataPacket_init_default;
+    pb_istream_t istream = pb_istream_from_buffer(taskParams->rawValue.data(), taskParams->rawValue.size());
+    if (!pb_decode(&istream, toothpaste_DataPacket_fields, &toothPacket)) {
+      printf("Decoding toothPacket failed: %s\n", PB_GET_ERROR(&istream));
+    }
+
+    if (stateManager->getState() == PAIRING) {
+      generateSharedSecret(&toothPacket, client);
+    }
+    else {
+      authenticateClient(&toothPacket, client);
+    }
+  }
+  else if (view.packetID == toothpaste_DataPacket_PacketID_RESUME_PACKET) {
+    resumeSession(view, client);
+  }
+
+  DEBUG_SERIAL_PRINTF("Time exiting packet decode: %lld us\n", esp_timer_get_time());
+}
+
+// Persistent RTOS task that applies every client's writes
+// Clients are served round robin, BLE_CLIENT_BURST writes at a time, so their HID output interleaves at write boundaries
+void packetTask(void* params)
+{
+  size_t first = 0; // Client served first in the next round, rotated so nobody always goes first
+  while (true) {
+    // Wait indefinitely for a write, SACK tick or disconnect
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    bool pending = true;
+    while (pending) {
+      pending = false;
+
+      // Disconnects first, a client resuming on a new connection needs the ticket of the one it lost
+      for (ClientContext& client : clients) {
+        if (client.resetPending) {
+          resetClient(&client);
         }
+      }
 
-        DEBUG_SERIAL_PRINTF("Time exiting packet decode: %lld us\n", esp_timer_get_time());
+      for (size_t i = 0; i < BLE_MAX_CLIENTS; i++) {
+        ClientContext* client = &clients[(first + i) % BLE_MAX_CLIENTS];
+        if (!client->connected) {
+          continue;
+        }
 
+        currentClient = client;
+        if (client->sackDue) {
+          client->sackDue = false;
+          sendSack(client);
+        }
 
-        delete taskParams; // Free the parameter struct
+        SharedSecretTaskParams* taskParams = nullptr; // The queue fills in this pointer as packets become available
+        for (int burst = 0; burst < BLE_CLIENT_BURST && xQueueReceive(client->writes, &taskParams, 0) == pdTRUE; burst++) {
+          handleWrite(taskParams, client);
+          delete taskParams; // Free the parameter struct
+          pending = true;
+        }
       }
+      first = (first + 1) % BLE_MAX_CLIENTS;
     }
   }
-}
\ No newline at end of file
+}
@@ -1,13 +1,18 @@
 #ifndef BLE_H
 #define BLE_H
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEUtils.h>
-#include <BLE2902.h>
+#include <string>
+#include <vector>
 
 #include "SerialDebug.h"
 #include "espHID.h"
 #include "secureSession.h"
+#include "MacroStore.h"
+#include "LeanFrame.h"
+#include "packetStream.h"
+#include "ReorderWindow.h"
+#include "AdvertisingSchedule.h"
+#include "ResumeTickets.h"
 #include "toothpacket.pb.h"
 
 #define FIRMWARE_VERSION "0.9.0"
@@ -19,6 +24,59 @@
 #define RESPONSE_CHARACTERISTIC "6856e119-2c7b-455a-bf42-cf7ddd2c5908"
 #define MAC_CHARACTERISTIC_UUID "19b10002-e8f2-537e-4f6c-d104768a1214"
 
+#define GAMEPAD_ACK_INTERVAL_US 20000 // Gamepad states are acknowledged at most this often
+#define HOST_STATE_NOTIFY_DELAY_US 50000 // Lock key changes are reported once they settle
+#define HOST_STATE_LED_MASK 0x03 // Num lock and caps lock (scroll lock is used for typing probes)
+
+#define SACK_INTERVAL_US 20000 // Sequenced writes are acknowledged at most this often, and this often while a gap is open
+#define REORDER_GAP_TIMEOUT_US 300000 // Writes missing this long are given up on and the held ones applied
+#define RESUME_TICKET_LIFETIME_US 30000000 // A dropped session can be resumed this long after the device notices the drop
+
+#define PLAYOUT_MAX_DELAY_MS 250 // Longest playout delay a client can configure
+#define PLAYOUT_MAX_LATE_US 1000000 // Packets this far past due mean the clock offset is stale
+#define PLAYOUT_QUEUE_LENGTH 16 // Packets held in the playout buffer
+
+// Connection parameters, intervals in 1.25 ms units and supervision timeouts in 10 ms units
+// The link runs fast while input arrives and relaxes once it has been idle for LINK_IDLE_TIMEOUT_US
+#define LINK_ACTIVE_INTERVAL_MIN 6    // 7.5 ms, the shortest the spec allows
+#define LINK_ACTIVE_INTERVAL_MAX 12   // 15 ms
+#define LINK_ACTIVE_LATENCY 0
+#define LINK_IDLE_INTERVAL_MIN 48     // 60 ms
+#define LINK_IDLE_INTERVAL_MAX 80     // 100 ms
+#define LINK_IDLE_LATENCY 4           // Connection events the device may skip while it has nothing to send
+#define LINK_SUPERVISION_TIMEOUT 500  // 5 s, must exceed (1 + latency) * interval * 2
+#define LINK_IDLE_TIMEOUT_US 10000000 // 10 s without input relaxes the link
+#define LINK_DATA_LENGTH 251          // Largest LL PDU payload (Data Length Extension)
+#define LINK_DATA_TIME 2120           // us to send that PDU on the 1M PHY
+
+#define PACKET_QUEUE_LENGTH 50 // Writes waiting for the packet task, per client
+
+// Centrals served at once, each with its own session, write queue and sequence numbers
+// Must not exceed CONFIG_BT_NIMBLE_MAX_CONNECTIONS, advertising stops while every slot is taken
+#define BLE_MAX_CLIENTS 2
+// Writes the packet task applies from one client before moving to the next, 1 alternates strictly
+// Larger bursts cost the other clients latency but keep a long paste from being cut into small pieces
+#define BLE_CLIENT_BURST 1
+#define BLE_MAX_WRITE_SIZE 512 // Longest attribute value, caps the write size whatever the MTU
+#define BLE_ATT_HEADER_SIZE 3  // Opcode and handle, the rest of the MTU is payload
+
+// toothpaste.Capabilities bit fields
+#define CAPABILITY_WIRE_PROTOBUF  (1 << 0)
+#define CAPABILITY_WIRE_LEAN      (1 << 1)
+#define CAPABILITY_COMPRESSION_LZ (1 << 0)
+#define CAPABILITY_SCRIPT         (1 << 0)
+#define CAPABILITY_COMPOSITE      (1 << 1)
+#define CAPABILITY_PACKED_MOUSE   (1 << 2)
+#define CAPABILITY_PLAYOUT        (1 << 3)
+#define CAPABILITY_SYNC           (1 << 4)
+#define CAPABILITY_CHORDS         (1 << 5)
+#define CAPABILITY_KEY_EVENTS     (1 << 6)
+#define CAPABILITY_GAMEPAD        (1 << 7)
+#define CAPABILITY_MACROS         (1 << 8)
+#define CAPABILITY_PASTE_RESUME   (1 << 9)
+#define CAPABILITY_SACK           (1 << 10)
+#define CAPABILITY_RESUME         (1 << 11)
+
 enum NotificationType : uint8_t {
     KEEPALIVE,
     RECV_READY,
@@ -35,35 +93,53 @@ struct NotificationPacket {
     AuthStatus authStatus; // [0] = Failed, [1] = Succeeded
 };
 
+// One connected central, slots are reused once the packet task has reset them
+struct ClientContext {
+      volatile bool connected = false;
+      uint16_t connHandle = 0;
+      SecureSession session;                      // AES key agreed with this client
+      std::string pubKey;                         // Base64 public key from the client's AUTH packet
+      QueueHandle_t writes = nullptr;             // Writes waiting for the packet task
+      ReorderWindow reorderWindow;                // Sequenced writes and lean frames, only touched by the packet task
+      int64_t reorderGapSince = 0;                // When the oldest open gap in the window opened
+      volatile bool resetPending = false;         // Set on disconnect, the packet task drops the client's state
+      volatile bool releasePending = false;       // Set on disconnect when no client is left, the packet task releases the held keys
+      volatile bool sackDue = false;              // Set by the SACK timer, the packet task sends it
+      esp_timer_handle_t sackTimer = nullptr;     // Coalesces SACK notifications
+      volatile bool linkFast = false;             // The short connection interval was requested
+      volatile int64_t lastInputTime = 0;         // Last write on the input characteristic
+      esp_timer_handle_t linkIdleTimer = nullptr; // Relaxes the link once input stops
+      volatile uint32_t generation = 0;           // Bumped when the slot is reset, tells a later client apart from this one
+};
+
 struct SharedSecretTaskParams {
       SecureSession* session;
       std::vector<uint8_t> rawValue;
       const char* base64pubKey;
 };
 
-
-class DeviceServerCallbacks : public BLEServerCallbacks{
-    public:
-        void onConnect(BLEServer *bluServer);
-        void onDisconnect(BLEServer * bluServer);
-};
-
-class InputCharacteristicCallbacks : public BLECharacteristicCallbacks{
-    public:
-        InputCharacteristicCallbacks(SecureSession *session);
-        void onWrite(BLECharacteristic *inputCharacteristic);
-
-    private:
-        SecureSession *session;
-};
-
 void bleSetup(SecureSession* session);
-void generateSharedSecret(toothpaste_DataPacket* packet, SecureSession* session);
+void startAdvertising();
+void generateSharedSecret(toothpaste_DataPacket* packet, ClientContext* client);
 void disconnect();
 void enablePairingMode();
-void packetTask(void *sessionParams);
 void packetTask(void* params);
 void notifyResponsePacket(toothpaste_ResponsePacket_ResponseType responseType, const uint8_t* challengeData, size_t challengeDataLen);
-
+void notifyResponsePacket(toothpaste_ResponsePacket& responsePacket);
+void notifyResponsePacket(toothpaste_ResponsePacket& responsePacket, ClientContext* client);
+void notifyAllClients(toothpaste_ResponsePacket& responsePacket);
+void queueGamepadAck(uint32_t sequence);
+void hostLedsChanged(uint8_t leds);
+void pasteProgressed(uint32_t id, uint32_t offset);
+void dispatchPacket(toothpaste_EncryptedData& decrypted, bool slowMode, ClientContext* client);
+bool runMacro(uint32_t slot);
+bool schedulePlayout(toothpaste_EncryptedData& decrypted, bool slowMode, ClientContext* client);
+void applyEncryptedData(const uint8_t* data, size_t length, bool slowMode, ClientContext* client);
+void decryptLeanFrame(const uint8_t* data, size_t length, ClientContext* client);
+void deliverSequenced(uint16_t sequence, SequencedWrite& write, ClientContext* client);
+void resetSequencing(ClientContext* client);
+void sessionStarted(ClientContext* client);
+void queueSack(ClientContext* client);
+void linkActive(ClientContext* client);
 
 #endif // BLE_H
\ No newline at end of file
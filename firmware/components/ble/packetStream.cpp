@@ -0,0 +1,233 @@
+#include <algorithm>
+
+#include "packetStream.h"
+#include "espHID.h"
+
+#include "pb_decode.h"
+
+// One field of a message, <bytes> is set for length delimited fields and <number> for the rest
+typedef struct {
+  uint32_t tag;
+  uint64_t number;
+  ByteView bytes;
+} FieldView;
+
+typedef bool (*FieldVisitor)(const FieldView& field, void* arg);
+
+// Call <visit> for every field of the message in <data>, in wire order
+static bool walkFields(const uint8_t* data, size_t length, FieldVisitor visit, void* arg) {
+  pb_istream_t stream = pb_istream_from_buffer(data, length);
+  const uint8_t* end = data + length;
+
+  while (stream.bytes_left > 0) {
+    pb_wire_type_t wireType;
+    bool eof;
+    FieldView field = {};
+    if (!pb_decode_tag(&stream, &wireType, &field.tag, &eof)) {
+      return eof;
+    }
+
+    switch (wireType) {
+      case PB_WT_VARINT:
+        if (!pb_decode_varint(&stream, &field.number)) {
+          return false;
+        }
+        break;
+
+      case PB_WT_STRING:
+      {
+        uint32_t size;
+        if (!pb_decode_varint32(&stream, &size) || size > stream.bytes_left) {
+          return false;
+        }
+        field.bytes.bytes = end - stream.bytes_left;
+        field.bytes.size = size;
+        if (!pb_read(&stream, nullptr, size)) { // Skips, the value stays where it is
+          return false;
+        }
+        break;
+      }
+
+      default:
+        if (!pb_skip_field(&stream, wireType)) {
+          return false;
+        }
+        continue;
+    }
+
+    if (!visit(field, arg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool visitDataPacket(const FieldView& field, void* arg) {
+  DataPacketView& view = *(DataPacketView*)arg;
+  switch (field.tag) {
+    case toothpaste_DataPacket_packetID_tag:      view.packetID = (toothpaste_DataPacket_PacketID)field.number; break;
+    case toothpaste_DataPacket_slowMode_tag:      view.slowMode = field.number != 0; break;
+    case toothpaste_DataPacket_iv_tag:            view.iv = field.bytes; break;
+    case toothpaste_DataPacket_encryptedData_tag: view.encryptedData = field.bytes; break;
+    case toothpaste_DataPacket_tag_tag:           view.tag = field.bytes; break;
+    case toothpaste_DataPacket_sequence_tag:      view.hasSequence = true; view.sequence = (uint32_t)field.number; break;
+    case toothpaste_DataPacket_resumeTicket_tag:  view.resumeTicket = field.bytes; break;
+    default: break; // packetNumber, totalPackets and dataLen aren't needed, dataLen is the size of encryptedData
+  }
+  return true;
+}
+
+bool scanDataPacket(const uint8_t* data, size_t length, DataPacketView& view) {
+  view = {};
+  return walkFields(data, length, visitDataPacket, &view);
+}
+
+// The oneof member of an EncryptedData and whether it is timestamped
+typedef struct {
+  uint32_t tag;
+  ByteView payload;
+  bool timestamped;
+} EncryptedDataView;
+
+static bool visitEncryptedData(const FieldView& field, void* arg) {
+  EncryptedDataView& view = *(EncryptedDataView*)arg;
+  if (field.tag == toothpaste_EncryptedData_timestamp_tag) {
+    view.timestamped = field.number != 0;
+  }
+  else if (field.tag != toothpaste_EncryptedData_packetType_tag) {
+    view.tag = field.tag; // The last oneof member on the wire wins, as with pb_decode
+    view.payload = field.bytes;
+  }
+  return true;
+}
+
+typedef struct {
+  ByteView message;
+  uint32_t length;
+  uint32_t pasteId;
+} KeyboardView;
+
+static bool visitKeyboard(const FieldView& field, void* arg) {
+  KeyboardView& view = *(KeyboardView*)arg;
+  switch (field.tag) {
+    case toothpaste_KeyboardPacket_message_tag: view.message = field.bytes; break;
+    case toothpaste_KeyboardPacket_length_tag:  view.length = field.number; break;
+    case toothpaste_KeyboardPacket_pasteId_tag: view.pasteId = field.number; break;
+    default: break;
+  }
+  return true;
+}
+
+// A single bytes field, for the packets that are nothing else
+typedef struct {
+  uint32_t tag;
+  ByteView bytes;
+} BytesView;
+
+static bool visitBytes(const FieldView& field, void* arg) {
+  BytesView& view = *(BytesView*)arg;
+  if (field.tag == view.tag) {
+    view.bytes = field.bytes;
+  }
+  return true;
+}
+
+typedef struct {
+  int32_t lClick;
+  int32_t rClick;
+  int32_t wheel;
+  bool timed;
+  ByteView packedFrames;
+  bool framesMoved;
+} MouseView;
+
+static bool visitMouseScalars(const FieldView& field, void* arg) {
+  MouseView& view = *(MouseView*)arg;
+  switch (field.tag) {
+    case toothpaste_MousePacket_l_click_tag:      view.lClick = (int32_t)field.number; break;
+    case toothpaste_MousePacket_r_click_tag:      view.rClick = (int32_t)field.number; break;
+    case toothpaste_MousePacket_wheel_tag:        view.wheel = (int32_t)field.number; break;
+    case toothpaste_MousePacket_timedFrames_tag:  view.timed = field.number != 0; break;
+    case toothpaste_MousePacket_packedFrames_tag: view.packedFrames = field.bytes; break;
+    default: break;
+  }
+  return true;
+}
+
+// Move for each Frame as it is read, nothing is buffered however many frames the packet holds
+static bool visitMouseFrames(const FieldView& field, void* arg) {
+  if (field.tag != toothpaste_MousePacket_frames_tag) {
+    return true;
+  }
+
+  toothpaste_Frame frame = toothpaste_Frame_init_default;
+  pb_istream_t stream = pb_istream_from_buffer(field.bytes.bytes, field.bytes.size);
+  if (!pb_decode(&stream, toothpaste_Frame_fields, &frame)) {
+    return false;
+  }
+  moveMouse(frame.x, frame.y, 0, 0, 0);
+  return true;
+}
+
+static bool streamMouse(const ByteView& payload) {
+  MouseView view = {};
+  if (!walkFields(payload.bytes, payload.size, visitMouseScalars, &view)) {
+    return false;
+  }
+
+  if (view.packedFrames.size > 0) {
+    moveMouse(view.packedFrames.bytes, view.packedFrames.size, view.timed, view.lClick, view.rClick, view.wheel);
+    return true;
+  }
+
+  // Frames already moved stay moved if a later one is malformed, the clicks still follow
+  walkFields(payload.bytes, payload.size, visitMouseFrames, nullptr);
+  moveMouse(0, 0, view.lClick, view.rClick, view.wheel);
+  return true;
+}
+
+bool streamEncryptedData(const uint8_t* data, size_t length, bool slowMode) {
+  EncryptedDataView packet = {};
+  if (!walkFields(data, length, visitEncryptedData, &packet) || packet.timestamped) {
+    return false;
+  }
+
+  switch (packet.tag) {
+    case toothpaste_EncryptedData_keyboardPacket_tag:
+    {
+      KeyboardView view = {};
+      if (!walkFields(packet.payload.bytes, packet.payload.size, visitKeyboard, &view) || view.pasteId != 0) {
+        return false;
+      }
+      size_t size = std::min(view.message.size, (size_t)view.length);
+      sendString((const char*)view.message.bytes, std::min(size, (size_t)UINT8_MAX), slowMode);
+      return true;
+    }
+
+    case toothpaste_EncryptedData_keycodePacket_tag:
+    {
+      BytesView view = { toothpaste_KeycodePacket_code_tag, {} };
+      if (!walkFields(packet.payload.bytes, packet.payload.size, visitBytes, &view)) {
+        return false;
+      }
+      sendKeycode((uint8_t*)view.bytes.bytes, std::min(view.bytes.size, (size_t)UINT8_MAX), slowMode, true);
+      return true;
+    }
+
+    case toothpaste_EncryptedData_keyEventPacket_tag:
+    {
+      BytesView view = { toothpaste_KeyEventPacket_events_tag, {} };
+      if (!walkFields(packet.payload.bytes, packet.payload.size, visitBytes, &view)) {
+        return false;
+      }
+      sendKeyEvents(view.bytes.bytes, view.bytes.size);
+      return true;
+    }
+
+    case toothpaste_EncryptedData_mousePacket_tag:
+      return streamMouse(packet.payload);
+
+    default:
+      return false;
+  }
+}
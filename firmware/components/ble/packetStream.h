@@ -0,0 +1,37 @@
+#ifndef PACKET_STREAM_H
+#define PACKET_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "toothpacket.pb.h"
+
+// Streaming protobuf decode for the hot packet paths
+// Fields are walked with nanopb's stream API and bytes fields are left in the received buffer, so a
+// one character keystroke doesn't zero and fill the max_size arrays of a whole DataPacket and EncryptedData
+
+// A bytes or string field, pointing into the buffer it was read from
+typedef struct {
+    const uint8_t* bytes;
+    size_t size;
+} ByteView;
+
+// A DataPacket's header fields and where its data sits in the received buffer
+typedef struct {
+    toothpaste_DataPacket_PacketID packetID;
+    bool slowMode;
+    ByteView iv;
+    ByteView encryptedData;
+    ByteView tag;
+    bool hasSequence;
+    uint32_t sequence;      // Authenticated as sent, the reorder window numbers writes with the low 16 bits
+    ByteView resumeTicket;  // RESUME_PACKET only
+} DataPacketView;
+
+// Read a serialized DataPacket without copying it, false if it is malformed
+bool scanDataPacket(const uint8_t* data, size_t length, DataPacketView& view);
+
+// Apply a serialized EncryptedData straight from <data> if it is plain keyboard, keycode, key event or mouse input
+// False if the packet needs the full decode (other types, bulk pastes, timestamped input for the playout buffer)
+bool streamEncryptedData(const uint8_t* data, size_t length, bool slowMode);
+
+#endif // PACKET_STREAM_H
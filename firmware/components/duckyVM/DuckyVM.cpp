@@ -0,0 +1,216 @@
+#include "DuckyVM.h"
+
+// Decode a LEB128 varint at <pos>, false if it runs past the end or doesn't fit 32 bits
+static bool readVarint(const uint8_t* code, size_t length, size_t& pos, uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (pos >= length) {
+      return false;
+    }
+    uint8_t byte = code[pos++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+DuckyVM::DuckyVM() : code(nullptr), length(0), defaultDelayUs(0), loopCount(0) {}
+
+// Decode the opcode at <pc> and its operands, leaving <pc> on the next opcode
+DuckyStatus DuckyVM::next(size_t& pc, DuckyOp& op, uint32_t& a, uint32_t& b, const uint8_t*& data) {
+  op = (DuckyOp)code[pc++];
+  a = 0;
+  b = 0;
+  data = nullptr;
+
+  switch (op) {
+    case DUCKY_OP_END:
+    case DUCKY_OP_RELEASE_ALL:
+      return DUCKY_OK;
+
+    case DUCKY_OP_PRESS:
+    case DUCKY_OP_RELEASE:
+      if (pc >= length) {
+        return DUCKY_TRUNCATED;
+      }
+      a = code[pc++];
+      return DUCKY_OK;
+
+    case DUCKY_OP_STRING:
+    case DUCKY_OP_TAP:
+      if (pc >= length || pc + 1 + code[pc] > length) {
+        return DUCKY_TRUNCATED;
+      }
+      a = code[pc++];
+      data = code + pc;
+      pc += a;
+      return DUCKY_OK;
+
+    case DUCKY_OP_DELAY:
+    case DUCKY_OP_DEFAULT_DELAY:
+      return readVarint(code, length, pc, a) ? DUCKY_OK : DUCKY_TRUNCATED;
+
+    case DUCKY_OP_REPEAT:
+      return (readVarint(code, length, pc, a) && readVarint(code, length, pc, b)) ? DUCKY_OK : DUCKY_TRUNCATED;
+
+    default:
+      return DUCKY_BAD_OPCODE;
+  }
+}
+
+DuckyStatus DuckyVM::load(const uint8_t* program, size_t programLength) {
+  code = nullptr;
+  length = 0;
+
+  if (programLength < DUCKY_HEADER_SIZE || programLength > MAX_CODE ||
+      program[0] != DUCKY_MAGIC_0 || program[1] != DUCKY_MAGIC_1 || program[2] != DUCKY_VERSION) {
+    return DUCKY_BAD_HEADER;
+  }
+
+  code = program;
+  length = programLength;
+
+  // Walk every opcode once, REPEAT targets must land on an opcode already seen
+  uint8_t boundaries[MAX_CODE / 8] = {};
+  size_t pc = DUCKY_HEADER_SIZE;
+  while (pc < length) {
+    size_t opPc = pc;
+    boundaries[opPc / 8] |= 1 << (opPc % 8);
+
+    DuckyOp op;
+    uint32_t a, b;
+    const uint8_t* data;
+    DuckyStatus status = next(pc, op, a, b, data);
+    if (status != DUCKY_OK) {
+      code = nullptr;
+      return status;
+    }
+
+    if (op == DUCKY_OP_REPEAT) {
+      size_t target = opPc - b;
+      if (b == 0 || b > opPc - DUCKY_HEADER_SIZE || !(boundaries[target / 8] & (1 << (target % 8)))) {
+        code = nullptr;
+        return DUCKY_BAD_REPEAT;
+      }
+    }
+  }
+
+  return DUCKY_OK;
+}
+
+// Loop bookkeeping for a REPEAT at <opPc>, false if loops nest too deeply
+bool DuckyVM::repeat(size_t& pc, size_t opPc, uint32_t count, uint32_t back) {
+  // Coming back around to the innermost loop
+  if (loopCount > 0 && loops[loopCount - 1].pc == opPc) {
+    if (--loops[loopCount - 1].remaining == 0) {
+      loopCount--;
+      return true;
+    }
+    pc = opPc - back;
+    return true;
+  }
+
+  if (count == 0) {
+    return true;
+  }
+  if (loopCount == MAX_LOOPS) {
+    return false;
+  }
+
+  loops[loopCount].pc = opPc;
+  loops[loopCount].remaining = count;
+  loopCount++;
+  pc = opPc - back;
+  return true;
+}
+
+void DuckyVM::pause(DuckyHost& host, uint32_t us) {
+  if (us > 0) {
+    host.waitUntil(host.now() + us);
+  }
+}
+
+DuckyStatus DuckyVM::run(DuckyHost& host) {
+  if (code == nullptr) {
+    return DUCKY_BAD_HEADER;
+  }
+
+  size_t pc = DUCKY_HEADER_SIZE;
+  DuckyStatus status = DUCKY_OK;
+  defaultDelayUs = 0;
+  loopCount = 0;
+
+  while (pc < length) {
+    if (host.aborted()) {
+      status = DUCKY_ABORTED;
+      break;
+    }
+
+    size_t opPc = pc;
+    DuckyOp op;
+    uint32_t a, b;
+    const uint8_t* data;
+    status = next(pc, op, a, b, data); // Already validated by load
+    if (status != DUCKY_OK || op == DUCKY_OP_END) {
+      break;
+    }
+
+    switch (op) {
+      case DUCKY_OP_STRING:
+        host.typeText((const char*)data, a);
+        pause(host, defaultDelayUs);
+        break;
+
+      case DUCKY_OP_DELAY:
+        pause(host, a);
+        break;
+
+      case DUCKY_OP_DEFAULT_DELAY:
+        defaultDelayUs = a;
+        break;
+
+      case DUCKY_OP_PRESS:
+      case DUCKY_OP_RELEASE:
+        host.setKey(a, op == DUCKY_OP_PRESS);
+        host.sendKeys();
+        pause(host, defaultDelayUs);
+        break;
+
+      case DUCKY_OP_TAP:
+        for (uint32_t i = 0; i < a; i++) {
+          host.setKey(data[i], true);
+        }
+        host.sendKeys();
+        for (uint32_t i = 0; i < a; i++) {
+          host.setKey(data[i], false);
+        }
+        host.sendKeys();
+        pause(host, defaultDelayUs);
+        break;
+
+      case DUCKY_OP_RELEASE_ALL:
+        host.releaseAll();
+        pause(host, defaultDelayUs);
+        break;
+
+      case DUCKY_OP_REPEAT:
+        if (!repeat(pc, opPc, a, b)) {
+          status = DUCKY_LOOP_DEPTH;
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    if (status != DUCKY_OK) {
+      break;
+    }
+  }
+
+  // A script never leaves keys held
+  host.releaseAll();
+  return status;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Duckyscript bytecode, compiled by the web client (see DuckyscriptCompiler.js)
+// A 4 byte header ['D']['K'][version][0] followed by opcodes, numbers are LEB128 varints
+//   END                                   stop (also implied at the end of the code)
+//   STRING        [length][utf-8 bytes]   type text through the keyboard layout
+//   DELAY         [us]                    wait, measured from the end of the previous command
+//   DEFAULT_DELAY [us]                    wait inserted after every following key or text command
+//   PRESS         [usage]                 hold a key (HID keyboard usage, modifiers are 0xE0-0xE7)
+//   RELEASE       [usage]                 release a held key
+//   TAP           [count][usages]         press the keys together then release them
+//   RELEASE_ALL                           release every held key
+//   REPEAT        [count][back]           run the <back> bytes before this opcode <count> more times
+// The interpreter has no platform dependencies so it also builds for the host (see firmware/tools/duckyBench)
+
+#define DUCKY_MAGIC_0 'D'
+#define DUCKY_MAGIC_1 'K'
+#define DUCKY_VERSION 1
+#define DUCKY_HEADER_SIZE 4
+
+enum DuckyOp : uint8_t {
+  DUCKY_OP_END,
+  DUCKY_OP_STRING,
+  DUCKY_OP_DELAY,
+  DUCKY_OP_DEFAULT_DELAY,
+  DUCKY_OP_PRESS,
+  DUCKY_OP_RELEASE,
+  DUCKY_OP_TAP,
+  DUCKY_OP_RELEASE_ALL,
+  DUCKY_OP_REPEAT
+};
+
+enum DuckyStatus : uint8_t {
+  DUCKY_OK,
+  DUCKY_BAD_HEADER,
+  DUCKY_BAD_OPCODE,
+  DUCKY_TRUNCATED,    // An operand runs past the end of the code
+  DUCKY_BAD_REPEAT,   // A REPEAT doesn't jump back to an opcode
+  DUCKY_LOOP_DEPTH,   // REPEATs nested deeper than MAX_LOOPS
+  DUCKY_ABORTED
+};
+
+// What a script drives, implemented by the HID engine on the device and by a simulator on the host
+class DuckyHost {
+public:
+  virtual ~DuckyHost() {}
+  virtual void typeText(const char* text, size_t length) = 0;
+  virtual void setKey(uint8_t usage, bool down) = 0; // Change the held key state without sending it
+  virtual void sendKeys() = 0;                       // Send the held key state
+  virtual void releaseAll() = 0;
+  virtual int64_t now() = 0;                         // Microseconds, monotonic
+  virtual void waitUntil(int64_t time) = 0;          // Block until now() reaches <time>
+  virtual bool aborted() { return false; }           // Checked between opcodes
+};
+
+class DuckyVM {
+public:
+  static constexpr size_t MAX_CODE = 4096;
+  static constexpr size_t MAX_LOOPS = 8;
+
+  DuckyVM();
+
+  // Check a whole program before anything runs, nothing is typed for a malformed script
+  DuckyStatus load(const uint8_t* code, size_t length);
+
+  // Execute the loaded program to the end
+  DuckyStatus run(DuckyHost& host);
+
+private:
+  typedef struct {
+    uint16_t pc;        // Offset of the REPEAT opcode that owns the loop
+    uint32_t remaining; // Passes left
+  } Loop;
+
+  const uint8_t* code;
+  size_t length;
+  uint32_t defaultDelayUs;
+  Loop loops[MAX_LOOPS];
+  size_t loopCount;
+
+  DuckyStatus next(size_t& pc, DuckyOp& op, uint32_t& a, uint32_t& b, const uint8_t*& data);
+  bool repeat(size_t& pc, size_t opPc, uint32_t count, uint32_t back);
+  void pause(DuckyHost& host, uint32_t us);
+};
@@ -0,0 +1,82 @@
+#include "editScript.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+// Greedy forward Myers search. Row d of the trace holds the furthest x reached on every diagonal
+// k = x - y in [-d, d], stored at trace[d * d + d + k] so the rows pack into (D + 1)^2 entries.
+// Texts are limited to INT16_MAX elements by the trace width
+int editScript(const uint32_t *a, size_t n, const uint32_t *b, size_t m, EditOp *ops, size_t maxEdits) {
+  int maxD = (int)std::min(n + m, maxEdits);
+  int16_t *trace = (int16_t*)malloc((size_t)(maxD + 1) * (maxD + 1) * sizeof(int16_t));
+  if (trace == nullptr) {
+    return -1;
+  }
+
+  int found = -1;
+  for (int d = 0; d <= maxD && found < 0; d++) {
+    int16_t *v = trace + d * d + d;
+    const int16_t *prev = (d > 0) ? trace + (d - 1) * (d - 1) + (d - 1) : nullptr;
+
+    for (int k = -d; k <= d; k += 2) {
+      int x;
+      if (d == 0) {
+        x = 0;
+      }
+      else if (k == -d || (k != d && prev[k - 1] < prev[k + 1])) {
+        x = prev[k + 1];     // Step down: insert b[y]
+      }
+      else {
+        x = prev[k - 1] + 1; // Step right: delete a[x - 1]
+      }
+
+      // Follow the diagonal while the texts match
+      int y = x - k;
+      while (x < (int)n && y < (int)m && a[x] == b[y]) {
+        x++;
+        y++;
+      }
+      v[k] = x;
+
+      if (x >= (int)n && y >= (int)m) {
+        found = d;
+        break;
+      }
+    }
+  }
+
+  if (found < 0) {
+    free(trace);
+    return -1;
+  }
+
+  // Walk back from (n, m) one edit per row, writing the ops in reverse
+  int count = 0;
+  int x = n;
+  int y = m;
+  for (int d = found; d > 0; d--) {
+    const int16_t *prev = trace + (d - 1) * (d - 1) + (d - 1);
+    int k = x - y;
+    bool down = (k == -d || (k != d && prev[k - 1] < prev[k + 1]));
+    int prevK = down ? k + 1 : k - 1;
+    int prevX = prev[prevK];
+    int startX = down ? prevX : prevX + 1;
+
+    while (x > startX) {
+      ops[count++] = EDIT_KEEP;
+      x--;
+    }
+    ops[count++] = down ? EDIT_INSERT : EDIT_DELETE;
+
+    x = prevX;
+    y = prevX - prevK;
+  }
+  while (x > 0) {
+    ops[count++] = EDIT_KEEP;
+    x--;
+  }
+
+  std::reverse(ops, ops + count);
+  free(trace);
+  return count;
+}
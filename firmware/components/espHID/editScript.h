@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// One step of an edit script, applied left to right with a cursor walking the old text
+enum EditOp : uint8_t {
+  EDIT_KEEP,   // Step over old[i]
+  EDIT_DELETE, // Remove old[i]
+  EDIT_INSERT  // Insert new[j] at the cursor
+};
+
+// Shortest edit script turning a[0..n) into b[0..m) (Myers, O((n + m) * D) time, O(D^2) memory)
+// Writes at most n + m ops, returns the op count, or -1 if more than maxEdits inserts and deletes are needed
+int editScript(const uint32_t *a, size_t n, const uint32_t *b, size_t m, EditOp *ops, size_t maxEdits);
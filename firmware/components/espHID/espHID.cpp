@@ -1,5 +1,7 @@
 #include <espHID.h>
 
+#include <esp_timer.h>
+
 #include "tinyusb.h"
 #include "tudconfig.cpp"
 #include "IDFHID.h"
@@ -7,7 +9,12 @@
 #include "IDFHIDMouse.h"
 #include "IDFHIDConsumerControl.h"
 #include "IDFHIDSystemControl.h"
+#include "IDFHIDTouchpad.h"
+#include "IDFHIDGamepad.h"
 #include "SerialDebug.h"
+#include "editScript.h"
+#include "DuckyVM.h"
+#include "LzText.h"
 
 // TODO: ESP_LOGI("HID", "Interface 1 report complete"); this string gets stuck reports only on interface 0
 
@@ -21,42 +28,282 @@
 // RTOS Queue for HID reports
 #define MAX_QUEUE_STRING_LEN 256
 
+// What the keyboard task should do with a queued item
+enum QueueItemType : uint8_t {
+  QUEUE_ITEM_STRING,      // Text typed through the keyboard layout
+  QUEUE_ITEM_KEY_EVENTS,  // Raw key events applied to the held key state (see toothpaste.KeyEventPacket)
+  QUEUE_ITEM_RELEASE_ALL, // Release every held key
+  QUEUE_ITEM_CHORDS,      // Chord sequence (see toothpaste.ChordSequencePacket)
+  QUEUE_ITEM_LAYOUT,      // Switch keyboard layouts, data[0] = toothpaste.ConfigPacket.KeyboardLayout
+  QUEUE_ITEM_SYNC,        // Sync mode target chunk, [flags][offset lo][offset hi] followed by text
+  QUEUE_ITEM_PASTE,       // Bulk paste chunk, [paste id LE][offset LE] followed by text
+  QUEUE_ITEM_PASTE_LZ,    // Compressed bulk paste chunk, [paste id LE][offset LE] followed by LzText.h tokens
+  QUEUE_ITEM_SCRIPT,      // Duckyscript bytecode chunk, [flags][offset lo][offset hi] followed by code
+  QUEUE_ITEM_COMPOSITE    // Composite event list (see toothpaste.CompositePacket)
+};
+
 typedef struct {
+  QueueItemType type;
   char data[MAX_QUEUE_STRING_LEN];
   uint8_t length;
 } QueueStringItem;
 
 QueueHandle_t reportQueue = xQueueCreate(18, sizeof(QueueStringItem)); // Queue to manage HID inputs
 
+#define KEY_EVENT_SIZE 3 // [usage][state][delay ms]
+
+// Host-acknowledged typing (see setAckTyping)
+#define ACK_TYPING_PROBE_CHARS 16   // Characters typed between lock-key probes
+#define ACK_TYPING_TIMEOUT_MS 250   // Longest wait for the host to echo a probe
+#define ACK_TYPING_MAX_DELAY_MS 20  // Slowest per-character delay after backing off
+#define ACK_TYPING_MAX_MISSES 3     // Unanswered probes in a row before falling back to SLOWMODE_DELAY_MS
+
+#define LOCK_ECHO_TIMEOUT_MS 100 // Longest wait for the host to echo a caps lock toggle
+
+// UTF-8 decoder state, kept between strings since a client may split a character across packets
+typedef struct {
+  uint32_t codepoint;
+  uint8_t remaining; // Continuation bytes still expected
+  uint8_t length;    // Bytes in the sequence being decoded
+} Utf8Decoder;
+
+Utf8Decoder utf8Decoder = {};
+
+bool ackTypingEnabled = false;
+uint8_t ackTypingDelayMs = SLOWMODE_DELAY_MS; // Per-character delay learned from the host's echoes
+
+// Chord sequence layout (see toothpaste.ChordSequencePacket)
+#define CHORD_HEADER_SIZE 3 // [count | text << 7][hold ms lo][hold hi]
+#define CHORD_TEXT_FLAG 0x80
+#define CHORD_COUNT_MASK 0x7F
+
+// Layouts selectable at runtime, indexed by toothpaste.ConfigPacket.KeyboardLayout
+typedef struct {
+  const uint8_t *ascii;
+  const KeyboardUnicodeLayout *unicode;
+} KeyboardLayoutEntry;
+
+const KeyboardLayoutEntry keyboardLayouts[_toothpaste_ConfigPacket_KeyboardLayout_ARRAYSIZE] = {
+  {nullptr, nullptr},                              // UNCHANGED
+  {KeyboardLayout_en_US, nullptr},
+  {KeyboardLayout_de_DE, &KeyboardUnicode_de_DE},
+  {KeyboardLayout_fr_FR, &KeyboardUnicode_fr_FR},
+  {KeyboardLayout_es_ES, &KeyboardUnicode_es_ES},
+  {KeyboardLayout_it_IT, &KeyboardUnicode_it_IT},
+  {KeyboardLayout_pt_PT, &KeyboardUnicode_pt_PT},
+  {KeyboardLayout_pt_BR, &KeyboardUnicode_pt_BR},
+  {KeyboardLayout_sv_SE, &KeyboardUnicode_sv_SE},
+  {KeyboardLayout_da_DK, &KeyboardUnicode_da_DK},
+  {KeyboardLayout_hu_HU, &KeyboardUnicode_hu_HU},
+};
+
+// Sync mode (see toothpaste.SyncPacket)
+#define SYNC_MAX_CHARS 2048                 // Longest text sync mode tracks, in code points
+#define SYNC_MAX_BYTES (SYNC_MAX_CHARS * 2) // Longest UTF-8 target
+#define SYNC_MAX_EDITS 96                   // Beyond this many edits the changed span is retyped instead
+#define SYNC_HEADER_SIZE 3
+#define SYNC_FLAG_DONE 0x01
+#define SYNC_FLAG_RESET 0x02
+#define SYNC_FLAG_END 0x04                  // Session over, free the buffers
+
+// What sync mode knows about the host's text field, buffers are allocated on the first sync
+typedef struct {
+  uint32_t *typed;       // Code points in the field after the last sync
+  uint16_t typedLength;
+  uint16_t cursor;       // Cursor position within <typed>
+  char *target;          // UTF-8 target being assembled from chunks
+  uint16_t targetLength;
+  bool targetValid;      // Cleared by an out of order or oversized chunk until the next offset 0
+} SyncState;
+
+SyncState syncState = {};
+
+// Bulk paste progress (see toothpaste.KeyboardPacket.pasteId), kept across disconnects so the client can resume
+#define PASTE_HEADER_SIZE 8
+#define PASTE_MAX_EXPANDED 1024 // Text one compressed chunk may expand to
+
+typedef struct {
+  uint32_t id;
+  volatile uint32_t typed; // Bytes of the paste emitted to USB
+} PasteState;
+
+PasteState paste = {};
+uint8_t pasteExpanded[PASTE_MAX_EXPANDED]; // Compressed chunks are expanded here by the keyboard task
+void (*pasteProgressCallback)(uint32_t id, uint32_t offset) = nullptr;
+
+// Duckyscript bytecode (see DuckyVM.h), assembled from chunks and run by the keyboard task once complete
+#define SCRIPT_HEADER_SIZE 3
+#define SCRIPT_FLAG_DONE 0x01
+
+typedef struct {
+  uint8_t *code;      // Allocated on the first chunk, freed after the script runs
+  uint16_t length;
+  bool valid;         // Cleared by an out of order or oversized chunk until the next offset 0
+} ScriptState;
+
+ScriptState script = {};
+volatile bool scriptAbort = false;     // Set by stopScript, checked between opcodes
+esp_timer_handle_t keyboardTimer = nullptr; // Wakes the keyboard task at a scheduled time (script delays, composite events)
+
+// Composite event list (see toothpaste.CompositePacket), run by the keyboard task so keyboard and mouse events stay in order
+#define COMPOSITE_HEADER_SIZE 4 // [kind][delay ms lo][delay ms hi][length]
+#define COMPOSITE_MOUSE_SIZE 6  // [dx lo][dx hi][dy lo][dy hi][buttons][wheel]
+#define COMPOSITE_KEY_SIZE 2    // [usage][state]
+
+enum CompositeEventKind : uint8_t {
+  COMPOSITE_TEXT,     // UTF-8 text typed through the keyboard layout
+  COMPOSITE_KEYCODE,  // KeycodePacket encoding, pressed then released
+  COMPOSITE_KEY,      // Raw key state change, [usage][state bit 0 = down]
+  COMPOSITE_MOUSE,    // Relative move, buttons bit 0 = left, bit 1 = right (held state)
+  COMPOSITE_CONSUMER  // Consumer control usage, [usage lo][usage hi]
+};
+
 // RTOS Task flags
 bool mouseJiggleEnabled = false;
 bool keyboardStarted = false;
+volatile bool keyboardBusy = false; // The keyboard task is working on a queue item
 
 // Task handle for jiggle task (NULL when not running)
 TaskHandle_t jiggleTaskHandle = nullptr;
 TaskHandle_t keyboardTaskHandle = nullptr;
+TaskHandle_t gamepadTaskHandle = nullptr;
+TaskHandle_t mouseTaskHandle = nullptr;
 
 // HID Instances
 IDFHIDKeyboard keyboard0(0); // Boot Keyboard
 IDFHIDMouse mouse(1); // Boot Mouse
 IDFHIDConsumerControl control(2); // Consumer Control
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+IDFHIDTouchpad touchpad(ITF_NUM_TOUCHPAD); // Precision Touchpad
+#endif
+#if TOOTHPASTE_GAMEPAD_ENABLED
+IDFHIDGamepad gamepad(ITF_NUM_GAMEPAD); // Gamepad
+#endif
+
+// Touchpad frame layout (see toothpaste.TouchpadPacket)
+#define TOUCH_FRAME_HEADER_SIZE 2
+#define TOUCH_CONTACT_SIZE 5
+#define TOUCHPAD_MOUSE_DIVISOR 4 // Touchpad units per mouse count when the host did not enable the touchpad
+
+// Mouse motion goes through a queue the mouse task replays, packed frames (see toothpaste.MousePacket.packedFrames) are unpacked into it
+#define MOTION_QUEUE_LENGTH 256    // Room for a full packet of short frames on top of the one playing
+#define PACKED_FRAME_LONG 0x80     // Followed by zig-zag varint dx, dy
+#define PACKED_FRAME_SPACING 0x81  // Followed by a varint ms the timed frames after it are spaced by
+                                   // 0x82 - 0x8F are reserved, any other byte is a short frame: int4 dx, dy (high, low nibble)
+#define MOTION_QUEUE_WAIT_MS 50     // Longest a sender waits for room before dropping frames
+#define MOTION_MAX_LAG_US 20000     // Further behind than this the schedule restarts instead of catching up
+
+typedef struct {
+  int16_t dx;
+  int16_t dy;
+  uint16_t delayms; // Since the previous step
+  int8_t wheel;
+  uint8_t clicks;   // [left << 4 | right] as moveMouse click states, 0 = unchanged
+} MotionStep;
+
+QueueHandle_t motionQueue = xQueueCreate(MOTION_QUEUE_LENGTH, sizeof(MotionStep));
+volatile uint32_t motionPending = 0; // Steps queued or still being written, the queue alone misses the one in hand
+portMUX_TYPE motionMux = portMUX_INITIALIZER_UNLOCKED;
+esp_timer_handle_t mouseTimer = nullptr;
+
+// Gamepad delta layout (see toothpaste.GamepadPacket)
+#define GAMEPAD_AXIS_COUNT 6
+#define GAMEPAD_CHANGED_HAT (1 << 6)
+#define GAMEPAD_CHANGED_BUTTONS (1 << 7)
+
+// Gamepad state held between packets, the gamepad task walks the axes from <from> to <target>
+typedef struct {
+  int8_t target[GAMEPAD_AXIS_COUNT]; // x, y, z, rz, rx, ry
+  int8_t from[GAMEPAD_AXIS_COUNT];
+  int8_t current[GAMEPAD_AXIS_COUNT];
+  uint8_t hat;
+  uint32_t buttons;
+  int64_t segmentStartUs;
+  int64_t segmentLengthUs; // Expected time until the next packet
+  int64_t lastPacketUs;
+  uint32_t sequence; // Last applied packet
+  bool dirty; // Hat or buttons changed since the last report
+} GamepadState;
+
+GamepadState gamepadHeld = {};
+portMUX_TYPE gamepadMux = portMUX_INITIALIZER_UNLOCKED;
+
+void startGamepadTask();
+void startMouseTask();
+void waitForMouse();
 
 void hidSetup()
 { 
   tudsetup(); // Configure TinyUSB
   keyboard0.begin(); // This creates the keyboard ascii layout instance, probably not the best way to handle it???
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+  touchpad.begin();
+#endif
+#if TOOTHPASTE_GAMEPAD_ENABLED
+  gamepad.begin();
+  startGamepadTask(); // Start the RTOS gamepad report task
+#endif
   startKeyboardTask(); // Start the RTOS keyboard task
+  startMouseTask(); // Start the RTOS mouse motion task
 }
 
-// Send a string with a delay between each character (crude implementation of alternative polling rates since ESPHID doesn't expose this)
-size_t sendStringSlow(const char *str, int delayms) {
+// Feed one byte of UTF-8, returns true when <codepoint> holds a complete character
+// Malformed sequences are dropped rather than typed as garbage
+bool utf8Decode(Utf8Decoder& decoder, uint8_t byte, uint32_t& codepoint) {
+  if (byte < 0x80) {
+    decoder.remaining = 0;
+    decoder.length = 1;
+    codepoint = byte;
+    return true;
+  }
+
+  if ((byte & 0xC0) == 0x80) { // Continuation byte
+    if (decoder.remaining == 0) {
+      return false;
+    }
+    decoder.codepoint = (decoder.codepoint << 6) | (byte & 0x3F);
+    decoder.length++;
+    if (--decoder.remaining > 0) {
+      return false;
+    }
+    codepoint = decoder.codepoint;
+    return true;
+  }
+
+  if ((byte & 0xE0) == 0xC0) {
+    decoder.codepoint = byte & 0x1F;
+    decoder.remaining = 1;
+  }
+  else if ((byte & 0xF0) == 0xE0) {
+    decoder.codepoint = byte & 0x0F;
+    decoder.remaining = 2;
+  }
+  else if ((byte & 0xF8) == 0xF0) {
+    decoder.codepoint = byte & 0x07;
+    decoder.remaining = 3;
+  }
+  else {
+    decoder.remaining = 0; // Not a valid lead byte
+  }
+  decoder.length = 1;
+  return false;
+}
+
+// Send <length> bytes of UTF-8 with a delay between each character (crude implementation of alternative polling rates since ESPHID doesn't expose this)
+// <progress> is advanced by each character's byte count once it has been sent
+size_t sendStringSlow(const char *str, size_t length, int delayms, volatile uint32_t *progress = nullptr) {
   size_t sentCount = 0;
 
-  for (size_t i = 0; str[i] != '\0'; i++) {
-    char ch = str[i];
+  for (size_t i = 0; i < length && str[i] != '\0'; i++) {
+    uint32_t codepoint;
+    if (!utf8Decode(utf8Decoder, (uint8_t)str[i], codepoint)) {
+      continue;
+    }
 
-    keyboard0.print(ch);  // Send single character
-    //keyboard1.print(ch);  // Send single character
+    keyboard0.writeUnicode(codepoint);  // Send single character
+    if (progress != nullptr) {
+      *progress += utf8Decoder.length;
+    }
 
     vTaskDelay(pdMS_TO_TICKS(delayms)); // Delay between characters
     sentCount++;
@@ -66,10 +313,137 @@ size_t sendStringSlow(const char *str, int delayms) {
   return sentCount;
 }
 
+// Send a null terminated string with a delay between each character
+size_t sendStringSlow(const char *str, int delayms) {
+  return sendStringSlow(str, strlen(str), delayms);
+}
+
+// Toggle scroll lock and wait for the host's LED report to echo it
+// The host answers reports in order, so an echo means every keystroke before the probe was consumed
+bool probeHost() {
+  uint8_t expected = (keyboard0.leds() ^ LED_SCROLLLOCK) & LED_SCROLLLOCK;
+  keyboard0.write(KEY_SCROLL_LOCK);
+  return keyboard0.waitForLeds(LED_SCROLLLOCK, expected, ACK_TYPING_TIMEOUT_MS);
+}
+
+// Type a string in chunks, probing the host after each chunk
+// Answered probes shave a millisecond off the per-character delay, missed probes double it (AIMD)
+size_t sendStringAcked(const char *str, size_t length, volatile uint32_t *progress) {
+  // Without LED reports there is nothing to pace against
+  if (!keyboard0.hostReportsLeds()) {
+    return sendStringSlow(str, length, SLOWMODE_DELAY_MS, progress);
+  }
+
+  uint8_t initialLeds = keyboard0.leds() & LED_SCROLLLOCK;
+  uint8_t misses = 0;
+  size_t sentCount = 0;
+  size_t pos = 0;
+
+  while (pos < length && str[pos] != '\0') {
+    size_t chunk = std::min<size_t>(ACK_TYPING_PROBE_CHARS, length - pos);
+    sentCount += sendStringSlow(str + pos, chunk, ackTypingDelayMs, progress);
+    pos += chunk;
+
+    if (probeHost()) {
+      misses = 0;
+      if (ackTypingDelayMs > 0) {
+        ackTypingDelayMs--;
+      }
+    }
+    else {
+      ackTypingDelayMs = std::min<uint8_t>(ACK_TYPING_MAX_DELAY_MS, std::max<uint8_t>(1, ackTypingDelayMs * 2));
+
+      // The host stopped echoing, finish at the safe fixed rate
+      if (++misses >= ACK_TYPING_MAX_MISSES) {
+        DEBUG_SERIAL_PRINTLN("Host stopped echoing LED probes, falling back to slow mode");
+        sentCount += sendStringSlow(str + pos, length - pos, SLOWMODE_DELAY_MS, progress);
+        break;
+      }
+    }
+  }
+
+  // Leave scroll lock the way the user had it
+  if ((keyboard0.leds() & LED_SCROLLLOCK) != initialLeds) {
+    probeHost();
+  }
+
+  return sentCount;
+}
+
+// True if the text has a character whose case depends on caps lock
+bool containsLetters(const char *str, size_t length) {
+  for (size_t i = 0; i < length && str[i] != '\0'; i++) {
+    if (isalpha((unsigned char)str[i]) || (uint8_t)str[i] >= 0x80) { // Assume any non-ASCII character may be a letter
+      return true;
+    }
+  }
+  return false;
+}
+
+// Type queued text with the host's caps lock out of the way
+// Caps lock is switched off for the string and back on afterwards, which also works on hosts where Shift
+// doesn't cancel caps lock (macOS). If the host doesn't echo the toggle the keyboard flips Shift per letter instead
+void typeString(const char *str, size_t length, volatile uint32_t *progress = nullptr) {
+  bool capsWasOn = (keyboard0.leds() & LED_CAPSLOCK) && containsLetters(str, length);
+  if (capsWasOn) {
+    keyboard0.write(KEY_CAPS_LOCK);
+    keyboard0.waitForLeds(LED_CAPSLOCK, 0, LOCK_ECHO_TIMEOUT_MS);
+  }
+
+  if (ackTypingEnabled) {
+    sendStringAcked(str, length, progress);
+  }
+  else {
+    sendStringSlow(str, length, SLOWMODE_DELAY_MS, progress);
+  }
+
+  // Restore from the host's actual state rather than from whether the echo came in time, a late echo
+  // still leaves caps lock off, and a host that never toggled it still has it on
+  if (capsWasOn && keyboard0.waitForLeds(LED_CAPSLOCK, 0, LOCK_ECHO_TIMEOUT_MS)) {
+    keyboard0.write(KEY_CAPS_LOCK);
+    keyboard0.waitForLeds(LED_CAPSLOCK, LED_CAPSLOCK, LOCK_ECHO_TIMEOUT_MS);
+  }
+}
+
+// Host keyboard LED state (LED_* bits)
+uint8_t hostLeds() {
+  return keyboard0.leds();
+}
+
+// Register a callback for host LED changes (runs in the USB task, keep it short)
+void onHostLedChange(void (*callback)(uint8_t leds)) {
+  keyboard0.onLedChange(callback);
+}
+
+// Enable or disable host-acknowledged typing for queued strings
+void setAckTyping(bool enable) {
+  ackTypingEnabled = enable;
+}
+
+// How characters missing from the keyboard layout are typed (UNICODE_FALLBACK_*)
+void setUnicodeFallback(uint8_t mode) {
+  keyboard0.setUnicodeFallback(mode);
+}
+
+// Queue a keyboard layout switch, text already queued is still typed with the old layout
+// Returns false for UNCHANGED or an unknown layout
+bool setKeyboardLayout(toothpaste_ConfigPacket_KeyboardLayout layout) {
+  if (layout <= toothpaste_ConfigPacket_KeyboardLayout_UNCHANGED || layout > _toothpaste_ConfigPacket_KeyboardLayout_MAX) {
+    return false;
+  }
+
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_LAYOUT;
+  item.data[0] = (char)layout;
+  item.length = 1;
+  return xQueueSend(reportQueue, &item, 0) == pdTRUE;
+}
+
 // Queue a string to be sent via HID
 void sendString(const char *str, bool slowMode)
 {
   QueueStringItem item;
+  item.type = QUEUE_ITEM_STRING;
   strncpy(item.data, str, MAX_QUEUE_STRING_LEN - 1);
   item.data[MAX_QUEUE_STRING_LEN - 1] = '\0';
   xQueueSend(reportQueue, &item, 0);
@@ -79,6 +453,7 @@ void sendString(const char *str, bool slowMode)
 void sendString(const char *str, uint8_t stringLen, bool slowMode)
 {
   QueueStringItem item;
+  item.type = QUEUE_ITEM_STRING;
   size_t copyLen = stringLen;
   memcpy(item.data, str, copyLen);
   item.data[copyLen] = '\0';
@@ -91,6 +466,605 @@ void sendString(toothpaste_KeyboardPacket& packet, bool slowMode)
   sendString(packet.message, packet.length, slowMode);
 }
 
+// Queue a chunk of a bulk paste, typed from wherever the device got to in that paste
+void sendPaste(toothpaste_KeyboardPacket& packet)
+{
+  QueueStringItem item;
+  memcpy(item.data, &packet.pasteId, 4);
+  memcpy(item.data + 4, &packet.pasteOffset, 4);
+
+  // Compressed chunks stay compressed in the queue, so each slot holds more of the paste
+  if (packet.compressed.size > 0) {
+    item.type = QUEUE_ITEM_PASTE_LZ;
+    item.length = PASTE_HEADER_SIZE + packet.compressed.size;
+    memcpy(item.data + PASTE_HEADER_SIZE, packet.compressed.bytes, packet.compressed.size);
+  }
+  else {
+    item.type = QUEUE_ITEM_PASTE;
+    item.length = PASTE_HEADER_SIZE + strnlen(packet.message, sizeof(packet.message)); // Offsets count UTF-8 bytes
+    memcpy(item.data + PASTE_HEADER_SIZE, packet.message, item.length - PASTE_HEADER_SIZE);
+  }
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Type a paste chunk, skipping whatever was already typed before a reconnect
+void typePaste(uint32_t id, uint32_t offset, const char* text, size_t textLength)
+{
+  // A new paste (or one this device has no record of) starts where the client says it does
+  if (id != paste.id) {
+    paste.id = id;
+    paste.typed = offset;
+  }
+
+  if (offset > paste.typed) {
+    DEBUG_SERIAL_PRINTF("Paste %lu: chunk at %lu skips past %lu, waiting for the client to rewind\n", id, offset, paste.typed);
+  }
+  else if (paste.typed - offset < textLength) {
+    size_t skip = paste.typed - offset;
+    typeString(text + skip, textLength - skip, &paste.typed);
+  }
+
+  if (pasteProgressCallback != nullptr) {
+    pasteProgressCallback(paste.id, paste.typed);
+  }
+}
+
+// Type a queued paste chunk, compressed chunks are expanded first
+void applyPaste(QueueItemType type, const uint8_t* data, size_t length)
+{
+  uint32_t id;
+  uint32_t offset;
+  memcpy(&id, data, 4);
+  memcpy(&offset, data + 4, 4);
+  const uint8_t* payload = data + PASTE_HEADER_SIZE;
+  size_t payloadLength = length - PASTE_HEADER_SIZE;
+
+  if (type == QUEUE_ITEM_PASTE) {
+    typePaste(id, offset, (const char*)payload, payloadLength);
+    return;
+  }
+
+  size_t textLength;
+  if (!lzDecompress(payload, payloadLength, pasteExpanded, sizeof(pasteExpanded), textLength)) {
+    DEBUG_SERIAL_PRINTF("Paste %lu: chunk at %lu doesn't decompress\n", id, offset);
+    return;
+  }
+  typePaste(id, offset, (const char*)pasteExpanded, textLength);
+}
+
+// Current bulk paste and how many of its bytes reached the host, false if there is none
+bool pasteProgress(uint32_t &id, uint32_t &offset)
+{
+  id = paste.id;
+  offset = paste.typed;
+  return id != 0;
+}
+
+// Register a callback run after each paste chunk (runs in the keyboard task)
+void onPasteProgress(void (*callback)(uint32_t id, uint32_t offset))
+{
+  pasteProgressCallback = callback;
+}
+
+// Queue a chunk of Duckyscript bytecode, the script runs in order with any queued text once the last chunk arrives
+void sendScript(toothpaste_ScriptPacket& packet)
+{
+  if (packet.offset + packet.code.size > DuckyVM::MAX_CODE) {
+    DEBUG_SERIAL_PRINTF("Script chunk at %lu out of range\n", packet.offset);
+    return;
+  }
+  if (packet.offset == 0) {
+    scriptAbort = false;
+  }
+
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_SCRIPT;
+  item.data[0] = packet.done ? SCRIPT_FLAG_DONE : 0;
+  item.data[1] = packet.offset & 0xFF;
+  item.data[2] = packet.offset >> 8;
+  memcpy(item.data + SCRIPT_HEADER_SIZE, packet.code.bytes, packet.code.size);
+  item.length = SCRIPT_HEADER_SIZE + packet.code.size;
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Stop the running script at its next opcode (or delay) and skip any script still queued
+void stopScript()
+{
+  scriptAbort = true;
+  if (keyboardTaskHandle != nullptr) {
+    xTaskNotifyGive(keyboardTaskHandle);
+  }
+}
+
+void sleepTimerExpired(void* arg)
+{
+  xTaskNotifyGive((TaskHandle_t)arg);
+}
+
+// Sleep the calling task until esp_timer reaches <time> us, finer than RTOS ticks
+// <timer> belongs to the calling task and is created on first use, a task notification ends the wait early
+void sleepUntil(int64_t time, esp_timer_handle_t& timer)
+{
+  int64_t remaining = time - esp_timer_get_time();
+  if (remaining <= 0) {
+    return;
+  }
+  if (timer == nullptr) {
+    esp_timer_create_args_t timer_args = {
+      .callback = &sleepTimerExpired,
+      .arg = xTaskGetCurrentTaskHandle(),
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "sleepUntil"
+    };
+    esp_timer_create(&timer_args, &timer);
+  }
+
+  ulTaskNotifyTake(pdTRUE, 0); // Drop a stale wake up
+  esp_timer_start_once(timer, remaining);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  esp_timer_stop(timer); // Woken early
+}
+
+// Sleep the keyboard task until <time> us, stopScript wakes it early
+void keyboardWaitUntil(int64_t time)
+{
+  sleepUntil(time, keyboardTimer);
+}
+
+// Drives a script from the keyboard task
+class ScriptHost : public DuckyHost {
+public:
+  void typeText(const char* text, size_t length) override { typeString(text, length); }
+  void setKey(uint8_t usage, bool down) override { keyboard0.setRaw(usage, down); }
+  void sendKeys() override { keyboard0.sendState(); }
+  void releaseAll() override { keyboard0.releaseAll(); }
+  int64_t now() override { return esp_timer_get_time(); }
+  bool aborted() override { return scriptAbort; }
+
+  void waitUntil(int64_t time) override {
+    if (!scriptAbort) {
+      keyboardWaitUntil(time);
+    }
+  }
+};
+
+// Assemble a queued script chunk and run the script once the last chunk is in
+void applyScript(const uint8_t* data, size_t length)
+{
+  uint8_t flags = data[0];
+  uint16_t offset = data[1] | (data[2] << 8);
+  const uint8_t *code = data + SCRIPT_HEADER_SIZE;
+  size_t codeLength = length - SCRIPT_HEADER_SIZE;
+
+  if (offset == 0) {
+    if (script.code == nullptr) {
+      script.code = (uint8_t*)malloc(DuckyVM::MAX_CODE);
+    }
+    script.length = 0;
+    script.valid = script.code != nullptr;
+  }
+
+  if (!script.valid || offset != script.length || offset + codeLength > DuckyVM::MAX_CODE) {
+    DEBUG_SERIAL_PRINTF("Script: dropping chunk at offset %u\n", offset);
+    script.valid = false;
+    return;
+  }
+  memcpy(script.code + offset, code, codeLength);
+  script.length += codeLength;
+
+  if (!(flags & SCRIPT_FLAG_DONE)) {
+    return;
+  }
+
+  DuckyVM vm;
+  ScriptHost host;
+  DuckyStatus status = vm.load(script.code, script.length);
+  if (status == DUCKY_OK && !scriptAbort) {
+    int64_t start = esp_timer_get_time();
+    status = vm.run(host);
+    DEBUG_SERIAL_PRINTF("Script finished with status %u in %lld us\n", status, esp_timer_get_time() - start);
+  }
+  else {
+    DEBUG_SERIAL_PRINTF("Script rejected with status %u\n", status);
+  }
+
+  free(script.code);
+  script = {};
+}
+
+// Queue a toothpaste_CompositePacket, its events run in order with any queued text
+void sendComposite(toothpaste_CompositePacket& packet)
+{
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_COMPOSITE;
+  item.length = packet.events.size;
+  memcpy(item.data, packet.events.bytes, item.length);
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Run a composite event list, each event is scheduled <delay> ms after the previous one was due
+// so the time spent typing text doesn't push every later event back
+// Mouse events go through the mouse task like any other motion, waited on so they stay in order with the keys around them
+void runComposite(const uint8_t* events, size_t length)
+{
+  int64_t due = esp_timer_get_time();
+  size_t pos = 0;
+  bool mouseSynced = false; // Motion queued before the composite has played out
+  bool mouseQueued = false; // Mouse events queued since the last key event
+
+  while (pos + COMPOSITE_HEADER_SIZE <= length) {
+    uint8_t kind = events[pos];
+    uint16_t delayms = events[pos + 1] | (events[pos + 2] << 8);
+    uint8_t size = events[pos + 3];
+    const uint8_t* payload = events + pos + COMPOSITE_HEADER_SIZE;
+    pos += COMPOSITE_HEADER_SIZE + size;
+
+    // Stop at a truncated event instead of reading past the packet
+    if (pos > length) {
+      DEBUG_SERIAL_PRINTF("Malformed composite event (%d bytes)\n", size);
+      return;
+    }
+
+    if (kind == COMPOSITE_MOUSE && !mouseSynced) {
+      waitForMouse(); // Don't let the composite's moves interleave with motion already queued
+      mouseSynced = true;
+    }
+    else if (kind != COMPOSITE_MOUSE && mouseQueued) {
+      waitForMouse(); // A key right after a click lands after it
+      mouseQueued = false;
+    }
+
+    due += delayms * 1000LL;
+    keyboardWaitUntil(due);
+
+    switch (kind) {
+      case COMPOSITE_TEXT:
+        typeString((const char*)payload, size);
+        break;
+
+      case COMPOSITE_KEYCODE:
+        sendKeycode((uint8_t*)payload, size, false, true); // The event delays already space it out
+        break;
+
+      case COMPOSITE_KEY:
+        if (size >= COMPOSITE_KEY_SIZE && keyboard0.setRaw(payload[0], payload[1] & 0x01)) {
+          keyboard0.sendState();
+        }
+        break;
+
+      case COMPOSITE_MOUSE:
+        if (size >= COMPOSITE_MOUSE_SIZE) {
+          int16_t dx = payload[0] | (payload[1] << 8);
+          int16_t dy = payload[2] | (payload[3] << 8);
+          uint8_t buttons = payload[4];
+          moveMouse(dx, dy, (buttons & 0x01) ? 1 : 2, (buttons & 0x02) ? 1 : 2, (int8_t)payload[5]);
+          mouseQueued = true;
+        }
+        break;
+
+      case COMPOSITE_CONSUMER:
+        if (size >= 2) {
+          consumerControlPress(payload[0] | (payload[1] << 8));
+        }
+        break;
+
+      default:
+        DEBUG_SERIAL_PRINTF("Unknown composite event kind %d\n", kind);
+        break;
+    }
+  }
+}
+
+// Queue a toothpaste_KeyEventPacket's events behind any text that is still being typed
+void sendKeyEvents(toothpaste_KeyEventPacket& packet)
+{
+  sendKeyEvents(packet.events.bytes, packet.events.size);
+}
+
+// Queue raw [usage][state][delay ms] key events, as many whole events as fit in one queue item
+void sendKeyEvents(const uint8_t* events, size_t size)
+{
+  size = std::min(size, (size_t)UINT8_MAX); // QueueStringItem.length is one byte
+
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_KEY_EVENTS;
+  item.length = size - (size % KEY_EVENT_SIZE); // Drop a trailing partial event
+  memcpy(item.data, events, item.length);
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Queue a release of every held key (e.g. when the client that pressed them goes away)
+// Waits for room rather than dropping it, a lost release leaves keys pressed on the host; the keyboard task always drains the queue
+void releaseKeys()
+{
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_RELEASE_ALL;
+  item.length = 0;
+  xQueueSend(reportQueue, &item, portMAX_DELAY);
+}
+
+// Queue a toothpaste_ChordSequencePacket so its chords run in order with any queued text
+void sendChords(toothpaste_ChordSequencePacket& packet)
+{
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_CHORDS;
+  item.length = packet.chords.size;
+  memcpy(item.data, packet.chords.bytes, item.length);
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Execute a chord sequence, each key chord is pressed together, held and released before the next chord
+void runChords(const uint8_t* chords, size_t length)
+{
+  size_t pos = 0;
+
+  while (pos + CHORD_HEADER_SIZE <= length) {
+    bool text = chords[pos] & CHORD_TEXT_FLAG;
+    uint8_t count = chords[pos] & CHORD_COUNT_MASK;
+    uint16_t holdms = chords[pos + 1] | (chords[pos + 2] << 8);
+    pos += CHORD_HEADER_SIZE;
+
+    // Stop at a truncated chord instead of reading past the packet
+    if (pos + count > length) {
+      DEBUG_SERIAL_PRINTF("Malformed chord (%d bytes)\n", count);
+      return;
+    }
+
+    if (text) {
+      sendStringSlow((const char*)chords + pos, count, SLOWMODE_DELAY_MS);
+    }
+    else {
+      keyboard0.sendKeycode((uint8_t*)chords + pos, count);
+      vTaskDelay(pdMS_TO_TICKS(holdms ? holdms : SLOWMODE_DELAY_MS));
+      keyboard0.releaseAll();
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(SLOWMODE_DELAY_MS)); // Let the host see the release before the next chord
+    pos += count;
+  }
+}
+
+// Apply raw key events to the held key state
+// Events sharing a timestamp are merged into one report, and events that don't change the state send nothing
+void applyKeyEvents(const uint8_t* events, size_t length)
+{
+  bool pending = false;
+
+  for (size_t pos = 0; pos + KEY_EVENT_SIZE <= length; pos += KEY_EVENT_SIZE) {
+    uint8_t usage = events[pos];
+    bool down = events[pos + 1] & 0x01;
+    uint8_t delayms = events[pos + 2];
+
+    // Flush the state reached so far before waiting out the gap to this event
+    if (delayms) {
+      if (pending) {
+        keyboard0.sendState();
+        pending = false;
+      }
+      vTaskDelay(pdMS_TO_TICKS(delayms));
+    }
+
+    pending |= keyboard0.setRaw(usage, down);
+  }
+
+  if (pending) {
+    keyboard0.sendState();
+  }
+}
+
+// Queue a toothpaste_SyncPacket chunk, chunks are assembled and diffed by the keyboard task
+void sendSync(toothpaste_SyncPacket& packet)
+{
+  if (packet.offset > UINT16_MAX) {
+    DEBUG_SERIAL_PRINTF("Sync offset %lu out of range\n", packet.offset);
+    return;
+  }
+
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_SYNC;
+  item.data[0] = (packet.done ? SYNC_FLAG_DONE : 0) | (packet.reset ? SYNC_FLAG_RESET : 0);
+  item.data[1] = packet.offset & 0xFF;
+  item.data[2] = packet.offset >> 8;
+  memcpy(item.data + SYNC_HEADER_SIZE, packet.text.bytes, packet.text.size);
+  item.length = SYNC_HEADER_SIZE + packet.text.size;
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Queue the end of the sync session, the next sync starts from an empty field
+void resetSync()
+{
+  QueueStringItem item;
+  item.type = QUEUE_ITEM_SYNC;
+  item.data[0] = SYNC_FLAG_RESET | SYNC_FLAG_END;
+  item.data[1] = 0;
+  item.data[2] = 0;
+  item.length = SYNC_HEADER_SIZE;
+  xQueueSend(reportQueue, &item, 0);
+}
+
+// Tap a non-printing key for sync mode
+void syncTap(uint8_t key)
+{
+  keyboard0.write(key);
+  vTaskDelay(pdMS_TO_TICKS(SLOWMODE_DELAY_MS));
+}
+
+// Type a code point for sync mode, false if neither the layout nor the Unicode fallback could type it
+bool syncType(uint32_t codepoint)
+{
+  bool typed = keyboard0.writeUnicode(codepoint) > 0;
+  vTaskDelay(pdMS_TO_TICKS(SLOWMODE_DELAY_MS));
+  keyboard0.releaseAll();
+  return typed;
+}
+
+// Walk the cursor to <position> with the arrow keys, which behave the same in every text field
+void syncMoveCursor(uint16_t position)
+{
+  while (syncState.cursor > position) {
+    syncTap(KEY_LEFT_ARROW);
+    syncState.cursor--;
+  }
+  while (syncState.cursor < position) {
+    syncTap(KEY_RIGHT_ARROW);
+    syncState.cursor++;
+  }
+}
+
+// Turn the text typed by the last sync into the assembled target with as few keystrokes as the edit script allows
+// The shared prefix and suffix are skipped outright, only the span between them is diffed
+void syncText()
+{
+  uint32_t *target = (uint32_t*)malloc(SYNC_MAX_CHARS * sizeof(uint32_t));
+  if (target == nullptr) {
+    DEBUG_SERIAL_PRINTLN("Sync: out of memory");
+    return;
+  }
+
+  // Decode the target, carriage returns are dropped since Enter already types the line break
+  Utf8Decoder decoder = {};
+  size_t m = 0;
+  for (size_t i = 0; i < syncState.targetLength; i++) {
+    uint32_t codepoint;
+    if (utf8Decode(decoder, (uint8_t)syncState.target[i], codepoint) && codepoint != '\r') {
+      if (m == SYNC_MAX_CHARS) {
+        DEBUG_SERIAL_PRINTLN("Sync: target too long");
+        free(target);
+        return;
+      }
+      target[m++] = codepoint;
+    }
+  }
+
+  const uint32_t *typed = syncState.typed;
+  size_t n = syncState.typedLength;
+
+  size_t prefix = 0;
+  while (prefix < n && prefix < m && typed[prefix] == target[prefix]) {
+    prefix++;
+  }
+  size_t suffix = 0;
+  while (suffix < n - prefix && suffix < m - prefix && typed[n - 1 - suffix] == target[m - 1 - suffix]) {
+    suffix++;
+  }
+  size_t a = n - prefix - suffix; // Span to replace in the field
+  size_t b = m - prefix - suffix; // Span to replace it with
+
+  // The field is rebuilt in <target> as it is edited, <k> is the end of the edited span in it
+  // A character that couldn't be typed isn't in the field, the next sync sees it as missing and tries again
+  size_t k = prefix;
+  if (a + b > 0) {
+    EditOp *ops = (EditOp*)malloc(a + b);
+    int count = (ops != nullptr) ? editScript(typed + prefix, a, target + prefix, b, ops, SYNC_MAX_EDITS) : -1;
+
+    syncMoveCursor(prefix);
+    size_t j = prefix;
+    size_t cursor = prefix;
+
+    if (count < 0) {
+      // Too many edits to search, retype the span
+      for (size_t i = 0; i < a; i++) {
+        syncTap(KEY_DELETE);
+      }
+      for (; j < prefix + b; j++) {
+        if (syncType(target[j])) {
+          target[k++] = target[j];
+        }
+      }
+      cursor = k;
+    }
+    else {
+      // Characters kept after the last edit are left alone, walking the cursor over them changes nothing
+      int last = count - 1;
+      while (last >= 0 && ops[last] == EDIT_KEEP) {
+        last--;
+      }
+
+      for (int i = 0; i < count; i++) {
+        switch (ops[i]) {
+          case EDIT_KEEP:
+            if (i < last) {
+              syncTap(KEY_RIGHT_ARROW);
+              cursor++;
+            }
+            target[k++] = target[j++];
+            break;
+          case EDIT_DELETE:
+            syncTap(KEY_DELETE);
+            break;
+          case EDIT_INSERT:
+            if (syncType(target[j])) {
+              target[k++] = target[j];
+              cursor++;
+            }
+            j++;
+            break;
+        }
+      }
+    }
+    free(ops);
+    syncState.cursor = cursor;
+  }
+
+  memmove(target + k, target + prefix + b, suffix * sizeof(uint32_t));
+  memcpy(syncState.typed, target, (k + suffix) * sizeof(uint32_t));
+  syncState.typedLength = k + suffix;
+  free(target);
+}
+
+// Apply one queued sync chunk
+void applySync(const uint8_t* data, size_t length)
+{
+  uint8_t flags = data[0];
+  uint16_t offset = data[1] | (data[2] << 8);
+  const uint8_t *text = data + SYNC_HEADER_SIZE;
+  size_t textLength = length - SYNC_HEADER_SIZE;
+
+  if (flags & SYNC_FLAG_RESET) {
+    syncState.typedLength = 0;
+    syncState.cursor = 0;
+  }
+
+  if (flags & SYNC_FLAG_END) {
+    free(syncState.typed);
+    free(syncState.target);
+    syncState = {};
+    return;
+  }
+
+  if (syncState.typed == nullptr) {
+    syncState.typed = (uint32_t*)malloc(SYNC_MAX_CHARS * sizeof(uint32_t));
+    syncState.target = (char*)malloc(SYNC_MAX_BYTES);
+    if (syncState.typed == nullptr || syncState.target == nullptr) {
+      DEBUG_SERIAL_PRINTLN("Sync: out of memory");
+      free(syncState.typed);
+      free(syncState.target);
+      syncState = {};
+      return;
+    }
+  }
+
+  if (offset == 0) {
+    syncState.targetLength = 0;
+    syncState.targetValid = true;
+  }
+
+  // A lost or oversized chunk leaves the target unusable, the field is left alone
+  if (!syncState.targetValid || offset != syncState.targetLength || offset + textLength > SYNC_MAX_BYTES) {
+    DEBUG_SERIAL_PRINTF("Sync: dropping chunk at offset %u\n", offset);
+    syncState.targetValid = false;
+    return;
+  }
+
+  memcpy(syncState.target + offset, text, textLength);
+  syncState.targetLength += textLength;
+
+  if (flags & SYNC_FLAG_DONE) {
+    syncText();
+    syncState.targetValid = false;
+  }
+}
+
 void stringTest(){
   sendTestString();
 }
@@ -107,8 +1081,8 @@ void stringTest(){
 //     //keyboard1.releaseAll();
 // }
 
-void sendKeycode(uint8_t* encodedKeys, bool slowMode, bool autoRelease) {
-    keyboard0.sendKeycode(encodedKeys, 6);
+void sendKeycode(uint8_t* encodedKeys, uint8_t numKeys, bool slowMode, bool autoRelease) {
+    keyboard0.sendKeycode(encodedKeys, numKeys);
     //keyboard1.sendKeycode(encodedKeys, 6);
     if(slowMode){
       vTaskDelay(pdMS_TO_TICKS(SLOWMODE_DELAY_MS));
@@ -118,8 +1092,44 @@ void sendKeycode(uint8_t* encodedKeys, bool slowMode, bool autoRelease) {
 
 }
 
+// Queue a step for the mouse task, false if there was no room for it in time
+bool queueMotion(const MotionStep& step) {
+  taskENTER_CRITICAL(&motionMux);
+  motionPending++;
+  taskEXIT_CRITICAL(&motionMux);
+
+  if (xQueueSend(motionQueue, &step, pdMS_TO_TICKS(MOTION_QUEUE_WAIT_MS)) != pdTRUE) {
+    taskENTER_CRITICAL(&motionMux);
+    motionPending--;
+    taskEXIT_CRITICAL(&motionMux);
+    return false;
+  }
+  return true;
+}
+
+// Block until the mouse task has written every step queued so far
+void waitForMouse() {
+  while (motionPending > 0) {
+    vTaskDelay(1);
+  }
+}
+
 // Move the mouse by dx and dy, with optional left/right click states
+// Queued behind any motion still playing so clicks can't overtake it
 void moveMouse(int32_t x, int32_t y, int32_t LClick, int32_t RClick, int32_t wheel){
+  MotionStep step;
+  step.dx = std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, x));
+  step.dy = std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, y));
+  step.delayms = 0;
+  step.wheel = std::max<int32_t>(INT8_MIN, std::min<int32_t>(INT8_MAX, wheel));
+  step.clicks = ((LClick & 0x0F) << 4) | (RClick & 0x0F);
+  if (!queueMotion(step)) {
+    DEBUG_SERIAL_PRINTLN("Motion queue full, dropping mouse report");
+  }
+}
+
+// Write a mouse report, only the mouse task calls this so reports go out in the order they were queued
+static void writeMouse(int32_t x, int32_t y, int32_t LClick, int32_t RClick, int32_t wheel){
   
   //Click before moving if the click is in the same report
   if(!(mouse.isPressed(MOUSE_LEFT)) && LClick == 1){
@@ -190,8 +1200,87 @@ void moveMouse(uint8_t* mousePacket) {
     moveMouse(0, 0, LClick, RClick, 0); 
 }
 
+// Decode an unsigned LEB128 varint, false if it runs past the end
+bool readVarint(const uint8_t* data, size_t size, size_t& pos, uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 35 && pos < size; shift += 7) {
+    uint8_t byte = data[pos++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Unpack packed frames straight into the motion queue, the clicks and wheel follow the last frame
+// Small moves take one byte per frame, timed ones too while their spacing stays the same
+void moveMouse(const uint8_t* data, size_t size, bool timed, int32_t LClick, int32_t RClick, int32_t wheel) {
+  size_t pos = 0;
+  uint32_t spacing = 0;
+
+  while (pos < size) {
+    uint8_t token = data[pos++];
+    int32_t dx;
+    int32_t dy;
+
+    if (token == PACKED_FRAME_SPACING) {
+      if (!readVarint(data, size, pos, spacing)) {
+        DEBUG_SERIAL_PRINTLN("Malformed packed mouse spacing");
+        break;
+      }
+      continue;
+    }
+    else if (token == PACKED_FRAME_LONG) {
+      uint32_t zx, zy;
+      if (!readVarint(data, size, pos, zx) || !readVarint(data, size, pos, zy)) {
+        DEBUG_SERIAL_PRINTLN("Malformed packed mouse frame");
+        break;
+      }
+      dx = unzigzag(zx);
+      dy = unzigzag(zy);
+    }
+    else if ((token & 0xF0) == 0x80) {
+      DEBUG_SERIAL_PRINTF("Reserved packed mouse token 0x%02x\n", token);
+      break;
+    }
+    else {
+      dx = (int8_t)token >> 4;          // Arithmetic shifts sign-extend the nibbles
+      dy = (int8_t)(token << 4) >> 4;
+    }
+
+    MotionStep step;
+    step.dx = std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, dx));
+    step.dy = std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, dy));
+    step.delayms = timed ? std::min(spacing, (uint32_t)UINT16_MAX) : 0;
+    step.wheel = 0;
+    step.clicks = 0;
+    if (!queueMotion(step)) {
+      DEBUG_SERIAL_PRINTLN("Motion queue full, dropping frames");
+      return;
+    }
+  }
+
+  MotionStep last = {};
+  last.wheel = std::max<int32_t>(INT8_MIN, std::min<int32_t>(INT8_MAX, wheel));
+  last.clicks = ((LClick & 0x0F) << 4) | (RClick & 0x0F);
+  if (last.wheel != 0 || last.clicks != 0) {
+    queueMotion(last);
+  }
+}
+
 // Unpack a toothpacket_MousePacket and move the mouse accordingly
 void moveMouse(toothpaste_MousePacket& mousePacket) {
+    if (mousePacket.packedFrames.size > 0) {
+      moveMouse(mousePacket.packedFrames.bytes, mousePacket.packedFrames.size, mousePacket.timedFrames,
+                mousePacket.l_click, mousePacket.r_click, mousePacket.wheel);
+      return;
+    }
+
     // Move mouse for each frame
     for(uint8_t i = 0; i < mousePacket.num_frames; i++){
         int32_t x = mousePacket.frames[i].x;
@@ -209,6 +1298,157 @@ void moveMouse(toothpaste_MousePacket& mousePacket) {
 }
 
 
+// Unpack a toothpaste_TouchpadPacket and forward its contact frames to the touchpad
+// If the host never enabled touchpad mode the primary contact drives the relative mouse instead
+void touchpadFrames(toothpaste_TouchpadPacket& touchpadPacket) {
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+  static bool lastTip = false; // Primary contact state for the relative mouse fallback
+  static int32_t lastX = 0;
+  static int32_t lastY = 0;
+
+  const uint8_t* data = touchpadPacket.frames.bytes;
+  size_t size = touchpadPacket.frames.size;
+  size_t pos = 0;
+
+  while (pos + TOUCH_FRAME_HEADER_SIZE <= size) {
+    uint8_t count = data[pos] & 0x07;
+    uint8_t button = (data[pos] >> 3) & 0x01;
+    uint8_t delayms = data[pos + 1];
+    pos += TOUCH_FRAME_HEADER_SIZE;
+
+    // Drop malformed frames instead of reading past the packet
+    if (count > TOUCHPAD_MAX_CONTACTS || pos + count * TOUCH_CONTACT_SIZE > size) {
+      DEBUG_SERIAL_PRINTF("Malformed touchpad frame (%d contacts)\n", count);
+      return;
+    }
+
+    // Pace frames at the rate they were captured
+    if (delayms) {
+      vTaskDelay(pdMS_TO_TICKS(delayms));
+    }
+
+    if (touchpad.isActive()) {
+      for (uint8_t i = 0; i < count; i++) {
+        const uint8_t* contact = data + pos + i * TOUCH_CONTACT_SIZE;
+        touchpad.setContact(i, contact[0] & 0x0F, contact[0] & 0x10, contact[1] | (contact[2] << 8), contact[3] | (contact[4] << 8));
+      }
+      touchpad.send(count, button, (uint16_t)(esp_timer_get_time() / 100)); // Scan time is in 100us units
+    }
+    else {
+      const uint8_t* contact = data + pos;
+      bool tip = count > 0 && (contact[0] & 0x10);
+      int32_t x = tip ? (contact[1] | (contact[2] << 8)) : lastX;
+      int32_t y = tip ? (contact[3] | (contact[4] << 8)) : lastY;
+
+      // Only move relative to a previous touch of the same contact
+      int32_t dx = (tip && lastTip) ? (x - lastX) / TOUCHPAD_MOUSE_DIVISOR : 0;
+      int32_t dy = (tip && lastTip) ? (y - lastY) / TOUCHPAD_MOUSE_DIVISOR : 0;
+      dx = std::max<int32_t>(-127, std::min<int32_t>(127, dx));
+      dy = std::max<int32_t>(-127, std::min<int32_t>(127, dy));
+
+      moveMouse(dx, dy, button ? 1 : 2, 0, 0);
+
+      // Carry the remainder lost to the divisor over to the next frame
+      lastX = (tip && lastTip) ? lastX + dx * TOUCHPAD_MOUSE_DIVISOR : x;
+      lastY = (tip && lastTip) ? lastY + dy * TOUCHPAD_MOUSE_DIVISOR : y;
+      lastTip = tip;
+    }
+
+    pos += count * TOUCH_CONTACT_SIZE;
+  }
+#else
+  DEBUG_SERIAL_PRINTLN("Touchpad interface is disabled, dropping touchpad packet");
+#endif
+}
+
+// Apply a toothpaste_GamepadPacket delta to the held gamepad state
+// Returns false for stale or malformed packets, which leave the state untouched
+bool gamepadState(toothpaste_GamepadPacket& gamepadPacket) {
+#if TOOTHPASTE_GAMEPAD_ENABLED
+  const uint8_t* values = gamepadPacket.values.bytes;
+  size_t size = gamepadPacket.values.size;
+  size_t pos = 0;
+
+  int8_t axes[GAMEPAD_AXIS_COUNT];
+  uint8_t hat = 0;
+  uint32_t buttons = 0;
+
+  // Parse first so a truncated packet is rejected as a whole
+  for (uint8_t i = 0; i < GAMEPAD_AXIS_COUNT; i++) {
+    if (gamepadPacket.changed & (1 << i)) {
+      if (pos >= size) return false;
+      axes[i] = (int8_t)values[pos++];
+    }
+  }
+  if (gamepadPacket.changed & GAMEPAD_CHANGED_HAT) {
+    if (pos >= size || values[pos] > HAT_UP_LEFT) return false;
+    hat = values[pos++];
+  }
+  if (gamepadPacket.changed & GAMEPAD_CHANGED_BUTTONS) {
+    if (pos + 4 > size) return false;
+    buttons = values[pos] | (values[pos + 1] << 8) | (values[pos + 2] << 16) | ((uint32_t)values[pos + 3] << 24);
+    pos += 4;
+  }
+
+  int64_t now = esp_timer_get_time();
+  bool applied = false;
+
+  taskENTER_CRITICAL(&gamepadMux);
+  GamepadState& state = gamepadHeld;
+
+  // Deltas are relative to earlier packets, so anything older than the held state is dropped (wrap-safe)
+  if (state.lastPacketUs == 0 || (int32_t)(gamepadPacket.sequence - state.sequence) > 0) {
+    // Stretch the move over the observed packet interval so the sticks glide at the poll rate
+    int64_t interval = state.lastPacketUs ? now - state.lastPacketUs : 0;
+    state.segmentLengthUs = std::min<int64_t>(interval, GAMEPAD_MAX_SEGMENT_US);
+    state.segmentStartUs = now;
+    state.lastPacketUs = now;
+
+    for (uint8_t i = 0; i < GAMEPAD_AXIS_COUNT; i++) {
+      state.from[i] = state.current[i];
+      if (gamepadPacket.changed & (1 << i)) {
+        state.target[i] = axes[i];
+      }
+    }
+    if (gamepadPacket.changed & GAMEPAD_CHANGED_HAT) {
+      state.hat = hat;
+    }
+    if (gamepadPacket.changed & GAMEPAD_CHANGED_BUTTONS) {
+      state.buttons = buttons;
+    }
+
+    state.sequence = gamepadPacket.sequence;
+    state.dirty = true;
+    applied = true;
+  }
+  taskEXIT_CRITICAL(&gamepadMux);
+
+  if (applied && gamepadTaskHandle != nullptr) {
+    xTaskNotifyGive(gamepadTaskHandle);
+  }
+  return applied;
+#else
+  DEBUG_SERIAL_PRINTLN("Gamepad interface is disabled, dropping gamepad packet");
+  return false;
+#endif
+}
+
+// Center the sticks, release the hat and buttons and forget the packet sequence
+// The neutral report goes out straight away, the next packet may come from a new session numbering from scratch
+void resetGamepad() {
+#if TOOTHPASTE_GAMEPAD_ENABLED
+  taskENTER_CRITICAL(&gamepadMux);
+  gamepadHeld = {};
+  gamepadHeld.hat = HAT_CENTER;
+  gamepadHeld.dirty = true;
+  taskEXIT_CRITICAL(&gamepadMux);
+
+  if (gamepadTaskHandle != nullptr) {
+    xTaskNotifyGive(gamepadTaskHandle);
+  }
+#endif
+}
+
 // Simple mouse jiggle function to prevent screen sleep
 void jiggleMouse(){
 
@@ -233,13 +1473,60 @@ void keyboardTask(void* params)
   
   while (keyboardStarted) {
     if(xQueueReceive(reportQueue, &item, portMAX_DELAY) == pdTRUE){
-      sendStringSlow(item.data, SLOWMODE_DELAY_MS);
+      keyboardBusy = true;
+      switch (item.type) {
+        case QUEUE_ITEM_STRING:
+          typeString(item.data, strlen(item.data));
+          break;
+
+        case QUEUE_ITEM_KEY_EVENTS:
+          applyKeyEvents((const uint8_t*)item.data, item.length);
+          break;
+
+        case QUEUE_ITEM_RELEASE_ALL:
+          keyboard0.releaseAll();
+          break;
+
+        case QUEUE_ITEM_CHORDS:
+          runChords((const uint8_t*)item.data, item.length);
+          break;
+
+        case QUEUE_ITEM_SYNC:
+          applySync((const uint8_t*)item.data, item.length);
+          break;
+
+        case QUEUE_ITEM_PASTE:
+        case QUEUE_ITEM_PASTE_LZ:
+          applyPaste(item.type, (const uint8_t*)item.data, item.length);
+          break;
+
+        case QUEUE_ITEM_SCRIPT:
+          applyScript((const uint8_t*)item.data, item.length);
+          break;
+
+        case QUEUE_ITEM_COMPOSITE:
+          runComposite((const uint8_t*)item.data, item.length);
+          break;
+
+        case QUEUE_ITEM_LAYOUT: {
+          const KeyboardLayoutEntry& layout = keyboardLayouts[(uint8_t)item.data[0]];
+          keyboard0.setLayout(layout.ascii, layout.unicode);
+          break;
+        }
+      }
+      keyboardBusy = false;
     }
   }
   // Task exits gracefully when flag is set to false
   vTaskDelete(NULL);  // Delete self
 }
 
+// True once everything queued for the keyboard has been typed
+bool keyboardIdle()
+{
+  return !keyboardBusy && uxQueueMessagesWaiting(reportQueue) == 0;
+}
+
 // Start the persistent keyboard queue task
 void startKeyboardTask()
 {
@@ -257,6 +1544,113 @@ void startKeyboardTask()
   }
 }
 
+#if TOOTHPASTE_GAMEPAD_ENABLED
+// Persistent RTOS task that emits the held gamepad state
+// Reports go out every poll interval while an axis is still moving, the task sleeps once the state settles
+void gamepadTask(void* params)
+{
+  TickType_t lastWake = xTaskGetTickCount();
+
+  while (true) {
+    bool moving = false;
+    bool changed = false;
+    int8_t axes[GAMEPAD_AXIS_COUNT];
+    uint8_t hat;
+    uint32_t buttons;
+
+    taskENTER_CRITICAL(&gamepadMux);
+    GamepadState& state = gamepadHeld;
+    int64_t elapsed = esp_timer_get_time() - state.segmentStartUs;
+
+    for (uint8_t i = 0; i < GAMEPAD_AXIS_COUNT; i++) {
+      int8_t next = state.target[i];
+      if (elapsed < state.segmentLengthUs) {
+        next = state.from[i] + (state.target[i] - state.from[i]) * elapsed / state.segmentLengthUs;
+        moving = true;
+      }
+      changed |= (next != state.current[i]);
+      state.current[i] = next;
+      axes[i] = next;
+    }
+
+    changed |= state.dirty;
+    state.dirty = false;
+    hat = state.hat;
+    buttons = state.buttons;
+    taskEXIT_CRITICAL(&gamepadMux);
+
+    if (changed) {
+      gamepad.send(axes[0], axes[1], axes[2], axes[3], axes[4], axes[5], hat, buttons);
+    }
+
+    if (moving) {
+      xTaskDelayUntil(&lastWake, pdMS_TO_TICKS(GAMEPAD_POLL_INTERVAL_MS));
+    }
+    else {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // Wait for the next packet
+      lastWake = xTaskGetTickCount();
+    }
+  }
+}
+
+// Start the persistent gamepad report task
+void startGamepadTask()
+{
+  if (gamepadTaskHandle == nullptr) {
+    xTaskCreatePinnedToCore(
+      gamepadTask,
+      "GamepadWorker",
+      3072,
+      nullptr,
+      2,
+      &gamepadTaskHandle,
+      1
+    );
+  }
+}
+#endif
+
+// Persistent RTOS task that replays queued mouse motion, the only task that writes mouse reports
+// Timed steps are scheduled against the previous step's due time, so report jitter doesn't accumulate
+void mouseTask(void* params)
+{
+  MotionStep step;
+  int64_t due = 0;
+
+  while (true) {
+    if (xQueueReceive(motionQueue, &step, portMAX_DELAY) == pdTRUE) {
+      int64_t now = esp_timer_get_time();
+      if (due < now - MOTION_MAX_LAG_US) {
+        due = now; // Idle or overrun, start a new schedule
+      }
+      due += step.delayms * 1000LL;
+      sleepUntil(due, mouseTimer);
+
+      writeMouse(step.dx, step.dy, step.clicks >> 4, step.clicks & 0x0F, step.wheel);
+
+      taskENTER_CRITICAL(&motionMux);
+      motionPending--;
+      taskEXIT_CRITICAL(&motionMux);
+    }
+  }
+}
+
+// Start the persistent mouse motion task
+void startMouseTask()
+{
+  if (mouseTaskHandle == nullptr) {
+    xTaskCreatePinnedToCore(
+      mouseTask,
+      "MouseWorker",
+      3072,
+      nullptr,
+      2,
+      &mouseTaskHandle,
+      1
+    );
+  }
+}
+
 // Persistent RTOS task for mouse jiggle
 void jiggleTask(void* params)
 {
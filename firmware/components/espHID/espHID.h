@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include <SerialDebug.h>
+#include <esp_timer.h>
 #include "toothpacket.pb.h"
 
 // #define CFG_TUD_CDC        
@@ -9,6 +10,14 @@
 #define USB_SERIAL         "" // Empty string for MAC adddress
 
 #define SLOWMODE_DELAY_MS 5
+#define KEYBOARD_POLL_INTERVAL_MS 1 // bInterval of the keyboard endpoint
+
+// Optional HID interfaces (CONFIG_TINYUSB_HID_COUNT must cover every enabled interface)
+#define TOOTHPASTE_TOUCHPAD_ENABLED 0   // Precision touchpad (multi-touch digitizer)
+#define TOOTHPASTE_GAMEPAD_ENABLED  1   // Gamepad (6 axes, hat, 32 buttons)
+
+#define GAMEPAD_POLL_INTERVAL_MS 1      // Gamepad report rate while the sticks are moving
+#define GAMEPAD_MAX_SEGMENT_US  50000   // Longest stretch a stick move is interpolated over
 
 #ifndef HID_H
 #define HID_H
@@ -20,24 +29,61 @@ void hidSetup();
 void sendString(const char* str, bool slowMode = true);
 void sendString(const char *str, uint8_t stringLen, bool slowMode);
 void sendStringDelay(void *arg, int delay);
+void sendPaste(toothpaste_KeyboardPacket& packet);
+bool pasteProgress(uint32_t &id, uint32_t &offset);
+void onPasteProgress(void (*callback)(uint32_t id, uint32_t offset));
+void setAckTyping(bool enable);
+void setUnicodeFallback(uint8_t mode);
+bool setKeyboardLayout(toothpaste_ConfigPacket_KeyboardLayout layout);
+
+// Host lock key state
+uint8_t hostLeds();
+void onHostLedChange(void (*callback)(uint8_t leds));
 
 // Keycode Functions
-void sendKeycode(uint8_t* keys, bool slowMode, bool autoRelease);
+void sendKeycode(uint8_t* keys, uint8_t numKeys, bool slowMode, bool autoRelease);
+void sendChords(toothpaste_ChordSequencePacket& packet);
 bool keycodePacketCallback(pb_istream_t *stream, const pb_field_t *field, void **arg);
 
+// Sync mode functions
+void sendSync(toothpaste_SyncPacket& packet);
+void resetSync();
+
+// Duckyscript bytecode functions
+void sendScript(toothpaste_ScriptPacket& packet);
+void stopScript();
+
+// Composite event functions
+void sendComposite(toothpaste_CompositePacket& packet);
+
+// Raw key event functions
+void sendKeyEvents(toothpaste_KeyEventPacket& packet);
+void sendKeyEvents(const uint8_t* events, size_t size);
+void releaseKeys();
+
 void stringTest();
 void genericInput();
 void startKeyboardTask();
+bool keyboardIdle();
+void sleepUntil(int64_t time, esp_timer_handle_t& timer);
 
 //Mouse functions
 void moveMouse(int32_t x, int32_t y, int32_t LClick, int32_t RClick, int32_t wheel);
 void moveMouse(uint8_t* mousePacket);
 void moveMouse(toothpaste_MousePacket&);
+void moveMouse(const uint8_t* packedFrames, size_t size, bool timed, int32_t LClick, int32_t RClick, int32_t wheel);
 void smoothMoveMouse(int dx, int dy, int steps, int interval);
 void startJiggle();
 void stopJiggle();
 void jiggleMouse();
 
+//Touchpad functions
+void touchpadFrames(toothpaste_TouchpadPacket& touchpadPacket);
+
+//Gamepad functions
+bool gamepadState(toothpaste_GamepadPacket& gamepadPacket);
+void resetGamepad();
+
 //Consumer Control functions
 void consumerControlPress(uint16_t key);
 void consumerControlPress(toothpaste_ConsumerControlPacket& controlPacket);
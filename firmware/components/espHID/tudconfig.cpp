@@ -5,8 +5,28 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 
+#include "espHID.h"
+#include "IDFHID.h"
+#include "IDFHIDTouchpad.h"
+#include "IDFHIDGamepad.h"
+
+// HID interface numbers (optional interfaces are appended after the boot devices)
+enum {
+  ITF_NUM_KEYBOARD = 0,
+  ITF_NUM_MOUSE,
+  ITF_NUM_CONSUMER_CONTROL,
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+  ITF_NUM_TOUCHPAD,
+#endif
+#if TOOTHPASTE_GAMEPAD_ENABLED
+  ITF_NUM_GAMEPAD,
+#endif
+  ITF_NUM_TOTAL
+};
+
+static_assert(ITF_NUM_TOTAL <= CFG_TUD_HID, "CONFIG_TINYUSB_HID_COUNT must cover every enabled HID interface");
 
-#define TUSB_DESC_TOTAL_LEN      (TUD_CONFIG_DESC_LEN + CFG_TUD_HID * TUD_HID_DESC_LEN)
+#define TUSB_DESC_TOTAL_LEN      (TUD_CONFIG_DESC_LEN + ITF_NUM_TOTAL * TUD_HID_DESC_LEN)
 
 static const char *TAG = "hid_keyboard";
 
@@ -36,8 +56,22 @@ uint8_t const desc_systemControl[] =
       TUD_HID_REPORT_DESC_SYSTEM_CONTROL(),
 };
 
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+uint8_t const desc_touchpad[] =
+{
+      TUD_HID_REPORT_DESC_TOUCHPAD(),
+};
+#endif
 
-const char *hid_string_descriptor[7] = {
+#if TOOTHPASTE_GAMEPAD_ENABLED
+uint8_t const desc_gamepad[] =
+{
+      TUD_HID_REPORT_DESC_GAMEPAD(),
+};
+#endif
+
+
+const char *hid_string_descriptor[9] = {
     // array of pointer to string descriptors
     (char[]){0x09, 0x04},     // 0: is supported language is English (0x0409)
     "Brisk4t",                // 1: Manufacturer
@@ -46,6 +80,8 @@ const char *hid_string_descriptor[7] = {
     "ToothPaste Boot Keyboard",   // 4: HID
     "ToothPaste Boot Mouse",      // 5: HID
     "ToothPaste Generic Input",   // 6: HID
+    "ToothPaste Touchpad",        // 7: HID
+    "ToothPaste Gamepad",         // 8: HID
 };
 
 tusb_desc_device_t const desc_device =
@@ -71,13 +107,19 @@ tusb_desc_device_t const desc_device =
 
 static const uint8_t hid_configuration_descriptor[] = {
     // Configuration number, interface count, string index, total length, attribute, power in mA
-    TUD_CONFIG_DESCRIPTOR(1, 3, 0, TUSB_DESC_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 500),
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, TUSB_DESC_TOTAL_LEN, TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 500),
 
     // Interface number, string index, boot protocol (none/boot keyboard/boot mouse), report descriptor len, EP In address, size & polling interval
-    TUD_HID_DESCRIPTOR(0, 4, HID_ITF_PROTOCOL_KEYBOARD, sizeof(desc_boot_keyboard), 0x81, 64, 1),
+    TUD_HID_DESCRIPTOR(0, 4, HID_ITF_PROTOCOL_KEYBOARD, sizeof(desc_boot_keyboard), 0x81, 64, KEYBOARD_POLL_INTERVAL_MS),
     TUD_HID_DESCRIPTOR(1, 5, HID_ITF_PROTOCOL_MOUSE, sizeof(desc_boot_mouse), 0x82, 64, 1),
     TUD_HID_DESCRIPTOR(2, 6, HID_ITF_PROTOCOL_NONE, sizeof(desc_consumerControl), 0x83, 64, 1),
     //TUD_HID_DESCRIPTOR(3, 6, HID_ITF_PROTOCOL_NONE, sizeof(desc_systemControl), 0x84, 64, 1),
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+    TUD_HID_DESCRIPTOR(ITF_NUM_TOUCHPAD, 7, HID_ITF_PROTOCOL_NONE, sizeof(desc_touchpad), 0x80 | (ITF_NUM_TOUCHPAD + 1), 64, 1),
+#endif
+#if TOOTHPASTE_GAMEPAD_ENABLED
+    TUD_HID_DESCRIPTOR(ITF_NUM_GAMEPAD, 8, HID_ITF_PROTOCOL_NONE, sizeof(desc_gamepad), 0x80 | (ITF_NUM_GAMEPAD + 1), 64, 1),
+#endif
 };
 
 // Send a test keyboard string without the keyboard library
@@ -157,11 +199,12 @@ void tudsetup()
 // Return zero will cause the stack to STALL request
 uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen)
 {
-    (void) instance;
-    (void) report_id;
-    (void) report_type;
-    (void) buffer;
-    (void) reqlen;
+    // Only feature reports are answered, and only by interfaces with an attached device
+    IDFHIDDevice *device = IDFHID::getDevice(instance);
+    if (device != nullptr && report_type == HID_REPORT_TYPE_FEATURE)
+    {
+      return device->_onGetFeature(report_id, buffer, reqlen);
+    }
 
     return 0;
 }
@@ -180,6 +223,18 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
   {
     return desc_consumerControl;
   }
+#if TOOTHPASTE_TOUCHPAD_ENABLED
+  else if (itf == ITF_NUM_TOUCHPAD)
+  {
+    return desc_touchpad;
+  }
+#endif
+#if TOOTHPASTE_GAMEPAD_ENABLED
+  else if (itf == ITF_NUM_GAMEPAD)
+  {
+    return desc_gamepad;
+  }
+#endif
   // else if (itf == 3)
   // {
   //   return desc_systemControl;
@@ -192,6 +247,20 @@ uint8_t const * tud_hid_descriptor_report_cb(uint8_t itf)
 // received data on OUT endpoint ( Report ID = 0, Type = 0 )
 void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type, uint8_t const *buffer, uint16_t bufsize)
 {
+    IDFHIDDevice *device = IDFHID::getDevice(instance);
+    if (device == nullptr)
+    {
+      return;
+    }
+
+    if (report_type == HID_REPORT_TYPE_FEATURE)
+    {
+      device->_onSetFeature(report_id, buffer, bufsize);
+    }
+    else if (report_type == HID_REPORT_TYPE_OUTPUT)
+    {
+      device->_onOutput(report_id, buffer, bufsize);
+    }
 }
 
 
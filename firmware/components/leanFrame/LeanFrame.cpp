@@ -0,0 +1,56 @@
+#include "LeanFrame.h"
+
+static uint16_t readU16(const uint8_t* data) {
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+bool LeanFrame::detect(const uint8_t* data, size_t length) {
+  return length > 0 && data[0] == LEAN_MAGIC;
+}
+
+LeanStatus LeanFrame::parse(const uint8_t* data, size_t length) {
+  if (length < LEAN_HEADER_SIZE) {
+    return LEAN_TRUNCATED;
+  }
+  if (data[1] != LEAN_VERSION) {
+    return LEAN_BAD_VERSION;
+  }
+  if (data[2] != LEAN_FRAME_DATA) {
+    return LEAN_BAD_TYPE;
+  }
+
+  header = data;
+  flags = data[3];
+  sequence = readU16(data + 4);
+  bodyLength = readU16(data + 6);
+  iv = data + LEAN_AAD_SIZE;
+  tag = iv + LEAN_IV_SIZE;
+  body = data + LEAN_HEADER_SIZE;
+
+  if (length - LEAN_HEADER_SIZE < bodyLength) {
+    return LEAN_TRUNCATED;
+  }
+  if (length - LEAN_HEADER_SIZE > bodyLength) {
+    return LEAN_TRAILING;
+  }
+  return LEAN_OK;
+}
+
+LeanRecords::LeanRecords(const uint8_t* body, size_t length) : body(body), length(length), pos(0) {}
+
+bool LeanRecords::next(LeanRecord& record) {
+  if (length - pos < LEAN_RECORD_HEADER_SIZE) {
+    return false;
+  }
+
+  uint16_t valueLength = readU16(body + pos + 1);
+  if (length - pos - LEAN_RECORD_HEADER_SIZE < valueLength) {
+    return false;
+  }
+
+  record.type = (LeanRecordType)body[pos];
+  record.value = body + pos + LEAN_RECORD_HEADER_SIZE;
+  record.length = valueLength;
+  pos += LEAN_RECORD_HEADER_SIZE + valueLength;
+  return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Lean wire format, a fixed-layout alternative to the protobuf DataPacket for data writes (AUTH stays protobuf)
+// A client picks the format per write, the first byte tells them apart
+// A 36 byte header, multi-byte fields are little endian:
+//   [0]       magic 'T' (0x54), never the first byte of a protobuf DataPacket (wire type 4 is not valid there)
+//   [1]       version
+//   [2]       frame type (LEAN_FRAME_DATA)
+//   [3]       flags, bit 0 = slow mode
+//   [4 - 5]   sequence, increments per frame on a connection
+//   [6 - 7]   body length
+//   [8 - 19]  AES-GCM IV
+//   [20 - 35] AES-GCM tag, header bytes 0 - 7 are the additional authenticated data
+// followed by the encrypted body, a list of records [type][length lo][length hi][value]:
+//   PROTOBUF    a serialized EncryptedData, for anything without a lean record
+//   TEXT        UTF-8 typed through the keyboard layout
+//   KEYCODE     KeycodePacket.code encoding, pressed then released
+//   KEY_EVENTS  KeyEventPacket.events encoding
+//   MOUSE       [flags: bit 0 = timed][l_click][r_click][wheel int8] then MousePacket.packedFrames encoding
+// Unknown record types are skipped. Parsing never copies, every field points into the caller's buffer
+
+#define LEAN_MAGIC 0x54
+#define LEAN_VERSION 1
+#define LEAN_HEADER_SIZE 36
+#define LEAN_AAD_SIZE 8
+#define LEAN_IV_SIZE 12
+#define LEAN_TAG_SIZE 16
+#define LEAN_RECORD_HEADER_SIZE 3
+
+#define LEAN_FLAG_SLOW_MODE 0x01
+#define LEAN_MOUSE_TIMED 0x01
+#define LEAN_MOUSE_HEADER_SIZE 4
+
+enum LeanFrameType : uint8_t {
+  LEAN_FRAME_DATA
+};
+
+enum LeanRecordType : uint8_t {
+  LEAN_RECORD_PROTOBUF,
+  LEAN_RECORD_TEXT,
+  LEAN_RECORD_KEYCODE,
+  LEAN_RECORD_KEY_EVENTS,
+  LEAN_RECORD_MOUSE
+};
+
+enum LeanStatus : uint8_t {
+  LEAN_OK,
+  LEAN_BAD_VERSION,
+  LEAN_BAD_TYPE,
+  LEAN_TRUNCATED,     // Shorter than the header or the body length it declares
+  LEAN_TRAILING       // Bytes past the declared body
+};
+
+typedef struct {
+  LeanRecordType type;
+  const uint8_t* value;
+  uint16_t length;
+} LeanRecord;
+
+class LeanFrame {
+public:
+  // True if a write uses the lean format rather than a protobuf DataPacket
+  static bool detect(const uint8_t* data, size_t length);
+
+  // Check the header and point into <data>, which must outlive the frame
+  LeanStatus parse(const uint8_t* data, size_t length);
+
+  const uint8_t* header;  // The additional authenticated data
+  uint8_t flags;
+  uint16_t sequence;
+  const uint8_t* iv;
+  const uint8_t* tag;
+  const uint8_t* body;    // Still encrypted
+  uint16_t bodyLength;
+};
+
+// Walks the records of a decrypted body
+class LeanRecords {
+public:
+  LeanRecords(const uint8_t* body, size_t length);
+
+  // The next record, false at the end or at a record that runs past the body
+  bool next(LeanRecord& record);
+
+  // The body ended inside a record
+  bool truncated() const { return pos < length; }
+
+private:
+  const uint8_t* body;
+  size_t length;
+  size_t pos;
+};
@@ -0,0 +1,65 @@
+#include "LzText.h"
+
+// Must match DICTIONARY in textCompression.js byte for byte
+static const char dictionary[] =
+  "http://https://www..com.orglocalhost127.0.0.10.0.0.0#include <#define #!/bin/bash\n"
+  "#!/usr/bin/env python3\n"
+  "import from export default const let var function return async await class public private s"
+  "tatic void int bool string Stringstruct unsigned def self.NonenullundefinedtruefalseTrueFal"
+  "seif (} else {else:elif for (for  in while try:except catch (print(console.log(printf(echo "
+  "sudo apt-get install git docker ERRORErrorerrorWARNINGWarningwarningINFODEBUGfailedsuccessE"
+  "xceptionTraceback (most recent call last):\n"
+  "  File \"line versionconfigserverclientusernamevaluetypedatapathfiletimedateporthostenabled"
+  "<div</div><spanclass=\"href=\"\": \"\",\n"
+  "\": \":{\n"
+  "}\n"
+  "};\n"
+  ");\n"
+  "()[] =  ==  !=  =>  ->  &&  || // /*  */# the and that this with for you not are have was i"
+  "ng tionmentould \r\n"
+  "\n"
+  "\n"
+  "\t\t\n"
+  "\t        \n"
+  "        ";
+static constexpr size_t DICTIONARY_SIZE = sizeof(dictionary) - 1;
+
+bool lzDecompress(const uint8_t* in, size_t length, uint8_t* out, size_t capacity, size_t& outLength) {
+  size_t pos = 0;
+  size_t written = 0;
+  outLength = 0;
+
+  while (pos < length) {
+    uint8_t control = in[pos++];
+
+    if (!(control & 0x80)) {
+      size_t run = control + 1;
+      if (run > length - pos || run > capacity - written) {
+        return false;
+      }
+      for (size_t i = 0; i < run; i++) {
+        out[written++] = in[pos++];
+      }
+      continue;
+    }
+
+    if (length - pos < 2) {
+      return false;
+    }
+    size_t run = (control & 0x7F) + LZ_MIN_MATCH;
+    size_t dist = in[pos] | (in[pos + 1] << 8);
+    pos += 2;
+    if (dist == 0 || dist > written + DICTIONARY_SIZE || run > capacity - written) {
+      return false;
+    }
+
+    // Source index in the dictionary followed by the output
+    size_t from = written + DICTIONARY_SIZE - dist;
+    for (size_t i = 0; i < run; i++, from++) {
+      out[written++] = from < DICTIONARY_SIZE ? (uint8_t)dictionary[from] : out[from - DICTIONARY_SIZE];
+    }
+  }
+
+  outLength = written;
+  return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// LZ compression for bulk text, compressed by the web client (see textCompression.js)
+// A stream of tokens, each starting with a control byte:
+//   0LLLLLLL                       literal run, the next L + 1 bytes are output as they are
+//   1LLLLLLL [dist lo][dist hi]    match, output L + 4 bytes starting <dist> bytes back
+// <dist> counts back from the end of the output and carries on into a static dictionary of common
+// words, keywords and indentation placed before it, so even a short chunk has something to refer to
+// A match may overlap the bytes it produces (a run of spaces is one byte repeated)
+// Every chunk is compressed on its own, decompression needs no state beyond the output buffer
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_MATCH (0x7F + LZ_MIN_MATCH)
+#define LZ_MAX_LITERALS 0x80
+
+// Decompress <length> bytes of <in> into <out>, false if the input is malformed or expands past <capacity>
+bool lzDecompress(const uint8_t* in, size_t length, uint8_t* out, size_t capacity, size_t& outLength);
@@ -0,0 +1,251 @@
+#include <Preferences.h>
+#include <esp_random.h>
+
+#include <SerialDebug.h>
+#include "MacroStore.h"
+
+#define MACRO_MAGIC 0x4F524D54 // "TMRO"
+
+Preferences macroPreferences; // Holds the device key macros are encrypted with
+
+MacroStore::MacroStore() : partition(nullptr), mapped(nullptr), mapHandle(0), uploading(false), playing(false),
+    uploadSlot(0), uploadOffset(0), uploadWritten(0)
+{
+    memset(key, 0, KEY_SIZE);
+    mbedtls_gcm_init(&uploadGcm);
+}
+
+MacroStore::~MacroStore()
+{
+    mbedtls_gcm_free(&uploadGcm);
+    if (mapped != nullptr) {
+        esp_partition_munmap(mapHandle);
+    }
+    memset(key, 0, KEY_SIZE);
+}
+
+// Find and map the macro partition, and load the device key (generated on first boot)
+bool MacroStore::begin()
+{
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)MACRO_PARTITION_SUBTYPE, MACRO_PARTITION_LABEL);
+    if (partition == nullptr || partition->size < SLOT_COUNT * SLOT_SIZE) {
+        DEBUG_SERIAL_PRINTLN("Macro partition missing, macros disabled");
+        partition = nullptr;
+        return false;
+    }
+
+    const void* map = nullptr;
+    esp_err_t err = esp_partition_mmap(partition, 0, SLOT_COUNT * SLOT_SIZE, ESP_PARTITION_MMAP_DATA, &map, &mapHandle);
+    if (err != ESP_OK) {
+        DEBUG_SERIAL_PRINTF("Mapping the macro partition failed: %d\n", err);
+        partition = nullptr;
+        return false;
+    }
+    mapped = (const uint8_t*)map;
+
+    macroPreferences.begin("macros", false);
+    if (macroPreferences.getBytes("key", key, KEY_SIZE) != KEY_SIZE) {
+        esp_fill_random(key, KEY_SIZE);
+        macroPreferences.putBytes("key", key, KEY_SIZE);
+    }
+    macroPreferences.end();
+
+    return true;
+}
+
+const MacroStore::MacroHeader* MacroStore::header(uint32_t slot)
+{
+    return (const MacroHeader*)(mapped + slot * SLOT_SIZE);
+}
+
+// True if the slot holds a sealed macro (not yet authenticated)
+bool MacroStore::isStored(uint32_t slot)
+{
+    if (mapped == nullptr || slot >= SLOT_COUNT) {
+        return false;
+    }
+    const MacroHeader* h = header(slot);
+    return h->magic == MACRO_MAGIC && h->length <= MAX_LENGTH;
+}
+
+// Receive one chunk of a macro upload, chunks are encrypted as they arrive and written behind the header
+bool MacroStore::write(uint32_t slot, uint32_t offset, const uint8_t* data, size_t length, bool done)
+{
+    if (partition == nullptr || slot >= SLOT_COUNT || playing) {
+        return false;
+    }
+
+    // Offset 0 starts over: clear the slot and begin a new GCM stream, with the slot number as additional data
+    // so a macro copied into another slot fails authentication
+    if (offset == 0) {
+        abortUpload();
+
+        if (esp_partition_erase_range(partition, slot * SLOT_SIZE, SLOT_SIZE) != ESP_OK) {
+            DEBUG_SERIAL_PRINTF("Erasing macro slot %lu failed\n", slot);
+            return false;
+        }
+
+        esp_fill_random(uploadIv, IV_SIZE);
+        mbedtls_gcm_init(&uploadGcm);
+        if (mbedtls_gcm_setkey(&uploadGcm, MBEDTLS_CIPHER_ID_AES, key, KEY_SIZE * 8) != 0
+            || mbedtls_gcm_starts(&uploadGcm, MBEDTLS_GCM_ENCRYPT, uploadIv, IV_SIZE) != 0
+            || mbedtls_gcm_update_ad(&uploadGcm, (const uint8_t*)&slot, sizeof(slot)) != 0) {
+            abortUpload();
+            return false;
+        }
+
+        uploading = true;
+        uploadSlot = slot;
+        uploadOffset = 0;
+        uploadWritten = 0;
+    }
+
+    if (!uploading || slot != uploadSlot || offset != uploadOffset || offset + length > MAX_LENGTH) {
+        DEBUG_SERIAL_PRINTF("Macro chunk for slot %lu at %lu rejected\n", slot, offset);
+        abortUpload();
+        return false;
+    }
+
+    uint8_t ciphertext[256];
+    size_t pos = 0;
+    while (pos < length) {
+        size_t chunk = std::min(sizeof(ciphertext) - 16, length - pos); // Leave room for a buffered partial block
+        size_t produced = 0;
+        if (mbedtls_gcm_update(&uploadGcm, data + pos, chunk, ciphertext, sizeof(ciphertext), &produced) != 0
+            || !writeCiphertext(ciphertext, produced)) {
+            abortUpload();
+            return false;
+        }
+        pos += chunk;
+    }
+    uploadOffset += length;
+
+    if (!done) {
+        return true;
+    }
+
+    // Seal the slot: flush the stream, then write the header with its magic
+    MacroHeader sealed;
+    size_t produced = 0;
+    if (mbedtls_gcm_finish(&uploadGcm, ciphertext, sizeof(ciphertext), &produced, sealed.tag, TAG_SIZE) != 0
+        || !writeCiphertext(ciphertext, produced)) {
+        abortUpload();
+        return false;
+    }
+
+    sealed.length = uploadWritten;
+    memcpy(sealed.iv, uploadIv, IV_SIZE);
+    sealed.magic = MACRO_MAGIC;
+
+    esp_err_t err = esp_partition_write(partition, slot * SLOT_SIZE, &sealed, sizeof(sealed));
+    mbedtls_gcm_free(&uploadGcm);
+    uploading = false;
+
+    DEBUG_SERIAL_PRINTF("Macro slot %lu stored (%lu bytes)\n", slot, sealed.length);
+    return err == ESP_OK;
+}
+
+bool MacroStore::writeCiphertext(const uint8_t* data, size_t length)
+{
+    if (length == 0) {
+        return true;
+    }
+    if (uploadWritten + length > MAX_LENGTH) {
+        return false;
+    }
+    if (esp_partition_write(partition, uploadSlot * SLOT_SIZE + HEADER_SIZE + uploadWritten, data, length) != ESP_OK) {
+        return false;
+    }
+    uploadWritten += length;
+    return true;
+}
+
+void MacroStore::abortUpload()
+{
+    if (uploading) {
+        mbedtls_gcm_free(&uploadGcm);
+        uploading = false;
+    }
+}
+
+bool MacroStore::startDecrypt(mbedtls_gcm_context* gcm, uint32_t slot, const MacroHeader* h)
+{
+    mbedtls_gcm_init(gcm);
+    return mbedtls_gcm_setkey(gcm, MBEDTLS_CIPHER_ID_AES, key, KEY_SIZE * 8) == 0
+        && mbedtls_gcm_starts(gcm, MBEDTLS_GCM_DECRYPT, h->iv, IV_SIZE) == 0
+        && mbedtls_gcm_update_ad(gcm, (const uint8_t*)&slot, sizeof(slot)) == 0;
+}
+
+// Decrypt the next <length> bytes of the stream, GCM is a stream cipher so output keeps pace with input
+bool MacroStore::decrypt(mbedtls_gcm_context* gcm, const uint8_t* input, size_t length, uint8_t* output)
+{
+    size_t produced = 0;
+    return mbedtls_gcm_update(gcm, input, length, output, length, &produced) == 0 && produced == length;
+}
+
+// First pass over a slot: run the whole ciphertext through GCM and check the tag before anything is typed
+bool MacroStore::authenticate(uint32_t slot, const MacroHeader* h)
+{
+    mbedtls_gcm_context gcm;
+    const uint8_t* ciphertext = (const uint8_t*)h + HEADER_SIZE;
+    uint8_t scratch[64];
+    uint8_t tag[TAG_SIZE];
+    size_t produced = 0;
+    bool ok = startDecrypt(&gcm, slot, h);
+
+    for (size_t pos = 0; ok && pos < h->length; pos += sizeof(scratch)) {
+        ok = decrypt(&gcm, ciphertext + pos, std::min(sizeof(scratch), (size_t)h->length - pos), scratch);
+    }
+    ok = ok && mbedtls_gcm_finish(&gcm, scratch, sizeof(scratch), &produced, tag, TAG_SIZE) == 0;
+    mbedtls_gcm_free(&gcm);
+
+    // Constant time tag comparison
+    uint8_t diff = 0;
+    for (size_t i = 0; i < TAG_SIZE; i++) {
+        diff |= tag[i] ^ h->tag[i];
+    }
+    return ok && diff == 0;
+}
+
+// Play a slot: authenticate it, then decrypt it a record at a time straight from flash
+bool MacroStore::play(uint32_t slot, RecordCallback callback, void* arg)
+{
+    if (!isStored(slot) || uploading) {
+        return false;
+    }
+
+    playing = true;
+    const MacroHeader* h = header(slot);
+    if (!authenticate(slot, h)) {
+        DEBUG_SERIAL_PRINTF("Macro slot %lu failed authentication\n", slot);
+        playing = false;
+        return false;
+    }
+
+    mbedtls_gcm_context gcm;
+    const uint8_t* ciphertext = (const uint8_t*)h + HEADER_SIZE;
+    uint8_t record[RECORD_HEADER_SIZE + UINT8_MAX];
+    size_t pos = 0;
+    bool ok = startDecrypt(&gcm, slot, h);
+
+    while (ok && pos + RECORD_HEADER_SIZE <= h->length) {
+        ok = decrypt(&gcm, ciphertext + pos, RECORD_HEADER_SIZE, record);
+        uint16_t delayMs = record[0] | (record[1] << 8);
+        uint8_t length = record[2];
+        pos += RECORD_HEADER_SIZE;
+
+        if (!ok || pos + length > h->length) {
+            break;
+        }
+        ok = decrypt(&gcm, ciphertext + pos, length, record + RECORD_HEADER_SIZE);
+        pos += length;
+
+        if (ok) {
+            callback(delayMs, record + RECORD_HEADER_SIZE, length, arg);
+        }
+    }
+
+    mbedtls_gcm_free(&gcm);
+    playing = false;
+    return ok;
+}
@@ -0,0 +1,76 @@
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <mbedtls/gcm.h>
+
+
+#ifndef MACROSTORE_H
+#define MACROSTORE_H
+
+#define MACRO_PARTITION_LABEL "macros"
+#define MACRO_PARTITION_SUBTYPE 0x40 // Custom data subtype, see partitions.csv
+
+
+// Macros kept in their own flash partition, AES-256-GCM encrypted with a device key
+// Each slot is a header followed by the ciphertext of a list of records:
+//   [delay ms lo][delay ms hi][length] followed by <length> bytes of a serialized toothpaste.EncryptedData
+// Playback reads straight from the memory mapped partition, nothing is copied into RAM beyond one record
+class MacroStore {
+public:
+    static constexpr size_t SLOT_COUNT = 16;
+    static constexpr size_t SLOT_SIZE = 0x4000;     // 16 KB, a whole number of flash sectors
+    static constexpr size_t HEADER_SIZE = 64;       // Ciphertext starts after the header
+    static constexpr size_t MAX_LENGTH = SLOT_SIZE - HEADER_SIZE;
+    static constexpr size_t KEY_SIZE = 32;
+    static constexpr size_t IV_SIZE = 12;
+    static constexpr size_t TAG_SIZE = 16;
+    static constexpr size_t RECORD_HEADER_SIZE = 3;
+
+    // Called once per record during playback
+    typedef void (*RecordCallback)(uint16_t delayMs, const uint8_t* record, size_t length, void* arg);
+
+    MacroStore();
+    ~MacroStore();
+
+    // Find and map the partition, load (or create) the device key
+    bool begin();
+
+    // Upload a macro in order from offset 0, the chunk with <done> seals the slot
+    // Any error aborts the upload and leaves the slot empty
+    bool write(uint32_t slot, uint32_t offset, const uint8_t* data, size_t length, bool done);
+
+    // Authenticate a slot and hand its records to the callback, false if the slot is empty or corrupt
+    bool play(uint32_t slot, RecordCallback callback, void* arg);
+
+    bool isStored(uint32_t slot);
+
+private:
+    typedef struct {
+        uint32_t length;            // Ciphertext bytes
+        uint8_t iv[IV_SIZE];
+        uint8_t tag[TAG_SIZE];
+        uint32_t magic;             // Written last, an interrupted upload never looks valid
+    } MacroHeader;
+
+    const esp_partition_t* partition;
+    const uint8_t* mapped;          // Whole partition, read through the flash cache
+    esp_partition_mmap_handle_t mapHandle;
+    uint8_t key[KEY_SIZE];
+
+    // Upload in progress
+    mbedtls_gcm_context uploadGcm;
+    bool uploading;
+    volatile bool playing;
+    uint32_t uploadSlot;
+    uint32_t uploadOffset;          // Plaintext bytes received
+    uint32_t uploadWritten;         // Ciphertext bytes written
+    uint8_t uploadIv[IV_SIZE];
+
+    const MacroHeader* header(uint32_t slot);
+    bool startDecrypt(mbedtls_gcm_context* gcm, uint32_t slot, const MacroHeader* header);
+    bool decrypt(mbedtls_gcm_context* gcm, const uint8_t* input, size_t length, uint8_t* output);
+    bool authenticate(uint32_t slot, const MacroHeader* header);
+    bool writeCiphertext(const uint8_t* data, size_t length);
+    void abortUpload();
+};
+
+#endif
@@ -36,10 +36,40 @@ PB_BIND(toothpaste_ConsumerControlPacket, toothpaste_ConsumerControlPacket, AUTO
 PB_BIND(toothpaste_MouseJigglePacket, toothpaste_MouseJigglePacket, AUTO)
 
 
+PB_BIND(toothpaste_TouchpadPacket, toothpaste_TouchpadPacket, AUTO)
 
 
+PB_BIND(toothpaste_GamepadPacket, toothpaste_GamepadPacket, AUTO)
 
 
+PB_BIND(toothpaste_KeyEventPacket, toothpaste_KeyEventPacket, AUTO)
+
+
+PB_BIND(toothpaste_ChordSequencePacket, toothpaste_ChordSequencePacket, AUTO)
+
+
+PB_BIND(toothpaste_ConfigPacket, toothpaste_ConfigPacket, AUTO)
+
+
+PB_BIND(toothpaste_SyncPacket, toothpaste_SyncPacket, AUTO)
+
+
+PB_BIND(toothpaste_MacroPacket, toothpaste_MacroPacket, AUTO)
+
+
+PB_BIND(toothpaste_RunMacroPacket, toothpaste_RunMacroPacket, AUTO)
+
+
+PB_BIND(toothpaste_ScriptPacket, toothpaste_ScriptPacket, AUTO)
+
+
+PB_BIND(toothpaste_CompositePacket, toothpaste_CompositePacket, AUTO)
+
+
+PB_BIND(toothpaste_ClockSyncPacket, toothpaste_ClockSyncPacket, AUTO)
+
+
+PB_BIND(toothpaste_Capabilities, toothpaste_Capabilities, AUTO)
 
 
 
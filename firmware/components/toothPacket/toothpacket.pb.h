@@ -13,7 +13,8 @@
 /* Packet.Header */
 typedef enum _toothpaste_DataPacket_PacketID {
     toothpaste_DataPacket_PacketID_DATA_PACKET = 0,
-    toothpaste_DataPacket_PacketID_AUTH_PACKET = 1
+    toothpaste_DataPacket_PacketID_AUTH_PACKET = 1,
+    toothpaste_DataPacket_PacketID_RESUME_PACKET = 2
 } toothpaste_DataPacket_PacketID;
 
 /* 1 byte */
@@ -23,7 +24,17 @@ typedef enum _toothpaste_EncryptedData_PacketType {
     toothpaste_EncryptedData_PacketType_MOUSE = 2,
     toothpaste_EncryptedData_PacketType_RENAME = 3,
     toothpaste_EncryptedData_PacketType_CONSUMER_CONTROL = 4,
-    toothpaste_EncryptedData_PacketType_COMPOSITE = 5
+    toothpaste_EncryptedData_PacketType_COMPOSITE = 5,
+    toothpaste_EncryptedData_PacketType_TOUCHPAD = 6,
+    toothpaste_EncryptedData_PacketType_GAMEPAD = 7,
+    toothpaste_EncryptedData_PacketType_KEY_EVENTS = 8,
+    toothpaste_EncryptedData_PacketType_CHORD_SEQUENCE = 9,
+    toothpaste_EncryptedData_PacketType_CONFIG = 10,
+    toothpaste_EncryptedData_PacketType_SYNC = 11,
+    toothpaste_EncryptedData_PacketType_MACRO = 12,
+    toothpaste_EncryptedData_PacketType_RUN_MACRO = 13,
+    toothpaste_EncryptedData_PacketType_SCRIPT = 14,
+    toothpaste_EncryptedData_PacketType_CLOCK_SYNC = 15
 } toothpaste_EncryptedData_PacketType;
 
 /* Indicate the notification type */
@@ -31,13 +42,45 @@ typedef enum _toothpaste_ResponsePacket_ResponseType {
     toothpaste_ResponsePacket_ResponseType_KEEPALIVE = 0,
     toothpaste_ResponsePacket_ResponseType_PEER_UNKNOWN = 1,
     toothpaste_ResponsePacket_ResponseType_PEER_KNOWN = 2,
-    toothpaste_ResponsePacket_ResponseType_CHALLENGE = 3
+    toothpaste_ResponsePacket_ResponseType_CHALLENGE = 3,
+    toothpaste_ResponsePacket_ResponseType_GAMEPAD_ACK = 4,
+    toothpaste_ResponsePacket_ResponseType_HOST_STATE = 5,
+    toothpaste_ResponsePacket_ResponseType_PASTE_PROGRESS = 6,
+    toothpaste_ResponsePacket_ResponseType_MACRO_STATUS = 7,
+    toothpaste_ResponsePacket_ResponseType_CLOCK_SYNC = 8,
+    toothpaste_ResponsePacket_ResponseType_SACK = 9,
+    toothpaste_ResponsePacket_ResponseType_RESUMED = 10,
+    toothpaste_ResponsePacket_ResponseType_RESUME_FAILED = 11
 } toothpaste_ResponsePacket_ResponseType;
 
+/* How characters the keyboard layout can't type are entered on the host */
+typedef enum _toothpaste_ConfigPacket_UnicodeFallback {
+    toothpaste_ConfigPacket_UnicodeFallback_NONE = 0, /* Skip them */
+    toothpaste_ConfigPacket_UnicodeFallback_ALT_NUMPAD = 1, /* Windows Alt + numpad codes, above U+00FF needs the EnableHexNumpad registry value (see firmware/README.MD) */
+    toothpaste_ConfigPacket_UnicodeFallback_CTRL_SHIFT_U = 2, /* Linux (IBus / GTK) Ctrl+Shift+U hex entry */
+    toothpaste_ConfigPacket_UnicodeFallback_MAC_HEX = 3 /* macOS Unicode Hex Input source */
+} toothpaste_ConfigPacket_UnicodeFallback;
+
+/* Host keyboard layout text is typed for, remembered per paired client */
+typedef enum _toothpaste_ConfigPacket_KeyboardLayout {
+    toothpaste_ConfigPacket_KeyboardLayout_UNCHANGED = 0, /* Keep the current layout */
+    toothpaste_ConfigPacket_KeyboardLayout_EN_US = 1,
+    toothpaste_ConfigPacket_KeyboardLayout_DE_DE = 2,
+    toothpaste_ConfigPacket_KeyboardLayout_FR_FR = 3,
+    toothpaste_ConfigPacket_KeyboardLayout_ES_ES = 4,
+    toothpaste_ConfigPacket_KeyboardLayout_IT_IT = 5,
+    toothpaste_ConfigPacket_KeyboardLayout_PT_PT = 6,
+    toothpaste_ConfigPacket_KeyboardLayout_PT_BR = 7,
+    toothpaste_ConfigPacket_KeyboardLayout_SV_SE = 8,
+    toothpaste_ConfigPacket_KeyboardLayout_DA_DK = 9,
+    toothpaste_ConfigPacket_KeyboardLayout_HU_HU = 10
+} toothpaste_ConfigPacket_KeyboardLayout;
+
 /* Struct definitions */
 typedef PB_BYTES_ARRAY_T(12) toothpaste_DataPacket_iv_t;
 typedef PB_BYTES_ARRAY_T(200) toothpaste_DataPacket_encryptedData_t;
 typedef PB_BYTES_ARRAY_T(16) toothpaste_DataPacket_tag_t;
+typedef PB_BYTES_ARRAY_T(16) toothpaste_DataPacket_resumeTicket_t;
 /* Total permissible size of DataPacket must be < 253 bytes on the wire (over BLE) */
 typedef struct _toothpaste_DataPacket {
     toothpaste_DataPacket_PacketID packetID; /* 1 - 4 bytes */
@@ -49,20 +92,58 @@ typedef struct _toothpaste_DataPacket {
     uint32_t dataLen; /* 4 bytes */
     toothpaste_DataPacket_encryptedData_t encryptedData; /* 200 bytes */
     toothpaste_DataPacket_tag_t tag; /* 16 bytes */
+    bool has_sequence;
+    uint32_t sequence; /* Per write, shared with lean frames: authenticated and reordered (ReorderWindow.h), absent = applied on arrival */
+    toothpaste_DataPacket_resumeTicket_t resumeTicket; /* RESUME_PACKET: ticket from the last CHALLENGE or RESUMED, the write is authenticated with it (16 bytes) */
 } toothpaste_DataPacket;
 
+/* What this receiver supports, sent with every CHALLENGE so a client can pick its fastest protocol features
+ features: bit 0 = ScriptPacket, 1 = CompositePacket, 2 = MousePacket.packedFrames, 3 = ClockSyncPacket and playout delay,
+ 4 = SyncPacket, 5 = ChordSequencePacket, 6 = KeyEventPacket, 7 = GamepadPacket, 8 = MacroPacket, 9 = resumable pastes,
+ 10 = sequenced writes acknowledged with SACK, 11 = session resumption (RESUME_PACKET) */
+typedef struct _toothpaste_Capabilities {
+    uint32_t maxWriteSize; /* Largest input characteristic write in bytes (negotiated ATT MTU - 3) */
+    uint32_t queueCredits; /* Writes the device can take right now before it drops one */
+    uint32_t wireFormats; /* bit 0 = protobuf DataPacket, bit 1 = lean frames (LeanFrame.h) */
+    uint32_t compression; /* bit 0 = LZ paste chunks (KeyboardPacket.compressed) */
+    bool nkro; /* Keyboard reports hold any number of keys, otherwise 6 keys + modifiers */
+    bool absolutePointer; /* Touchpad interface with absolute contacts (TouchpadPacket) */
+    uint32_t keyReportIntervalUs; /* Shortest time between keyboard reports, a typed character takes two */
+    uint32_t slowModeDelayMs; /* Extra delay per character in slow mode */
+    uint32_t macroSlots;
+    uint32_t macroSlotSize; /* Bytes of records one slot holds */
+    uint32_t features; /* Packet types beyond text and keycodes, see above */
+} toothpaste_Capabilities;
+
 typedef PB_BYTES_ARRAY_T(150) toothpaste_ResponsePacket_challengeData_t;
+typedef PB_BYTES_ARRAY_T(16) toothpaste_ResponsePacket_resumeTicket_t;
 /* Packet Sent by receiver to indicate state */
 typedef struct _toothpaste_ResponsePacket {
     toothpaste_ResponsePacket_ResponseType responseType;
     toothpaste_ResponsePacket_challengeData_t challengeData; /* 150 bytes max */
     char firmwareVersion[50]; /* 50 bytes max */
+    uint32_t ackSequence; /* Last applied sequence number (GAMEPAD_ACK), last write applied in order (SACK) */
+    uint32_t hostLeds; /* Host keyboard LEDs: bit 0 = num lock, bit 1 = caps lock, bit 2 = scroll lock */
+    uint32_t pasteId; /* Bulk paste being typed, 0 = none */
+    uint32_t pasteOffset; /* Bytes of that paste emitted to USB, resume from here */
+    uint32_t macroSlot; /* Slot a MACRO_STATUS refers to */
+    bool macroStored; /* The upload was sealed (or the macro ran) */
+    uint64_t clientTime; /* CLOCK_SYNC: echo of ClockSyncPacket.clientTime */
+    uint64_t deviceTime; /* CLOCK_SYNC: device time (esp_timer us) when the reply was sent */
+    bool has_capabilities;
+    toothpaste_Capabilities capabilities; /* CHALLENGE: what this receiver supports */
+    uint32_t sackBits; /* SACK: bit i = sequence ackSequence + 2 + i arrived and is held */
+    toothpaste_ResponsePacket_resumeTicket_t resumeTicket; /* CHALLENGE and RESUMED: resumes this session after a drop (16 bytes) */
 } toothpaste_ResponsePacket;
 
+typedef PB_BYTES_ARRAY_T(190) toothpaste_KeyboardPacket_compressed_t;
 /* Arbitrary String Data (processed based on packet type byte) */
 typedef struct _toothpaste_KeyboardPacket {
     char message[190]; /* 190 bytes */
     uint32_t length; /* 1 - 4 bytes */
+    uint32_t pasteId; /* Bulk paste this chunk belongs to, 0 = plain text */
+    uint32_t pasteOffset; /* Byte offset of <message> in the paste */
+    toothpaste_KeyboardPacket_compressed_t compressed; /* 190 bytes, replaces <message> in a bulk paste: LZ tokens (see LzText.h) expanding to at most 1024 bytes */
 } toothpaste_KeyboardPacket;
 
 typedef struct _toothpaste_RenamePacket {
@@ -83,6 +164,7 @@ typedef struct _toothpaste_Frame {
     int32_t y; /* 4 bytes */
 } toothpaste_Frame;
 
+typedef PB_BYTES_ARRAY_T(190) toothpaste_MousePacket_packedFrames_t;
 /* Packet with multiple units of mouse movement frames that define a curve */
 typedef struct _toothpaste_MousePacket {
     uint32_t num_frames; /* how many frames */
@@ -91,6 +173,10 @@ typedef struct _toothpaste_MousePacket {
     int32_t l_click; /* left click state */
     int32_t r_click; /* right click state */
     int32_t wheel; /* wheel movement */
+    /* 190 bytes, replaces <frames>: one byte per frame, int4 dx, dy in the high, low nibble - or 0x80 then zig-zag varint dx, dy
+ 0x81 then a varint ms sets the spacing of the timed frames after it, 0x82 - 0x8F are reserved */
+    toothpaste_MousePacket_packedFrames_t packedFrames;
+    bool timedFrames; /* Packed frames are spaced by the last 0x81 spacing (0 before one), the device replays that spacing */
 } toothpaste_MousePacket;
 
 /* Consumer Control Device Data (Volume, Playback, etc.) */
@@ -105,6 +191,97 @@ typedef struct _toothpaste_MouseJigglePacket {
     bool enable;
 } toothpaste_MouseJigglePacket;
 
+typedef PB_BYTES_ARRAY_T(180) toothpaste_TouchpadPacket_frames_t;
+/* Raw multi-touch contact frames for the precision touchpad interface
+ Each frame is [count | button << 3][delay ms] followed by <count> contacts of [id | tip << 4][x lo][x hi][y lo][y hi] */
+typedef struct _toothpaste_TouchpadPacket {
+    toothpaste_TouchpadPacket_frames_t frames; /* 180 bytes */
+} toothpaste_TouchpadPacket;
+
+typedef PB_BYTES_ARRAY_T(11) toothpaste_GamepadPacket_values_t;
+/* Gamepad state delta against the last acknowledged state, only the fields flagged in <changed> are present in <values>
+ changed: bits 0-5 = x, y, z, rz, rx, ry (1 byte each) | bit 6 = hat (1 byte) | bit 7 = buttons (4 bytes LE) */
+typedef struct _toothpaste_GamepadPacket {
+    uint32_t sequence; /* Increments per packet, echoed back in GAMEPAD_ACK */
+    uint32_t changed; /* 1 - 2 bytes */
+    toothpaste_GamepadPacket_values_t values; /* 11 bytes */
+} toothpaste_GamepadPacket;
+
+typedef PB_BYTES_ARRAY_T(180) toothpaste_KeyEventPacket_events_t;
+/* Raw key press/release events applied to the held key state, 3 bytes per event
+ [usage][state][delay ms]: usage = HID keyboard usage (HID_KEY_*), state bit 0 = down, delay = ms since the previous event */
+typedef struct _toothpaste_KeyEventPacket {
+    toothpaste_KeyEventPacket_events_t events; /* 180 bytes */
+} toothpaste_KeyEventPacket;
+
+typedef PB_BYTES_ARRAY_T(190) toothpaste_ChordSequencePacket_chords_t;
+/* A sequence of chords executed back to back, each chord is [count | text << 7][hold ms lo][hold hi] followed by <count> bytes
+ Key chords use KeycodePacket encoding and are held for <hold> ms (0 = default), text chords are typed through the keyboard layout */
+typedef struct _toothpaste_ChordSequencePacket {
+    toothpaste_ChordSequencePacket_chords_t chords; /* 190 bytes */
+} toothpaste_ChordSequencePacket;
+
+/* Device behaviour settings for the current session, settings a packet leaves out keep their current value */
+typedef struct _toothpaste_ConfigPacket {
+    bool has_ackTyping;
+    bool ackTyping; /* Pace typing by lock-key LED echoes from the host */
+    bool has_unicodeFallback;
+    toothpaste_ConfigPacket_UnicodeFallback unicodeFallback;
+    toothpaste_ConfigPacket_KeyboardLayout layout;
+    bool has_playoutDelayMs;
+    uint32_t playoutDelayMs; /* Hold timestamped input this long and replay it at its original spacing, 0 = off */
+} toothpaste_ConfigPacket;
+
+typedef PB_BYTES_ARRAY_T(180) toothpaste_SyncPacket_text_t;
+/* Target text for sync mode, the device types only the difference from the text it typed last
+ A target is sent as consecutive chunks starting at offset 0, the edit runs when the chunk with <done> arrives */
+typedef struct _toothpaste_SyncPacket {
+    uint32_t offset; /* Byte offset of <text> in the target */
+    toothpaste_SyncPacket_text_t text; /* 180 bytes of UTF-8 */
+    bool done; /* Last chunk of the target */
+    bool reset; /* Forget the previous text, the cursor is in an empty field */
+} toothpaste_SyncPacket;
+
+typedef PB_BYTES_ARRAY_T(180) toothpaste_MacroPacket_data_t;
+/* Upload a macro into an on-device slot, sent as consecutive chunks starting at offset 0
+ The macro is a list of records [delay ms lo][delay ms hi][length] followed by <length> bytes of a serialized EncryptedData */
+typedef struct _toothpaste_MacroPacket {
+    uint32_t slot; /* 0 - 15, slot 0 also runs from the button */
+    uint32_t offset; /* Byte offset of <data> in the macro */
+    toothpaste_MacroPacket_data_t data; /* 180 bytes */
+    bool done; /* Last chunk, seals the slot */
+} toothpaste_MacroPacket;
+
+/* Run a stored macro */
+typedef struct _toothpaste_RunMacroPacket {
+    uint32_t slot;
+} toothpaste_RunMacroPacket;
+
+typedef PB_BYTES_ARRAY_T(180) toothpaste_ScriptPacket_code_t;
+/* Compiled Duckyscript bytecode (see firmware/components/duckyVM/DuckyVM.h), sent as consecutive chunks starting at offset 0
+ The script runs on the device once the last chunk arrives, in order with any queued text */
+typedef struct _toothpaste_ScriptPacket {
+    uint32_t offset; /* Byte offset of <code> in the script */
+    toothpaste_ScriptPacket_code_t code; /* 180 bytes */
+    bool done; /* Last chunk, run the script */
+} toothpaste_ScriptPacket;
+
+typedef PB_BYTES_ARRAY_T(180) toothpaste_CompositePacket_events_t;
+/* Keyboard, keycode, mouse and consumer events in one packet, run in order by the device
+ Each event is [kind][delay ms lo][delay ms hi][length] followed by <length> bytes, delay = ms after the previous event was due
+ kind 0 = UTF-8 text, 1 = KeycodePacket encoding (pressed then released), 2 = [usage][state bit 0 = down],
+ 3 = [dx lo][dx hi][dy lo][dy hi][buttons: bit 0 = left, bit 1 = right][wheel] (int16/int8, buttons are the held state),
+ 4 = consumer control [usage lo][usage hi] */
+typedef struct _toothpaste_CompositePacket {
+    toothpaste_CompositePacket_events_t events; /* 180 bytes */
+} toothpaste_CompositePacket;
+
+/* Clock sync probe, answered with a CLOCK_SYNC response carrying the device time
+ The client keeps the probe with the shortest round trip: offset = deviceTime - (clientTime + rtt / 2) */
+typedef struct _toothpaste_ClockSyncPacket {
+    uint64_t clientTime; /* Client clock (us), echoed back */
+} toothpaste_ClockSyncPacket;
+
 typedef struct _toothpaste_EncryptedData {
     toothpaste_EncryptedData_PacketType packetType;
     pb_size_t which_packetData;
@@ -115,7 +292,19 @@ typedef struct _toothpaste_EncryptedData {
         toothpaste_RenamePacket renamePacket;
         toothpaste_ConsumerControlPacket consumerControlPacket;
         toothpaste_MouseJigglePacket mouseJigglePacket;
+        toothpaste_TouchpadPacket touchpadPacket;
+        toothpaste_GamepadPacket gamepadPacket;
+        toothpaste_KeyEventPacket keyEventPacket;
+        toothpaste_ChordSequencePacket chordSequencePacket;
+        toothpaste_ConfigPacket configPacket;
+        toothpaste_SyncPacket syncPacket;
+        toothpaste_MacroPacket macroPacket;
+        toothpaste_RunMacroPacket runMacroPacket;
+        toothpaste_ScriptPacket scriptPacket;
+        toothpaste_CompositePacket compositePacket;
+        toothpaste_ClockSyncPacket clockSyncPacket;
     } packetData;
+    uint64_t timestamp; /* Capture time in device time (us), applied at timestamp + playout delay, 0 = on arrival */
 } toothpaste_EncryptedData;
 
 
@@ -125,16 +314,24 @@ extern "C" {
 
 /* Helper constants for enums */
 #define _toothpaste_DataPacket_PacketID_MIN toothpaste_DataPacket_PacketID_DATA_PACKET
-#define _toothpaste_DataPacket_PacketID_MAX toothpaste_DataPacket_PacketID_AUTH_PACKET
-#define _toothpaste_DataPacket_PacketID_ARRAYSIZE ((toothpaste_DataPacket_PacketID)(toothpaste_DataPacket_PacketID_AUTH_PACKET+1))
+#define _toothpaste_DataPacket_PacketID_MAX toothpaste_DataPacket_PacketID_RESUME_PACKET
+#define _toothpaste_DataPacket_PacketID_ARRAYSIZE ((toothpaste_DataPacket_PacketID)(toothpaste_DataPacket_PacketID_RESUME_PACKET+1))
 
 #define _toothpaste_EncryptedData_PacketType_MIN toothpaste_EncryptedData_PacketType_KEYBOARD_STRING
-#define _toothpaste_EncryptedData_PacketType_MAX toothpaste_EncryptedData_PacketType_COMPOSITE
-#define _toothpaste_EncryptedData_PacketType_ARRAYSIZE ((toothpaste_EncryptedData_PacketType)(toothpaste_EncryptedData_PacketType_COMPOSITE+1))
+#define _toothpaste_EncryptedData_PacketType_MAX toothpaste_EncryptedData_PacketType_CLOCK_SYNC
+#define _toothpaste_EncryptedData_PacketType_ARRAYSIZE ((toothpaste_EncryptedData_PacketType)(toothpaste_EncryptedData_PacketType_CLOCK_SYNC+1))
 
 #define _toothpaste_ResponsePacket_ResponseType_MIN toothpaste_ResponsePacket_ResponseType_KEEPALIVE
-#define _toothpaste_ResponsePacket_ResponseType_MAX toothpaste_ResponsePacket_ResponseType_CHALLENGE
-#define _toothpaste_ResponsePacket_ResponseType_ARRAYSIZE ((toothpaste_ResponsePacket_ResponseType)(toothpaste_ResponsePacket_ResponseType_CHALLENGE+1))
+#define _toothpaste_ResponsePacket_ResponseType_MAX toothpaste_ResponsePacket_ResponseType_RESUME_FAILED
+#define _toothpaste_ResponsePacket_ResponseType_ARRAYSIZE ((toothpaste_ResponsePacket_ResponseType)(toothpaste_ResponsePacket_ResponseType_RESUME_FAILED+1))
+
+#define _toothpaste_ConfigPacket_UnicodeFallback_MIN toothpaste_ConfigPacket_UnicodeFallback_NONE
+#define _toothpaste_ConfigPacket_UnicodeFallback_MAX toothpaste_ConfigPacket_UnicodeFallback_MAC_HEX
+#define _toothpaste_ConfigPacket_UnicodeFallback_ARRAYSIZE ((toothpaste_ConfigPacket_UnicodeFallback)(toothpaste_ConfigPacket_UnicodeFallback_MAC_HEX+1))
+
+#define _toothpaste_ConfigPacket_KeyboardLayout_MIN toothpaste_ConfigPacket_KeyboardLayout_UNCHANGED
+#define _toothpaste_ConfigPacket_KeyboardLayout_MAX toothpaste_ConfigPacket_KeyboardLayout_HU_HU
+#define _toothpaste_ConfigPacket_KeyboardLayout_ARRAYSIZE ((toothpaste_ConfigPacket_KeyboardLayout)(toothpaste_ConfigPacket_KeyboardLayout_HU_HU+1))
 
 #define toothpaste_DataPacket_packetID_ENUMTYPE toothpaste_DataPacket_PacketID
 
@@ -142,6 +339,9 @@ extern "C" {
 
 #define toothpaste_ResponsePacket_responseType_ENUMTYPE toothpaste_ResponsePacket_ResponseType
 
+#define toothpaste_ConfigPacket_unicodeFallback_ENUMTYPE toothpaste_ConfigPacket_UnicodeFallback
+#define toothpaste_ConfigPacket_layout_ENUMTYPE toothpaste_ConfigPacket_KeyboardLayout
+
 
 
 
@@ -151,26 +351,50 @@ extern "C" {
 
 
 /* Initializer values for message structs */
-#define toothpaste_DataPacket_init_default       {_toothpaste_DataPacket_PacketID_MIN, 0, 0, 0, {0, {0}}, 0, {0, {0}}, {0, {0}}}
-#define toothpaste_EncryptedData_init_default    {_toothpaste_EncryptedData_PacketType_MIN, 0, {toothpaste_KeyboardPacket_init_default}}
-#define toothpaste_ResponsePacket_init_default   {_toothpaste_ResponsePacket_ResponseType_MIN, {0, {0}}, ""}
-#define toothpaste_KeyboardPacket_init_default   {"", 0}
+#define toothpaste_DataPacket_init_default       {_toothpaste_DataPacket_PacketID_MIN, 0, 0, 0, {0, {0}}, 0, {0, {0}}, {0, {0}}, false, 0, {0, {0}}}
+#define toothpaste_EncryptedData_init_default    {_toothpaste_EncryptedData_PacketType_MIN, 0, {toothpaste_KeyboardPacket_init_default}, 0}
+#define toothpaste_ResponsePacket_init_default   {_toothpaste_ResponsePacket_ResponseType_MIN, {0, {0}}, "", 0, 0, 0, 0, 0, 0, 0, 0, false, toothpaste_Capabilities_init_default, 0, {0, {0}}}
+#define toothpaste_KeyboardPacket_init_default   {"", 0, 0, 0, {0, {0}}}
 #define toothpaste_RenamePacket_init_default     {"", 0}
 #define toothpaste_KeycodePacket_init_default    {{0, {0}}, 0}
 #define toothpaste_Frame_init_default            {0, 0}
-#define toothpaste_MousePacket_init_default      {0, 0, {toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default}, 0, 0, 0}
+#define toothpaste_MousePacket_init_default      {0, 0, {toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default, toothpaste_Frame_init_default}, 0, 0, 0, {0, {0}}, 0}
 #define toothpaste_ConsumerControlPacket_init_default {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0}
 #define toothpaste_MouseJigglePacket_init_default {0}
-#define toothpaste_DataPacket_init_zero          {_toothpaste_DataPacket_PacketID_MIN, 0, 0, 0, {0, {0}}, 0, {0, {0}}, {0, {0}}}
-#define toothpaste_EncryptedData_init_zero       {_toothpaste_EncryptedData_PacketType_MIN, 0, {toothpaste_KeyboardPacket_init_zero}}
-#define toothpaste_ResponsePacket_init_zero      {_toothpaste_ResponsePacket_ResponseType_MIN, {0, {0}}, ""}
-#define toothpaste_KeyboardPacket_init_zero      {"", 0}
+#define toothpaste_TouchpadPacket_init_default   {{0, {0}}}
+#define toothpaste_GamepadPacket_init_default    {0, 0, {0, {0}}}
+#define toothpaste_KeyEventPacket_init_default   {{0, {0}}}
+#define toothpaste_ChordSequencePacket_init_default {{0, {0}}}
+#define toothpaste_ConfigPacket_init_default     {false, 0, false, _toothpaste_ConfigPacket_UnicodeFallback_MIN, _toothpaste_ConfigPacket_KeyboardLayout_MIN, false, 0}
+#define toothpaste_SyncPacket_init_default       {0, {0, {0}}, 0, 0}
+#define toothpaste_MacroPacket_init_default      {0, 0, {0, {0}}, 0}
+#define toothpaste_RunMacroPacket_init_default   {0}
+#define toothpaste_ScriptPacket_init_default     {0, {0, {0}}, 0}
+#define toothpaste_CompositePacket_init_default  {{0, {0}}}
+#define toothpaste_ClockSyncPacket_init_default  {0}
+#define toothpaste_Capabilities_init_default     {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
+#define toothpaste_DataPacket_init_zero          {_toothpaste_DataPacket_PacketID_MIN, 0, 0, 0, {0, {0}}, 0, {0, {0}}, {0, {0}}, false, 0, {0, {0}}}
+#define toothpaste_EncryptedData_init_zero       {_toothpaste_EncryptedData_PacketType_MIN, 0, {toothpaste_KeyboardPacket_init_zero}, 0}
+#define toothpaste_ResponsePacket_init_zero      {_toothpaste_ResponsePacket_ResponseType_MIN, {0, {0}}, "", 0, 0, 0, 0, 0, 0, 0, 0, false, toothpaste_Capabilities_init_zero, 0, {0, {0}}}
+#define toothpaste_KeyboardPacket_init_zero      {"", 0, 0, 0, {0, {0}}}
 #define toothpaste_RenamePacket_init_zero        {"", 0}
 #define toothpaste_KeycodePacket_init_zero       {{0, {0}}, 0}
 #define toothpaste_Frame_init_zero               {0, 0}
-#define toothpaste_MousePacket_init_zero         {0, 0, {toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero}, 0, 0, 0}
+#define toothpaste_MousePacket_init_zero         {0, 0, {toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero, toothpaste_Frame_init_zero}, 0, 0, 0, {0, {0}}, 0}
 #define toothpaste_ConsumerControlPacket_init_zero {0, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 0}
 #define toothpaste_MouseJigglePacket_init_zero   {0}
+#define toothpaste_TouchpadPacket_init_zero      {{0, {0}}}
+#define toothpaste_GamepadPacket_init_zero       {0, 0, {0, {0}}}
+#define toothpaste_KeyEventPacket_init_zero      {{0, {0}}}
+#define toothpaste_ChordSequencePacket_init_zero {{0, {0}}}
+#define toothpaste_ConfigPacket_init_zero        {false, 0, false, _toothpaste_ConfigPacket_UnicodeFallback_MIN, _toothpaste_ConfigPacket_KeyboardLayout_MIN, false, 0}
+#define toothpaste_SyncPacket_init_zero          {0, {0, {0}}, 0, 0}
+#define toothpaste_MacroPacket_init_zero         {0, 0, {0, {0}}, 0}
+#define toothpaste_RunMacroPacket_init_zero      {0}
+#define toothpaste_ScriptPacket_init_zero        {0, {0, {0}}, 0}
+#define toothpaste_CompositePacket_init_zero     {{0, {0}}}
+#define toothpaste_ClockSyncPacket_init_zero     {0}
+#define toothpaste_Capabilities_init_zero        {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define toothpaste_DataPacket_packetID_tag       1
@@ -181,11 +405,27 @@ extern "C" {
 #define toothpaste_DataPacket_dataLen_tag        6
 #define toothpaste_DataPacket_encryptedData_tag  7
 #define toothpaste_DataPacket_tag_tag            8
+#define toothpaste_DataPacket_sequence_tag       9
+#define toothpaste_DataPacket_resumeTicket_tag   10
 #define toothpaste_ResponsePacket_responseType_tag 1
 #define toothpaste_ResponsePacket_challengeData_tag 2
 #define toothpaste_ResponsePacket_firmwareVersion_tag 3
+#define toothpaste_ResponsePacket_ackSequence_tag 4
+#define toothpaste_ResponsePacket_hostLeds_tag   5
+#define toothpaste_ResponsePacket_pasteId_tag    6
+#define toothpaste_ResponsePacket_pasteOffset_tag 7
+#define toothpaste_ResponsePacket_macroSlot_tag  8
+#define toothpaste_ResponsePacket_macroStored_tag 9
+#define toothpaste_ResponsePacket_clientTime_tag 10
+#define toothpaste_ResponsePacket_deviceTime_tag 11
+#define toothpaste_ResponsePacket_capabilities_tag 12
+#define toothpaste_ResponsePacket_sackBits_tag   13
+#define toothpaste_ResponsePacket_resumeTicket_tag 14
 #define toothpaste_KeyboardPacket_message_tag    1
 #define toothpaste_KeyboardPacket_length_tag     2
+#define toothpaste_KeyboardPacket_pasteId_tag    3
+#define toothpaste_KeyboardPacket_pasteOffset_tag 4
+#define toothpaste_KeyboardPacket_compressed_tag 5
 #define toothpaste_RenamePacket_message_tag      1
 #define toothpaste_RenamePacket_length_tag       2
 #define toothpaste_KeycodePacket_code_tag        1
@@ -197,9 +437,46 @@ extern "C" {
 #define toothpaste_MousePacket_l_click_tag       3
 #define toothpaste_MousePacket_r_click_tag       4
 #define toothpaste_MousePacket_wheel_tag         5
+#define toothpaste_MousePacket_packedFrames_tag  6
+#define toothpaste_MousePacket_timedFrames_tag   7
 #define toothpaste_ConsumerControlPacket_code_tag 1
 #define toothpaste_ConsumerControlPacket_length_tag 2
 #define toothpaste_MouseJigglePacket_enable_tag  1
+#define toothpaste_TouchpadPacket_frames_tag     1
+#define toothpaste_GamepadPacket_sequence_tag    1
+#define toothpaste_GamepadPacket_changed_tag     2
+#define toothpaste_GamepadPacket_values_tag      3
+#define toothpaste_KeyEventPacket_events_tag     1
+#define toothpaste_ChordSequencePacket_chords_tag 1
+#define toothpaste_ConfigPacket_ackTyping_tag    1
+#define toothpaste_ConfigPacket_unicodeFallback_tag 2
+#define toothpaste_ConfigPacket_layout_tag       3
+#define toothpaste_ConfigPacket_playoutDelayMs_tag 4
+#define toothpaste_SyncPacket_offset_tag         1
+#define toothpaste_SyncPacket_text_tag           2
+#define toothpaste_SyncPacket_done_tag           3
+#define toothpaste_SyncPacket_reset_tag          4
+#define toothpaste_MacroPacket_slot_tag          1
+#define toothpaste_MacroPacket_offset_tag        2
+#define toothpaste_MacroPacket_data_tag          3
+#define toothpaste_MacroPacket_done_tag          4
+#define toothpaste_RunMacroPacket_slot_tag       1
+#define toothpaste_ScriptPacket_offset_tag       1
+#define toothpaste_ScriptPacket_code_tag         2
+#define toothpaste_ScriptPacket_done_tag         3
+#define toothpaste_CompositePacket_events_tag    1
+#define toothpaste_ClockSyncPacket_clientTime_tag 1
+#define toothpaste_Capabilities_maxWriteSize_tag 1
+#define toothpaste_Capabilities_queueCredits_tag 2
+#define toothpaste_Capabilities_wireFormats_tag  3
+#define toothpaste_Capabilities_compression_tag  4
+#define toothpaste_Capabilities_nkro_tag         5
+#define toothpaste_Capabilities_absolutePointer_tag 6
+#define toothpaste_Capabilities_keyReportIntervalUs_tag 7
+#define toothpaste_Capabilities_slowModeDelayMs_tag 8
+#define toothpaste_Capabilities_macroSlots_tag   9
+#define toothpaste_Capabilities_macroSlotSize_tag 10
+#define toothpaste_Capabilities_features_tag     11
 #define toothpaste_EncryptedData_packetType_tag  1
 #define toothpaste_EncryptedData_keyboardPacket_tag 2
 #define toothpaste_EncryptedData_keycodePacket_tag 3
@@ -207,6 +484,18 @@ extern "C" {
 #define toothpaste_EncryptedData_renamePacket_tag 5
 #define toothpaste_EncryptedData_consumerControlPacket_tag 6
 #define toothpaste_EncryptedData_mouseJigglePacket_tag 7
+#define toothpaste_EncryptedData_touchpadPacket_tag 8
+#define toothpaste_EncryptedData_gamepadPacket_tag 9
+#define toothpaste_EncryptedData_keyEventPacket_tag 10
+#define toothpaste_EncryptedData_chordSequencePacket_tag 11
+#define toothpaste_EncryptedData_configPacket_tag 12
+#define toothpaste_EncryptedData_syncPacket_tag  13
+#define toothpaste_EncryptedData_macroPacket_tag 14
+#define toothpaste_EncryptedData_runMacroPacket_tag 15
+#define toothpaste_EncryptedData_scriptPacket_tag 16
+#define toothpaste_EncryptedData_compositePacket_tag 17
+#define toothpaste_EncryptedData_clockSyncPacket_tag 18
+#define toothpaste_EncryptedData_timestamp_tag   19
 
 /* Struct field encoding specification for nanopb */
 #define toothpaste_DataPacket_FIELDLIST(X, a) \
@@ -217,7 +506,9 @@ X(a, STATIC,   SINGULAR, BOOL,     slowMode,          4) \
 X(a, STATIC,   SINGULAR, BYTES,    iv,                5) \
 X(a, STATIC,   SINGULAR, UINT32,   dataLen,           6) \
 X(a, STATIC,   SINGULAR, BYTES,    encryptedData,     7) \
-X(a, STATIC,   SINGULAR, BYTES,    tag,               8)
+X(a, STATIC,   SINGULAR, BYTES,    tag,               8) \
+X(a, STATIC,   OPTIONAL, UINT32,   sequence,          9) \
+X(a, STATIC,   SINGULAR, BYTES,    resumeTicket,      10)
 #define toothpaste_DataPacket_CALLBACK NULL
 #define toothpaste_DataPacket_DEFAULT NULL
 
@@ -228,7 +519,19 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,keycodePacket,packetData.keycodeP
 X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,mousePacket,packetData.mousePacket),   4) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,renamePacket,packetData.renamePacket),   5) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,consumerControlPacket,packetData.consumerControlPacket),   6) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,mouseJigglePacket,packetData.mouseJigglePacket),   7)
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,mouseJigglePacket,packetData.mouseJigglePacket),   7) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,touchpadPacket,packetData.touchpadPacket),   8) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,gamepadPacket,packetData.gamepadPacket),   9) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,keyEventPacket,packetData.keyEventPacket),   10) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,chordSequencePacket,packetData.chordSequencePacket),   11) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,configPacket,packetData.configPacket),   12) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,syncPacket,packetData.syncPacket),   13) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,macroPacket,packetData.macroPacket),   14) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,runMacroPacket,packetData.runMacroPacket),   15) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,scriptPacket,packetData.scriptPacket),   16) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,compositePacket,packetData.compositePacket),   17) \
+X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,clockSyncPacket,packetData.clockSyncPacket),   18) \
+X(a, STATIC,   SINGULAR, UINT64,   timestamp,         19)
 #define toothpaste_EncryptedData_CALLBACK NULL
 #define toothpaste_EncryptedData_DEFAULT NULL
 #define toothpaste_EncryptedData_packetData_keyboardPacket_MSGTYPE toothpaste_KeyboardPacket
@@ -237,17 +540,43 @@ X(a, STATIC,   ONEOF,    MESSAGE,  (packetData,mouseJigglePacket,packetData.mous
 #define toothpaste_EncryptedData_packetData_renamePacket_MSGTYPE toothpaste_RenamePacket
 #define toothpaste_EncryptedData_packetData_consumerControlPacket_MSGTYPE toothpaste_ConsumerControlPacket
 #define toothpaste_EncryptedData_packetData_mouseJigglePacket_MSGTYPE toothpaste_MouseJigglePacket
+#define toothpaste_EncryptedData_packetData_touchpadPacket_MSGTYPE toothpaste_TouchpadPacket
+#define toothpaste_EncryptedData_packetData_gamepadPacket_MSGTYPE toothpaste_GamepadPacket
+#define toothpaste_EncryptedData_packetData_keyEventPacket_MSGTYPE toothpaste_KeyEventPacket
+#define toothpaste_EncryptedData_packetData_chordSequencePacket_MSGTYPE toothpaste_ChordSequencePacket
+#define toothpaste_EncryptedData_packetData_configPacket_MSGTYPE toothpaste_ConfigPacket
+#define toothpaste_EncryptedData_packetData_syncPacket_MSGTYPE toothpaste_SyncPacket
+#define toothpaste_EncryptedData_packetData_macroPacket_MSGTYPE toothpaste_MacroPacket
+#define toothpaste_EncryptedData_packetData_runMacroPacket_MSGTYPE toothpaste_RunMacroPacket
+#define toothpaste_EncryptedData_packetData_scriptPacket_MSGTYPE toothpaste_ScriptPacket
+#define toothpaste_EncryptedData_packetData_compositePacket_MSGTYPE toothpaste_CompositePacket
+#define toothpaste_EncryptedData_packetData_clockSyncPacket_MSGTYPE toothpaste_ClockSyncPacket
 
 #define toothpaste_ResponsePacket_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UENUM,    responseType,      1) \
 X(a, STATIC,   SINGULAR, BYTES,    challengeData,     2) \
-X(a, STATIC,   SINGULAR, STRING,   firmwareVersion,   3)
+X(a, STATIC,   SINGULAR, STRING,   firmwareVersion,   3) \
+X(a, STATIC,   SINGULAR, UINT32,   ackSequence,       4) \
+X(a, STATIC,   SINGULAR, UINT32,   hostLeds,          5) \
+X(a, STATIC,   SINGULAR, UINT32,   pasteId,           6) \
+X(a, STATIC,   SINGULAR, UINT32,   pasteOffset,       7) \
+X(a, STATIC,   SINGULAR, UINT32,   macroSlot,         8) \
+X(a, STATIC,   SINGULAR, BOOL,     macroStored,       9) \
+X(a, STATIC,   SINGULAR, UINT64,   clientTime,        10) \
+X(a, STATIC,   SINGULAR, UINT64,   deviceTime,        11) \
+X(a, STATIC,   OPTIONAL, MESSAGE,  capabilities,      12) \
+X(a, STATIC,   SINGULAR, UINT32,   sackBits,          13) \
+X(a, STATIC,   SINGULAR, BYTES,    resumeTicket,      14)
 #define toothpaste_ResponsePacket_CALLBACK NULL
 #define toothpaste_ResponsePacket_DEFAULT NULL
+#define toothpaste_ResponsePacket_capabilities_MSGTYPE toothpaste_Capabilities
 
 #define toothpaste_KeyboardPacket_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, STRING,   message,           1) \
-X(a, STATIC,   SINGULAR, UINT32,   length,            2)
+X(a, STATIC,   SINGULAR, UINT32,   length,            2) \
+X(a, STATIC,   SINGULAR, UINT32,   pasteId,           3) \
+X(a, STATIC,   SINGULAR, UINT32,   pasteOffset,       4) \
+X(a, STATIC,   SINGULAR, BYTES,    compressed,        5)
 #define toothpaste_KeyboardPacket_CALLBACK NULL
 #define toothpaste_KeyboardPacket_DEFAULT NULL
 
@@ -274,7 +603,9 @@ X(a, STATIC,   SINGULAR, UINT32,   num_frames,        1) \
 X(a, STATIC,   REPEATED, MESSAGE,  frames,            2) \
 X(a, STATIC,   SINGULAR, INT32,    l_click,           3) \
 X(a, STATIC,   SINGULAR, INT32,    r_click,           4) \
-X(a, STATIC,   SINGULAR, INT32,    wheel,             5)
+X(a, STATIC,   SINGULAR, INT32,    wheel,             5) \
+X(a, STATIC,   SINGULAR, BYTES,    packedFrames,      6) \
+X(a, STATIC,   SINGULAR, BOOL,     timedFrames,       7)
 #define toothpaste_MousePacket_CALLBACK NULL
 #define toothpaste_MousePacket_DEFAULT NULL
 #define toothpaste_MousePacket_frames_MSGTYPE toothpaste_Frame
@@ -290,6 +621,89 @@ X(a, STATIC,   SINGULAR, BOOL,     enable,            1)
 #define toothpaste_MouseJigglePacket_CALLBACK NULL
 #define toothpaste_MouseJigglePacket_DEFAULT NULL
 
+#define toothpaste_TouchpadPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, BYTES,    frames,            1)
+#define toothpaste_TouchpadPacket_CALLBACK NULL
+#define toothpaste_TouchpadPacket_DEFAULT NULL
+
+#define toothpaste_GamepadPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   sequence,          1) \
+X(a, STATIC,   SINGULAR, UINT32,   changed,           2) \
+X(a, STATIC,   SINGULAR, BYTES,    values,            3)
+#define toothpaste_GamepadPacket_CALLBACK NULL
+#define toothpaste_GamepadPacket_DEFAULT NULL
+
+#define toothpaste_KeyEventPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, BYTES,    events,            1)
+#define toothpaste_KeyEventPacket_CALLBACK NULL
+#define toothpaste_KeyEventPacket_DEFAULT NULL
+
+#define toothpaste_ChordSequencePacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, BYTES,    chords,            1)
+#define toothpaste_ChordSequencePacket_CALLBACK NULL
+#define toothpaste_ChordSequencePacket_DEFAULT NULL
+
+#define toothpaste_ConfigPacket_FIELDLIST(X, a) \
+X(a, STATIC,   OPTIONAL, BOOL,     ackTyping,         1) \
+X(a, STATIC,   OPTIONAL, UENUM,    unicodeFallback,   2) \
+X(a, STATIC,   SINGULAR, UENUM,    layout,            3) \
+X(a, STATIC,   OPTIONAL, UINT32,   playoutDelayMs,    4)
+#define toothpaste_ConfigPacket_CALLBACK NULL
+#define toothpaste_ConfigPacket_DEFAULT NULL
+
+#define toothpaste_SyncPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   offset,            1) \
+X(a, STATIC,   SINGULAR, BYTES,    text,              2) \
+X(a, STATIC,   SINGULAR, BOOL,     done,              3) \
+X(a, STATIC,   SINGULAR, BOOL,     reset,             4)
+#define toothpaste_SyncPacket_CALLBACK NULL
+#define toothpaste_SyncPacket_DEFAULT NULL
+
+#define toothpaste_MacroPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   slot,              1) \
+X(a, STATIC,   SINGULAR, UINT32,   offset,            2) \
+X(a, STATIC,   SINGULAR, BYTES,    data,              3) \
+X(a, STATIC,   SINGULAR, BOOL,     done,              4)
+#define toothpaste_MacroPacket_CALLBACK NULL
+#define toothpaste_MacroPacket_DEFAULT NULL
+
+#define toothpaste_RunMacroPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   slot,              1)
+#define toothpaste_RunMacroPacket_CALLBACK NULL
+#define toothpaste_RunMacroPacket_DEFAULT NULL
+
+#define toothpaste_ScriptPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   offset,            1) \
+X(a, STATIC,   SINGULAR, BYTES,    code,              2) \
+X(a, STATIC,   SINGULAR, BOOL,     done,              3)
+#define toothpaste_ScriptPacket_CALLBACK NULL
+#define toothpaste_ScriptPacket_DEFAULT NULL
+
+#define toothpaste_CompositePacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, BYTES,    events,            1)
+#define toothpaste_CompositePacket_CALLBACK NULL
+#define toothpaste_CompositePacket_DEFAULT NULL
+
+#define toothpaste_ClockSyncPacket_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT64,   clientTime,        1)
+#define toothpaste_ClockSyncPacket_CALLBACK NULL
+#define toothpaste_ClockSyncPacket_DEFAULT NULL
+
+#define toothpaste_Capabilities_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   maxWriteSize,      1) \
+X(a, STATIC,   SINGULAR, UINT32,   queueCredits,      2) \
+X(a, STATIC,   SINGULAR, UINT32,   wireFormats,       3) \
+X(a, STATIC,   SINGULAR, UINT32,   compression,       4) \
+X(a, STATIC,   SINGULAR, BOOL,     nkro,              5) \
+X(a, STATIC,   SINGULAR, BOOL,     absolutePointer,   6) \
+X(a, STATIC,   SINGULAR, UINT32,   keyReportIntervalUs, 7) \
+X(a, STATIC,   SINGULAR, UINT32,   slowModeDelayMs,   8) \
+X(a, STATIC,   SINGULAR, UINT32,   macroSlots,        9) \
+X(a, STATIC,   SINGULAR, UINT32,   macroSlotSize,     10) \
+X(a, STATIC,   SINGULAR, UINT32,   features,          11)
+#define toothpaste_Capabilities_CALLBACK NULL
+#define toothpaste_Capabilities_DEFAULT NULL
+
 extern const pb_msgdesc_t toothpaste_DataPacket_msg;
 extern const pb_msgdesc_t toothpaste_EncryptedData_msg;
 extern const pb_msgdesc_t toothpaste_ResponsePacket_msg;
@@ -300,6 +714,18 @@ extern const pb_msgdesc_t toothpaste_Frame_msg;
 extern const pb_msgdesc_t toothpaste_MousePacket_msg;
 extern const pb_msgdesc_t toothpaste_ConsumerControlPacket_msg;
 extern const pb_msgdesc_t toothpaste_MouseJigglePacket_msg;
+extern const pb_msgdesc_t toothpaste_TouchpadPacket_msg;
+extern const pb_msgdesc_t toothpaste_GamepadPacket_msg;
+extern const pb_msgdesc_t toothpaste_KeyEventPacket_msg;
+extern const pb_msgdesc_t toothpaste_ChordSequencePacket_msg;
+extern const pb_msgdesc_t toothpaste_ConfigPacket_msg;
+extern const pb_msgdesc_t toothpaste_SyncPacket_msg;
+extern const pb_msgdesc_t toothpaste_MacroPacket_msg;
+extern const pb_msgdesc_t toothpaste_RunMacroPacket_msg;
+extern const pb_msgdesc_t toothpaste_ScriptPacket_msg;
+extern const pb_msgdesc_t toothpaste_CompositePacket_msg;
+extern const pb_msgdesc_t toothpaste_ClockSyncPacket_msg;
+extern const pb_msgdesc_t toothpaste_Capabilities_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define toothpaste_DataPacket_fields &toothpaste_DataPacket_msg
@@ -312,19 +738,43 @@ extern const pb_msgdesc_t toothpaste_MouseJigglePacket_msg;
 #define toothpaste_MousePacket_fields &toothpaste_MousePacket_msg
 #define toothpaste_ConsumerControlPacket_fields &toothpaste_ConsumerControlPacket_msg
 #define toothpaste_MouseJigglePacket_fields &toothpaste_MouseJigglePacket_msg
+#define toothpaste_TouchpadPacket_fields &toothpaste_TouchpadPacket_msg
+#define toothpaste_GamepadPacket_fields &toothpaste_GamepadPacket_msg
+#define toothpaste_KeyEventPacket_fields &toothpaste_KeyEventPacket_msg
+#define toothpaste_ChordSequencePacket_fields &toothpaste_ChordSequencePacket_msg
+#define toothpaste_ConfigPacket_fields &toothpaste_ConfigPacket_msg
+#define toothpaste_SyncPacket_fields &toothpaste_SyncPacket_msg
+#define toothpaste_MacroPacket_fields &toothpaste_MacroPacket_msg
+#define toothpaste_RunMacroPacket_fields &toothpaste_RunMacroPacket_msg
+#define toothpaste_ScriptPacket_fields &toothpaste_ScriptPacket_msg
+#define toothpaste_CompositePacket_fields &toothpaste_CompositePacket_msg
+#define toothpaste_ClockSyncPacket_fields &toothpaste_ClockSyncPacket_msg
+#define toothpaste_Capabilities_fields &toothpaste_Capabilities_msg
 
 /* Maximum encoded size of messages (where known) */
 #define TOOTHPASTE_TOOTHPACKET_PB_H_MAX_SIZE     toothpaste_EncryptedData_size
+#define toothpaste_Capabilities_size             58
+#define toothpaste_ChordSequencePacket_size      193
+#define toothpaste_ClockSyncPacket_size          11
+#define toothpaste_CompositePacket_size          183
+#define toothpaste_ConfigPacket_size             12
 #define toothpaste_ConsumerControlPacket_size    66
-#define toothpaste_DataPacket_size               257
-#define toothpaste_EncryptedData_size            524
+#define toothpaste_DataPacket_size               281
+#define toothpaste_EncryptedData_size            731
 #define toothpaste_Frame_size                    22
-#define toothpaste_KeyboardPacket_size           198
+#define toothpaste_GamepadPacket_size            25
+#define toothpaste_KeyEventPacket_size           183
+#define toothpaste_KeyboardPacket_size           403
 #define toothpaste_KeycodePacket_size            199
+#define toothpaste_MacroPacket_size              197
 #define toothpaste_MouseJigglePacket_size        2
-#define toothpaste_MousePacket_size              519
+#define toothpaste_MousePacket_size              714
 #define toothpaste_RenamePacket_size             198
-#define toothpaste_ResponsePacket_size           206
+#define toothpaste_ResponsePacket_size           344
+#define toothpaste_RunMacroPacket_size           6
+#define toothpaste_ScriptPacket_size             191
+#define toothpaste_SyncPacket_size               193
+#define toothpaste_TouchpadPacket_size           183
 
 #ifdef __cplusplus
 } /* extern "C" */
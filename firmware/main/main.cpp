@@ -1,8 +1,5 @@
 //Framework libraries
 #include <Arduino.h>
-#include <BLEDevice.h>
-#include <BLEUtils.h>
-#include <BLE2902.h>
 #include <esp_timer.h>
 #include <nvs_flash.h>
 
@@ -109,6 +106,7 @@ extern "C" void app_main() {
           if (stateManager->getState() == PAIRING) {
               sendString(base64pubKey, 45, true); // Resend public key over HID
           } else {
+              runMacro(0); // Play the macro stored in the first slot, if any
               //sendKeycode(keycode, true);
               //sendString("Teststring1234", true);
           }
@@ -0,0 +1,112 @@
+// Runs compiled Duckyscript bytecode against a simulated receiver
+// Reports how long the script would take on the device and what the interpreter itself costs on this machine
+//
+// Usage: duckyBench <script.bin> [--char-us N] [--report-us N] [--runs N]
+//   --char-us    time to type one character (default 6000: one press/release plus SLOWMODE_DELAY_MS)
+//   --report-us  time to send one key report (default 1000: one 1 ms USB poll)
+//   --runs       interpreter passes to average (default 1000)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "DuckyVM.h"
+
+static const char* statusNames[] = {
+  "ok", "bad header", "bad opcode", "truncated", "bad repeat", "loops nested too deeply", "aborted"
+};
+
+// Advances a virtual clock instead of typing, so delays cost nothing to simulate
+class SimulatedHost : public DuckyHost {
+public:
+  SimulatedHost(int64_t charUs, int64_t reportUs) : charUs(charUs), reportUs(reportUs) {}
+
+  void typeText(const char* text, size_t length) override {
+    for (size_t i = 0; i < length; i++) {
+      if (((uint8_t)text[i] & 0xC0) != 0x80) { // Count code points, not UTF-8 bytes
+        clock += charUs;
+        chars++;
+      }
+    }
+  }
+  void setKey(uint8_t, bool) override {}
+  void sendKeys() override { clock += reportUs; reports++; }
+  void releaseAll() override { clock += reportUs; reports++; }
+  int64_t now() override { return clock; }
+  void waitUntil(int64_t time) override {
+    if (time > clock) {
+      delayed += time - clock;
+      clock = time;
+    }
+  }
+
+  int64_t clock = 0;
+  int64_t delayed = 0;
+  uint64_t chars = 0;
+  uint64_t reports = 0;
+
+private:
+  int64_t charUs;
+  int64_t reportUs;
+};
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <script.bin> [--char-us N] [--report-us N] [--runs N]\n", argv[0]);
+    return 2;
+  }
+
+  int64_t charUs = 6000;
+  int64_t reportUs = 1000;
+  long runs = 1000;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "--char-us")) {
+      charUs = atoll(argv[i + 1]);
+    }
+    else if (!strcmp(argv[i], "--report-us")) {
+      reportUs = atoll(argv[i + 1]);
+    }
+    else if (!strcmp(argv[i], "--runs")) {
+      runs = atol(argv[i + 1]);
+    }
+  }
+
+  FILE* file = fopen(argv[1], "rb");
+  if (file == nullptr) {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<uint8_t> code(DuckyVM::MAX_CODE + 1);
+  size_t length = fread(code.data(), 1, code.size(), file);
+  fclose(file);
+
+  DuckyVM vm;
+  DuckyStatus status = vm.load(code.data(), length);
+  if (status != DUCKY_OK) {
+    fprintf(stderr, "%s: %s\n", argv[1], statusNames[status]);
+    return 1;
+  }
+
+  // One pass with the device timing model
+  SimulatedHost device(charUs, reportUs);
+  status = vm.run(device);
+  printf("status:      %s\n", statusNames[status]);
+  printf("code:        %zu bytes\n", length);
+  printf("characters:  %llu\n", (unsigned long long)device.chars);
+  printf("key reports: %llu\n", (unsigned long long)device.reports);
+  printf("delays:      %.3f ms\n", device.delayed / 1000.0);
+  printf("runtime:     %.3f ms on the device\n", device.clock / 1000.0);
+
+  // Interpreter overhead alone, with typing and delays free
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < runs; i++) {
+    SimulatedHost host(0, 0);
+    vm.run(host);
+  }
+  auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+  printf("interpreter: %.3f us per run (%ld runs)\n", runs > 0 ? elapsed.count() / runs : 0.0, runs);
+
+  return status == DUCKY_OK ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// Replays the receiver's advertising schedule against a simulated scanning client
+// Reports how long a dropped client takes to hear the receiver again, against NimBLE's default advertising
+//
+// Usage: reconnectBench [--scan-interval-ms N] [--scan-window-ms N] [--rescan-ms N] [--directed] [--runs N]
+//   --scan-interval-ms  client scan interval (default 100)
+//   --scan-window-ms    time the client listens each interval (default 50)
+//   --rescan-ms         time after the drop the client starts looking (default: a sweep from 0 to 60 s)
+//   --directed          the client has a stable address and reconnects by itself, so directed advertising reaches it
+//   --runs              random scan phases and advertising delays to average (default 1000)
+//
+// The controller is assumed to advertise at the top of each tier's interval range, plus the 0 - 10 ms
+// random delay the spec adds to every event. Times are to the first advertisement the client hears,
+// the connection itself takes a few more connection intervals.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "AdvertisingSchedule.h"
+
+static const int64_t LIMIT_US = 600000000;          // Give up after 10 minutes
+static const int64_t DIRECTED_EVENT_US = 3750;      // High duty cycle directed advertising repeats at least this often
+static const int64_t ADV_DELAY_MAX_US = 10000;      // Random delay added to every advertising event
+static const int64_t DEFAULT_INTERVAL_US = 60000;   // NimBLE's connectable default, 30 - 60 ms
+
+// A client scanning <windowUs> out of every <intervalUs> from <startUs>
+struct Scanner {
+  int64_t startUs;
+  int64_t intervalUs;
+  int64_t windowUs;
+
+  bool hears(int64_t time) const {
+    return time >= startUs && (time - startUs) % intervalUs < windowUs;
+  }
+};
+
+// Time of the first tiered advertising event the scanner hears, -1 if none within LIMIT_US
+static int64_t tieredHeard(const Scanner& scanner, bool directed, std::mt19937& rng) {
+  std::uniform_int_distribution<int64_t> advDelay(0, ADV_DELAY_MAX_US);
+  AdvertisingSchedule schedule;
+  schedule.start(AdvertisingSchedule::ADV_DIRECTED, directed);
+
+  int64_t tierStart = 0;
+  while (tierStart < LIMIT_US) {
+    const AdvertisingTier& tier = schedule.params();
+    int64_t tierEnd = tier.durationMs > 0 ? tierStart + (int64_t)tier.durationMs * 1000 : LIMIT_US;
+
+    for (int64_t event = tierStart; event < tierEnd && event < LIMIT_US;) {
+      if (scanner.hears(event)) {
+        return event;
+      }
+      event += tier.directed ? DIRECTED_EVENT_US : (int64_t)tier.intervalMax * 625 + advDelay(rng);
+    }
+
+    tierStart = tierEnd;
+    schedule.expired();
+  }
+  return -1;
+}
+
+// Time of the first default advertising event the scanner hears
+static int64_t defaultHeard(const Scanner& scanner, std::mt19937& rng) {
+  std::uniform_int_distribution<int64_t> advDelay(0, ADV_DELAY_MAX_US);
+  for (int64_t event = 0; event < LIMIT_US; event += DEFAULT_INTERVAL_US + advDelay(rng)) {
+    if (scanner.hears(event)) {
+      return event;
+    }
+  }
+  return -1;
+}
+
+// Mean, 95th percentile and worst case of the time from the client starting to look to hearing the receiver
+static void report(const char* name, std::vector<int64_t>& waits) {
+  if (waits.empty()) {
+    printf("  %-8s  never heard\n", name);
+    return;
+  }
+  std::sort(waits.begin(), waits.end());
+  double mean = 0;
+  for (int64_t wait : waits) {
+    mean += wait;
+  }
+  mean /= waits.size();
+  printf("  %-8s  mean %9.1f ms   p95 %9.1f ms   max %9.1f ms\n", name,
+         mean / 1000.0, waits[waits.size() * 95 / 100] / 1000.0, waits.back() / 1000.0);
+}
+
+// Advertising events sent in the first <windowUs> after the drop, the schedule's radio cost
+static long tieredEvents(int64_t windowUs, bool directed) {
+  AdvertisingSchedule schedule;
+  schedule.start(AdvertisingSchedule::ADV_DIRECTED, directed);
+  long events = 0;
+  int64_t tierStart = 0;
+  while (tierStart < windowUs) {
+    const AdvertisingTier& tier = schedule.params();
+    int64_t tierEnd = std::min(tier.durationMs > 0 ? tierStart + (int64_t)tier.durationMs * 1000 : windowUs, windowUs);
+    int64_t step = tier.directed ? DIRECTED_EVENT_US : (int64_t)tier.intervalMax * 625 + ADV_DELAY_MAX_US / 2;
+    events += (tierEnd - tierStart + step - 1) / step;
+    tierStart = tierEnd;
+    schedule.expired();
+  }
+  return events;
+}
+
+int main(int argc, char** argv) {
+  int64_t scanIntervalUs = 100000;
+  int64_t scanWindowUs = 50000;
+  std::vector<int64_t> rescans = { 0, 1000000, 5000000, 10000000, 30000000, 60000000 };
+  bool directed = false;
+  long runs = 1000;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--directed")) {
+      directed = true;
+    }
+    else if (i + 1 >= argc) {
+      fprintf(stderr, "usage: %s [--scan-interval-ms N] [--scan-window-ms N] [--rescan-ms N] [--directed] [--runs N]\n", argv[0]);
+      return 2;
+    }
+    else if (!strcmp(argv[i], "--scan-interval-ms")) {
+      scanIntervalUs = atoll(argv[++i]) * 1000;
+    }
+    else if (!strcmp(argv[i], "--scan-window-ms")) {
+      scanWindowUs = atoll(argv[++i]) * 1000;
+    }
+    else if (!strcmp(argv[i], "--rescan-ms")) {
+      rescans = { atoll(argv[++i]) * 1000 };
+    }
+    else if (!strcmp(argv[i], "--runs")) {
+      runs = atol(argv[++i]);
+    }
+  }
+
+  if (scanIntervalUs <= 0 || scanWindowUs <= 0 || scanWindowUs > scanIntervalUs) {
+    fprintf(stderr, "the scan window must be positive and fit in the scan interval\n");
+    return 2;
+  }
+
+  printf("scan:        %.1f ms every %.1f ms\n", scanWindowUs / 1000.0, scanIntervalUs / 1000.0);
+  printf("client:      %s\n", directed ? "stable address, reconnects by itself" : "rediscovers by scanning");
+  printf("first 60 s:  %ld advertising events tiered, %ld default\n",
+         tieredEvents(60000000, directed), (long)(60000000 / (DEFAULT_INTERVAL_US + ADV_DELAY_MAX_US / 2)));
+
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int64_t> phase(0, scanIntervalUs - 1);
+  for (int64_t rescan : rescans) {
+    std::vector<int64_t> tiered;
+    std::vector<int64_t> fallback;
+    for (long run = 0; run < runs; run++) {
+      Scanner scanner = { rescan + phase(rng), scanIntervalUs, scanWindowUs };
+      int64_t heard = tieredHeard(scanner, directed, rng);
+      if (heard >= 0) {
+        tiered.push_back(heard - scanner.startUs);
+      }
+      heard = defaultHeard(scanner, rng);
+      if (heard >= 0) {
+        fallback.push_back(heard - scanner.startUs);
+      }
+    }
+
+    printf("client looks %.0f s after the drop:\n", rescan / 1000000.0);
+    report("tiered", tiered);
+    report("default", fallback);
+  }
+  return 0;
+}
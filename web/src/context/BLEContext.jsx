@@ -7,8 +7,11 @@ import React, {
 } from "react";
 import { keyExists, loadBase64 } from "../services/localSecurity/EncryptedStorage.js";
 import { ECDHContext } from "./ECDHContext.jsx";
-import { createUnencryptedPacket, unpackResponsePacket } from "../services/packetService/packetFunctions.js";
+import { createUnencryptedPacket, unpackResponsePacket, packMouseFrames, createKeyboardStream, createPasteStream, Capability } from "../services/packetService/packetFunctions.js";
+import { LeanRecord, LEAN_FLAG_SLOW_MODE, HEADER_SIZE as LEAN_HEADER_SIZE, encodeLeanRecords, leanMouseValue, createLeanFrame } from "../services/packetService/leanFrame.js";
 import { PacketQueue } from "../services/packetService/PacketQueue.js";
+import { RetransmitWindow, RESEND_TIMEOUT_MS } from "../services/packetService/retransmitWindow.js";
+import { ResumeTicket, resumeAad } from "../services/packetService/resumeTicket.js";
 import { create, toBinary, fromBinary } from "@bufbuild/protobuf";
 
 import * as ToothPacketPB from '../services/packetService/toothpacket/toothpacket_pb.js';
@@ -17,6 +20,8 @@ import * as ToothPacketPB from '../services/packetService/toothpacket/toothpacke
 export const BLEContext = createContext();
 export const useBLEContext = () => useContext(BLEContext);
 export const supportedFirmwareVersions = ["0.9.0^"]; // Supported firmware versions for compatibility checks
+const RESUME_TIMEOUT_MS = 1000; // Authenticate instead if a RESUME_PACKET gets no answer
+const PASTE_BATCH_CHUNKS = 8; // Paste chunks handed to sendEncrypted at a time, a new session can stop the paste between batches
 
 export const ConnectionStatus = {
         disconnected: 0,
@@ -42,14 +47,117 @@ export function BLEProvider({ children }) {
     const pktCharRef = useRef(null);
 
     
-    const { loadKeys, createEncryptedPackets } = useContext(ECDHContext);
+    const { loadKeys, createEncryptedPackets, encryptText, sessionKey, resumeSessionKey } = useContext(ECDHContext);
     const readyToReceive = useRef({ promise: null, resolve: null });
 
+    // What the receiver supports, from its CHALLENGE
+    const capabilities = useRef(null);
+
+    // Sequenced writes not acknowledged yet, resent when a SACK shows them missing or SACKs stop coming
+    const retransmitWindow = useRef(new RetransmitWindow());
+    const windowWaiters = useRef([]);
+    const resendTimer = useRef(null);
+    const writeChain = useRef(Promise.resolve());
+
+    // Tickets to resume a dropped session without authenticating, by device MAC address
+    const resumeTickets = useRef(new Map());
+    const resumeTimer = useRef(null);
+
+    // Bulk paste being typed, { id, bytes, typed, macAddress }, and the session count it is being sent in
+    const paste = useRef(null);
+    const sessionCount = useRef(0);
+
+    // Write bytes to the input characteristic, writes are chained so a resend never overlaps a send
+    const writePacket = (bytes) => {
+        const write = writeChain.current.then(() => pktCharRef.current.writeValueWithoutResponse(bytes));
+        writeChain.current = write.catch(() => {});
+        return write;
+    };
+
+    // Whether the receiver acknowledges sequenced writes
+    const sequencing = () => Boolean((capabilities.current?.features ?? 0) & Capability.SACK);
+
+    // Whether input goes out as lean frames, which are always sequenced
+    const leanFrames = () => sequencing() && Boolean((capabilities.current?.wireFormats ?? 0) & Capability.WIRE_LEAN);
+
+    // Lean record for a payload, mouse motion goes as packed frames and everything else as its serialized EncryptedData
+    const leanRecord = (payload) => {
+        if (payload.packetData.case === "mousePacket") {
+            const mouse = payload.packetData.value;
+            return {
+                type: LeanRecord.MOUSE,
+                value: leanMouseValue(packMouseFrames(mouse.frames), { leftClick: mouse.lClick, rightClick: mouse.rClick, wheel: mouse.wheel }),
+            };
+        }
+        return { type: LeanRecord.PROTOBUF, value: toBinary(ToothPacketPB.EncryptedDataSchema, payload) };
+    };
+
+    // Group payloads into as few lean frame bodies as the receiver's write size allows, records keep their order
+    const leanBodies = (payloads) => {
+        const budget = (capabilities.current?.maxWriteSize ?? 0) - LEAN_HEADER_SIZE;
+        const bodies = [];
+        let records = [];
+        let size = 0;
+        for (const payload of payloads) {
+            const record = leanRecord(payload);
+            const recordSize = 3 + record.value.length;
+            if (records.length > 0 && size + recordSize > budget) {
+                bodies.push(encodeLeanRecords(records));
+                records = [];
+                size = 0;
+            }
+            records.push(record);
+            size += recordSize;
+        }
+        if (records.length > 0) {
+            bodies.push(encodeLeanRecords(records));
+        }
+        return bodies;
+    };
+
+    // Wait until the receiver's reorder window has room for another write
+    const windowOpen = async () => {
+        while (!retransmitWindow.current.canSend()) {
+            await new Promise((resolve) => windowWaiters.current.push(resolve));
+        }
+    };
+
+    const wakeWindowWaiters = () => {
+        const waiters = windowWaiters.current;
+        windowWaiters.current = [];
+        waiters.forEach((resolve) => resolve());
+    };
+
+    // Writes lost after the last one the receiver holds never show up in a SACK, resend them all if nothing is acknowledged for a while
+    const armResend = () => {
+        clearTimeout(resendTimer.current);
+        resendTimer.current = setTimeout(() => {
+            const pending = retransmitWindow.current.pending();
+            if (pending.length === 0 || !pktCharRef.current) return;
+            pending.forEach((write) => writePacket(write).catch((error) => console.error("Error resending packet", error)));
+            armResend();
+        }, RESEND_TIMEOUT_MS);
+    };
+
+    // Start numbering writes from 0 again, the receiver does the same for every new session
+    const resetSequencing = () => {
+        clearTimeout(resendTimer.current);
+        retransmitWindow.current.reset();
+        wakeWindowWaiters();
+    };
+
+    // Encrypt a payload into one DataPacket, authenticated with its sequence number when it has one
+    const encodePacket = async (payload, sequence) => {
+        for await (const packet of createEncryptedPackets(0, payload, true, 0, sequence)) {
+            return toBinary(ToothPacketPB.DataPacketSchema, packet);
+        }
+    };
+
     // Send a text string as a byte array without encryption
     const sendUnencrypted = async (inputString) => {
         try {
             const packetData = createUnencryptedPacket(inputString);
-            await pktCharRef.current.writeValueWithoutResponse(packetData);
+            await writePacket(packetData);
         } catch (error) {
             console.error("Error sending AUTH packet", error);
         }
@@ -60,7 +168,7 @@ export function BLEProvider({ children }) {
     // Uses a FIFO queue where encryption produces packets and sending consumes them concurrently
     // (encoding into protobuf must be done by the calling function)
     const sendEncrypted = async (inputPayload, prefix=0) => {
-        if (!pktCharacteristic) return;
+        if (!pktCharRef.current) return;
 
         // Create a packet queue to hold encrypted packets before sending
         const packetQueue = new PacketQueue();
@@ -70,11 +178,25 @@ export function BLEProvider({ children }) {
             const payloads = Array.isArray(inputPayload) ? inputPayload : [inputPayload];
             
             // Producer: Encrypt payloads and enqueue them
+            // Sequenced writes wait for room in the receiver's window and are kept until it acknowledges them
             const producerTask = (async () => {
                 try {
-                    for (const payload of payloads) {
-                        for await (const packet of createEncryptedPackets(0, payload, true, prefix)) {
-                            packetQueue.enqueue(packet);
+                    if (leanFrames()) {
+                        for (const body of leanBodies(payloads)) {
+                            await windowOpen();
+                            packetQueue.enqueue(await retransmitWindow.current.next(
+                                (sequence) => createLeanFrame(sessionKey(), body, sequence, LEAN_FLAG_SLOW_MODE)));
+                        }
+                    }
+                    else {
+                        for (const payload of payloads) {
+                            if (sequencing()) {
+                                await windowOpen();
+                                packetQueue.enqueue(await retransmitWindow.current.next((sequence) => encodePacket(payload, sequence)));
+                            }
+                            else {
+                                packetQueue.enqueue(await encodePacket(payload));
+                            }
                         }
                     }
                 } finally {
@@ -88,10 +210,11 @@ export function BLEProvider({ children }) {
                     const packet = await packetQueue.dequeue();
                     if (packet === null) break;
                     
-                    // Each packet is a ToothPaste DataPacket object with encryptedData component
-                    await pktCharacteristic.writeValueWithoutResponse(
-                        toBinary(ToothPacketPB.DataPacketSchema, packet)
-                    );
+                    // Each packet is a serialized ToothPaste DataPacket or a lean frame
+                    await writePacket(packet);
+                    if (sequencing()) {
+                        armResend();
+                    }
                 }
             })();
 
@@ -103,6 +226,60 @@ export function BLEProvider({ children }) {
         }
     };
 
+    // Send a paste's chunks from byte <offset>, stopping if another paste replaces it or a new session restarts it
+    const streamPaste = async (current, offset) => {
+        const session = sessionCount.current;
+        const compress = Boolean((capabilities.current?.compression ?? 0) & Capability.COMPRESSION_LZ);
+        const chunks = createPasteStream(current.bytes, current.id, offset, compress);
+        for (let i = 0; i < chunks.length; i += PASTE_BATCH_CHUNKS) {
+            if (paste.current !== current || sessionCount.current !== session) return;
+            await sendEncrypted(chunks.slice(i, i + PASTE_BATCH_CHUNKS));
+        }
+    };
+
+    // Paste text as a resumable bulk paste, a dropped connection picks up at the last byte the device typed
+    // Receivers that can't resume pastes get plain keyboard packets
+    const sendPaste = async (text) => {
+        if (!((capabilities.current?.features ?? 0) & Capability.PASTE_RESUME)) {
+            await sendEncrypted(createKeyboardStream(text));
+            return;
+        }
+
+        const current = {
+            id: crypto.getRandomValues(new Uint32Array(1))[0] || 1, // 0 means no paste
+            bytes: new TextEncoder().encode(text),
+            typed: 0,
+            macAddress: device?.macAddress,
+        };
+        paste.current = current;
+        await streamPaste(current, 0);
+    };
+
+    // Note how far the device got with the paste, every response carries its position
+    const trackPaste = (responsePacket) => {
+        const current = paste.current;
+        if (!current || responsePacket.pasteId !== current.id) return;
+
+        current.typed = Math.max(current.typed, responsePacket.pasteOffset);
+        if (current.typed >= current.bytes.length) {
+            paste.current = null; // Done
+        }
+    };
+
+    // Restart an unfinished paste in a new session, from the device's offset (or the last one it reported if it lost the paste)
+    const resumePaste = (device, responsePacket) => {
+        const current = paste.current;
+        if (!current || current.macAddress !== device.macAddress) return;
+
+        const offset = responsePacket.pasteId === current.id ? responsePacket.pasteOffset : current.typed;
+        if (offset >= current.bytes.length) {
+            paste.current = null;
+            return;
+        }
+        console.log("Resuming paste at byte", offset);
+        streamPaste(current, offset);
+    };
+
     // Try to load the self public key from storage and send it unencrypted
     const sendAuth = async (device) => {
         if (!pktCharRef.current) return;
@@ -120,6 +297,44 @@ export function BLEProvider({ children }) {
         }
     };
 
+    // Resume the device's dropped session with its ticket, false if there is none to use
+    // The RESUME_PACKET carries an empty write, writes the device never acknowledged are resent once it answers RESUMED
+    const sendResume = async (device) => {
+        const taken = resumeTickets.current.get(device.macAddress)?.take();
+        if (!taken || !pktCharRef.current) return false;
+
+        try {
+            resumeSessionKey(taken.aesKey);
+            capabilities.current = taken.capabilities;
+
+            const sequence = retransmitWindow.current.skip();
+            const packet = await encryptText(new Uint8Array(0), resumeAad(taken.ticket, sequence));
+            packet.packetID = ToothPacketPB.DataPacket_PacketID.RESUME_PACKET;
+            packet.slowMode = true;
+            packet.packetNumber = 1;
+            packet.totalPackets = 1;
+            packet.sequence = sequence;
+            packet.resumeTicket = taken.ticket;
+
+            clearTimeout(resumeTimer.current);
+            resumeTimer.current = setTimeout(() => sendAuth(device), RESUME_TIMEOUT_MS);
+            await writePacket(toBinary(ToothPacketPB.DataPacketSchema, packet));
+            return true;
+        } catch (error) {
+            console.error("Error sending RESUME packet", error);
+            clearTimeout(resumeTimer.current);
+            return false;
+        }
+    };
+
+    // Keep the ticket from a CHALLENGE or RESUMED, it resumes the session if the connection drops
+    const saveResumeTicket = (device, ticket) => {
+        if (!resumeTickets.current.has(device.macAddress)) {
+            resumeTickets.current.set(device.macAddress, new ResumeTicket());
+        }
+        resumeTickets.current.get(device.macAddress).save(ticket, sessionKey(), capabilities.current);
+    };
+
     // Subscribe to the semaphore notification and attach its event listener
     const subscribeToResponse = async (responseChar, deviceObj) => {
         try {
@@ -132,10 +347,43 @@ export function BLEProvider({ children }) {
                 const base64String = btoa(String.fromCharCode.apply(null, bytesArray));
 
                 var responsePacket = unpackResponsePacket(bytesArray);
+                trackPaste(responsePacket);
                 
                 if (responsePacket.responseType === ToothPacketPB.ResponsePacket_ResponseType.CHALLENGE) {
                         await loadKeys(deviceObj.macAddress, responsePacket.challengeData);
+                    clearTimeout(resumeTimer.current);
+                    capabilities.current = responsePacket.capabilities ?? null;
+                    resetSequencing(); // A new session numbers its writes from 0
+                    saveResumeTicket(deviceObj, responsePacket.resumeTicket);
+                    setStatus(ConnectionStatus.ready);
+
+                    // Writes of the old session are gone, a paste it was sending starts over from where the device got to
+                    sessionCount.current++;
+                    resumePaste(deviceObj, responsePacket);
+                }
+
+                else if (responsePacket.responseType === ToothPacketPB.ResponsePacket_ResponseType.RESUMED) {
+                    console.log("Session resumed");
+                    clearTimeout(resumeTimer.current);
+                    saveResumeTicket(deviceObj, responsePacket.resumeTicket);
                     setStatus(ConnectionStatus.ready);
+
+                    // The device dropped whatever it had not applied, send those writes again
+                    retransmitWindow.current.pending().forEach((write) => writePacket(write).catch((error) => console.error("Error resending packet", error)));
+                    armResend();
+                }
+
+                else if (responsePacket.responseType === ToothPacketPB.ResponsePacket_ResponseType.RESUME_FAILED) {
+                    console.log("Session resume refused, authenticating");
+                    clearTimeout(resumeTimer.current);
+                    await sendAuth(deviceObj);
+                }
+
+                else if (responsePacket.responseType === ToothPacketPB.ResponsePacket_ResponseType.SACK) {
+                    const resend = retransmitWindow.current.onSack(responsePacket.ackSequence, responsePacket.sackBits);
+                    resend.forEach((write) => writePacket(write).catch((error) => console.error("Error resending packet", error)));
+                    wakeWindowWaiters();
+                    armResend();
                 }
 
                 else if (responsePacket.responseType === ToothPacketPB.ResponsePacket_ResponseType.PEER_KNOWN) {
@@ -181,6 +429,9 @@ export function BLEProvider({ children }) {
 
             // Set an on disconnect listener
             device.addEventListener("gattserverdisconnected", () => {  
+                clearTimeout(resendTimer.current); // Nothing can be resent until the next session
+                clearTimeout(resumeTimer.current);
+                resumeTickets.current.get(device.macAddress)?.dropped(); // The ticket lapses a while after the drop
                 setStatus(ConnectionStatus.disconnected); // Set status to disconnected
                 setDevice(null); // Clear the device object, not doing this causes inconsistent connections when trying to reconnect
 
@@ -222,8 +473,8 @@ export function BLEProvider({ children }) {
                 setStatus(ConnectionStatus.connected);
             }
 
-            // Else send auth and wait for semaphore to receive salt before loading keys
-            else {
+            // Else resume the dropped session if it is still fresh, or send auth and wait for semaphore to receive salt before loading keys
+            else if (!(await sendResume(device))) {
                 await sendAuth(device);
             }
             
@@ -271,7 +522,9 @@ export function BLEProvider({ children }) {
         readyToReceive,
         sendEncrypted,
         sendUnencrypted,
-    }), [device, server, pktCharacteristic, status, connectToDevice, readyToReceive, sendEncrypted, sendUnencrypted]);
+        sendPaste,
+        capabilities,
+    }), [device, server, pktCharacteristic, status, connectToDevice, readyToReceive, sendEncrypted, sendUnencrypted, sendPaste]);
 
     return (
         <BLEContext.Provider value={contextValue}>
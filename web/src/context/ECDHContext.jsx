@@ -4,6 +4,7 @@ import { ec as EC } from "elliptic";
 import { create, toBinary, fromBinary } from "@bufbuild/protobuf";
 
 import * as ToothPacketPB from '../services/packetService/toothpacket/toothpacket_pb.js';
+import { sequenceAad } from '../services/packetService/retransmitWindow.js';
 
 const ec = new EC("p256"); // Define the elliptic curve (secp256r1)
 
@@ -259,7 +260,7 @@ export const ECDHProvider = ({ children }) => {
      * Encrypt data using AES-GCM with the derived shared secret key
      * Generates random 12-byte IV and returns authentication tag separately
      * @param {string|Uint8Array} unEncryptedData - Data to encrypt
-     * @param {ArrayBuffer} [aad] - Additional authenticated data (unused but available for integrity checking)
+     * @param {Uint8Array} [aad] - Additional authenticated data, the receiver must decrypt with the same bytes
      * @returns {Promise<Object>} DataPacket with encryptedData, IV, tag, and metadata
      */
     const encryptText = async (unEncryptedData, aad) => {
@@ -267,7 +268,7 @@ export const ECDHProvider = ({ children }) => {
         const data = unEncryptedData instanceof Uint8Array ? unEncryptedData : new TextEncoder().encode(unEncryptedData);
 
         const encryptedBytes = new Uint8Array(await crypto.subtle.encrypt(
-            { name: "AES-GCM", iv },
+            aad ? { name: "AES-GCM", iv, additionalData: aad } : { name: "AES-GCM", iv },
             aesKey.current,
             data
         ));
@@ -322,19 +323,24 @@ export const ECDHProvider = ({ children }) => {
      * @param {Object} payload - Protobuf EncryptedData object to encrypt
      * @param {boolean} [slowMode=true] - Whether to use slow transmission mode
      * @param {number} [packetPrefix=0] - Prefix byte for packet identification
+     * @param {number} [sequence] - Sequence number from the RetransmitWindow, authenticated as additional data
      * @yields {Object} DataPacket with encryptedData, IV, tag, and metadata
      */
-    const createEncryptedPackets = async function* (packetId, payload, slowMode = true, packetPrefix=0) {
+    const createEncryptedPackets = async function* (packetId, payload, slowMode = true, packetPrefix=0, sequence=undefined) {
         
         // Convert the protobuf payload to a byte array for encryption
         const toothPacketBinary = toBinary(ToothPacketPB.EncryptedDataSchema, payload);
         
         // Encrypt the encryptedData component of a ToothPacket and get DataPacket
-        const encryptedPacket = await encryptText(toothPacketBinary, null); 
+        const sequenced = sequence !== undefined;
+        const encryptedPacket = await encryptText(toothPacketBinary, sequenced ? sequenceAad(sequence) : null); 
         
         // Set packet metadata
         encryptedPacket.packetID = packetId;
         encryptedPacket.slowMode = slowMode;
+        if (sequenced) {
+            encryptedPacket.sequence = sequence;
+        }
 
         // Not used for now
         encryptedPacket.packetNumber = 1;
@@ -343,6 +349,20 @@ export const ECDHProvider = ({ children }) => {
         yield encryptedPacket;
     };
 
+    /**
+     * AES key of the current session, for writes encrypted outside createEncryptedPackets (lean frames)
+     * @returns {CryptoKey|null}
+     */
+    const sessionKey = () => aesKey.current;
+
+    /**
+     * Continue a resumed session with the key it had before the drop
+     * @param {CryptoKey} key - From the session's ResumeTicket
+     */
+    const resumeSessionKey = (key) => {
+        aesKey.current = key;
+    };
+
     /**
      * Load previously saved keys from IndexedDB storage for a device
      * Restores shared secret and derives AES key using HKDF with provided salt
@@ -430,6 +450,8 @@ export const ECDHProvider = ({ children }) => {
         decryptText,
         createEncryptedPackets,
         loadKeys,
+        sessionKey,
+        resumeSessionKey,
         processPeerKeyAndGenerateSharedSecret,
     }), []);
 
@@ -0,0 +1,225 @@
+/**
+ * DuckyscriptCompiler.js
+ *
+ * Compiles duckyscript to the receiver's bytecode (firmware/components/duckyVM/DuckyVM.h)
+ * so DELAY is timed on the device instead of between BLE writes
+ */
+
+import { parseDuckyscript, ValidCommands } from './DuckyscriptParser';
+
+const HEADER = [0x44, 0x4B, 1, 0]; // 'D' 'K' version 1
+
+const Op = {
+    END: 0,
+    STRING: 1,
+    DELAY: 2,
+    DEFAULT_DELAY: 3,
+    PRESS: 4,
+    RELEASE: 5,
+    TAP: 6,
+    RELEASE_ALL: 7,
+    REPEAT: 8,
+};
+
+export const MAX_SCRIPT_BYTES = 4096; // DuckyVM::MAX_CODE
+export const SCRIPT_CHUNK_BYTES = 180; // toothpaste.ScriptPacket.code
+
+/**
+ * Key names to HID keyboard usages
+ */
+const KeyUsages = {
+    ENTER: 0x28, ESC: 0x29, ESCAPE: 0x29, BACKSPACE: 0x2A, TAB: 0x2B, SPACE: 0x2C,
+    CAPSLOCK: 0x39, PRINTSCREEN: 0x46, SCROLLLOCK: 0x47, PAUSE: 0x48, BREAK: 0x48,
+    INSERT: 0x49, HOME: 0x4A, PAGEUP: 0x4B, DELETE: 0x4C, END: 0x4D, PAGEDOWN: 0x4E,
+    RIGHT: 0x4F, RIGHTARROW: 0x4F, LEFT: 0x50, LEFTARROW: 0x50,
+    DOWN: 0x51, DOWNARROW: 0x51, UP: 0x52, UPARROW: 0x52,
+    NUMLOCK: 0x53, MENU: 0x65, APP: 0x65,
+    CTRL: 0xE0, CONTROL: 0xE0, SHIFT: 0xE1, ALT: 0xE2, OPTION: 0xE2,
+    GUI: 0xE3, WINDOWS: 0xE3, COMMAND: 0xE3,
+};
+
+/**
+ * Resolve a key name (ENTER, CTRL, F5, a, 7) to a HID usage
+ * @param {string} name
+ * @returns {number|null}
+ */
+function keyUsage(name) {
+    const upper = String(name).toUpperCase();
+    if (KeyUsages[upper] !== undefined) {
+        return KeyUsages[upper];
+    }
+
+    const fn = /^F([1-9]|1[0-2])$/.exec(upper);
+    if (fn) {
+        return 0x3A + Number(fn[1]) - 1;
+    }
+    if (/^[A-Z]$/.test(upper)) {
+        return 0x04 + upper.charCodeAt(0) - 65;
+    }
+    if (/^[1-9]$/.test(upper)) {
+        return 0x1E + Number(upper) - 1;
+    }
+    if (upper === '0') {
+        return 0x27;
+    }
+    return null;
+}
+
+/**
+ * Append an unsigned LEB128 varint
+ */
+function pushVarint(out, value) {
+    let v = Math.max(0, Math.min(0xFFFFFFFF, Math.round(value)));
+    do {
+        let byte = v & 0x7F;
+        v = Math.floor(v / 128);
+        if (v > 0) {
+            byte |= 0x80;
+        }
+        out.push(byte);
+    } while (v > 0);
+}
+
+/**
+ * Text after the command keyword on a source line, quoted text is unescaped by the parser
+ */
+function stringArgument(node, lines) {
+    if (node.args.length === 1 && node.args[0].type === 'String') {
+        return node.args[0].value;
+    }
+    const line = lines[node.line - 1].trim();
+    return line.replace(/^\S+\s?/, '');
+}
+
+/**
+ * Compile duckyscript to receiver bytecode
+ * @param {string} content - Raw duckyscript content
+ * @returns {Object} - { code: Uint8Array|null, errors }
+ */
+export function compileDuckyscript(content) {
+    const { ast, errors } = parseDuckyscript(content);
+    const lines = content.split('\n');
+    const compileErrors = [...errors];
+    const out = [...HEADER];
+    const encoder = new TextEncoder();
+    let lastStart = -1; // Start of the last command, for REPEAT
+
+    const keys = (node) => {
+        const usages = [];
+        for (const arg of node.args) {
+            const usage = keyUsage(arg.value);
+            if (usage === null) {
+                compileErrors.push({ line: node.line, message: `Unknown key: ${arg.value}`, command: node.command });
+            } else {
+                usages.push(usage);
+            }
+        }
+        return usages;
+    };
+
+    for (const node of ast) {
+        if (node.type !== 'Command') continue;
+        const start = out.length;
+
+        switch (node.command) {
+            case ValidCommands.STRING: {
+                // Split at character boundaries into 255 byte STRING opcodes
+                const bytes = encoder.encode(stringArgument(node, lines));
+                let pos = 0;
+                while (pos < bytes.length) {
+                    let end = Math.min(pos + 255, bytes.length);
+                    while (end < bytes.length && (bytes[end] & 0xC0) === 0x80) {
+                        end--;
+                    }
+                    out.push(Op.STRING, end - pos, ...bytes.subarray(pos, end));
+                    pos = end;
+                }
+                break;
+            }
+
+            case ValidCommands.DELAY:
+                out.push(Op.DELAY);
+                pushVarint(out, (node.args[0]?.value || 0) * 1000); // ms to us
+                break;
+
+            case ValidCommands.DEFAULT_DELAY:
+                out.push(Op.DEFAULT_DELAY);
+                pushVarint(out, (node.args[0]?.value || 0) * 1000);
+                break;
+
+            case ValidCommands.PRESS:
+            case ValidCommands.HOLD:
+                for (const usage of keys(node)) {
+                    out.push(Op.PRESS, usage);
+                }
+                break;
+
+            case ValidCommands.RELEASE: {
+                const usages = keys(node);
+                if (node.args.length === 0) {
+                    out.push(Op.RELEASE_ALL);
+                }
+                for (const usage of usages) {
+                    out.push(Op.RELEASE, usage);
+                }
+                break;
+            }
+
+            case ValidCommands.TAP: {
+                const usages = keys(node);
+                out.push(Op.TAP, usages.length, ...usages);
+                break;
+            }
+
+            case ValidCommands.REPEAT:
+                if (lastStart < 0) {
+                    compileErrors.push({ line: node.line, message: 'REPEAT has no command to repeat', command: node.command });
+                    break;
+                }
+                out.push(Op.REPEAT);
+                pushVarint(out, node.args[0]?.value || 0);
+                pushVarint(out, start - lastStart);
+                continue; // REPEAT itself is never the command repeated
+
+            case ValidCommands.REM:
+            case ValidCommands.EXTENSION:
+                continue;
+
+            default:
+                compileErrors.push({ line: node.line, message: `${node.command} is not supported on the device`, command: node.command });
+                continue;
+        }
+
+        if (out.length > start) {
+            lastStart = start;
+        }
+    }
+
+    out.push(Op.END);
+
+    if (out.length > MAX_SCRIPT_BYTES) {
+        compileErrors.push({ line: lines.length, message: `Script compiles to ${out.length} bytes, the receiver holds ${MAX_SCRIPT_BYTES}` });
+    }
+
+    return {
+        code: compileErrors.length === 0 ? Uint8Array.from(out) : null,
+        errors: compileErrors,
+    };
+}
+
+/**
+ * Split compiled bytecode into ScriptPacket fields
+ * @param {Uint8Array} code
+ * @returns {Array} - [{ offset, code, done }]
+ */
+export function chunkScript(code) {
+    const chunks = [];
+    for (let offset = 0; offset < code.length; offset += SCRIPT_CHUNK_BYTES) {
+        chunks.push({
+            offset,
+            code: code.subarray(offset, offset + SCRIPT_CHUNK_BYTES),
+            done: offset + SCRIPT_CHUNK_BYTES >= code.length,
+        });
+    }
+    return chunks;
+}
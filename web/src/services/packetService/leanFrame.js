@@ -0,0 +1,90 @@
+/**
+ * leanFrame.js
+ *
+ * Builds lean frames, the receiver's fixed-layout alternative to DataPacket
+ * (layout in firmware/components/leanFrame/LeanFrame.h)
+ */
+
+const MAGIC = 0x54;
+const VERSION = 1;
+const FRAME_DATA = 0;
+export const HEADER_SIZE = 36;
+const AAD_SIZE = 8;
+const IV_SIZE = 12;
+const TAG_SIZE = 16;
+
+export const LeanRecord = {
+    PROTOBUF: 0,   // Serialized EncryptedData
+    TEXT: 1,
+    KEYCODE: 2,
+    KEY_EVENTS: 3,
+    MOUSE: 4,
+};
+
+export const LEAN_FLAG_SLOW_MODE = 0x01;
+
+/**
+ * Concatenate records into a frame body
+ * @param {Array} records - [{ type, value: Uint8Array }]
+ * @returns {Uint8Array}
+ */
+export function encodeLeanRecords(records) {
+    const size = records.reduce((total, record) => total + 3 + record.value.length, 0);
+    const body = new Uint8Array(size);
+    let pos = 0;
+    for (const { type, value } of records) {
+        body[pos] = type;
+        body[pos + 1] = value.length & 0xFF;
+        body[pos + 2] = value.length >> 8;
+        body.set(value, pos + 3);
+        pos += 3 + value.length;
+    }
+    return body;
+}
+
+/**
+ * Value of a MOUSE record
+ * @param {Uint8Array} packedFrames - MousePacket.packedFrames encoding
+ * @returns {Uint8Array}
+ */
+export function leanMouseValue(packedFrames, { timed = false, leftClick = 0, rightClick = 0, wheel = 0 } = {}) {
+    const value = new Uint8Array(4 + packedFrames.length);
+    value[0] = timed ? 1 : 0;
+    value[1] = Number(leftClick);
+    value[2] = Number(rightClick);
+    value[3] = Math.max(-128, Math.min(127, Math.round(wheel))) & 0xFF;
+    value.set(packedFrames, 4);
+    return value;
+}
+
+/**
+ * Encrypt a body into a lean frame, the header is authenticated with it
+ * @param {CryptoKey} aesKey - Session AES-GCM key
+ * @param {Uint8Array} body - From encodeLeanRecords
+ * @param {number} sequence - From RetransmitWindow, shared with sequenced DataPackets (wraps at 16 bits)
+ * @param {number} [flags=0]
+ * @returns {Promise<Uint8Array>} - Bytes to write to the input characteristic
+ */
+export async function createLeanFrame(aesKey, body, sequence, flags = 0) {
+    const frame = new Uint8Array(HEADER_SIZE + body.length);
+    frame[0] = MAGIC;
+    frame[1] = VERSION;
+    frame[2] = FRAME_DATA;
+    frame[3] = flags;
+    frame[4] = sequence & 0xFF;
+    frame[5] = (sequence >> 8) & 0xFF;
+    frame[6] = body.length & 0xFF;
+    frame[7] = body.length >> 8;
+
+    const iv = crypto.getRandomValues(new Uint8Array(IV_SIZE));
+    const sealed = new Uint8Array(await crypto.subtle.encrypt(
+        { name: "AES-GCM", iv, additionalData: frame.subarray(0, AAD_SIZE) },
+        aesKey,
+        body
+    ));
+
+    frame.set(iv, AAD_SIZE);
+    frame.set(sealed.subarray(body.length, body.length + TAG_SIZE), AAD_SIZE + IV_SIZE); // WebCrypto appends the tag
+    frame.set(sealed.subarray(0, body.length), HEADER_SIZE);
+    return frame;
+}
@@ -1,5 +1,26 @@
 import { create, toBinary, fromBinary } from "@bufbuild/protobuf";
 import * as ToothPacketPB from './toothpacket/toothpacket_pb.js';
+import { nextPasteChunk } from './textCompression.js';
+import { chunkScript } from '../duckyscript/DuckyscriptCompiler.js';
+
+// Bits of the Capabilities the receiver sends with its CHALLENGE (CAPABILITY_* in firmware/components/ble/ble.h)
+export const Capability = {
+    WIRE_PROTOBUF: 1 << 0,  // wireFormats
+    WIRE_LEAN: 1 << 1,
+    COMPRESSION_LZ: 1 << 0, // compression
+    SCRIPT: 1 << 0,         // features
+    COMPOSITE: 1 << 1,
+    PACKED_MOUSE: 1 << 2,
+    PLAYOUT: 1 << 3,
+    SYNC: 1 << 4,
+    CHORDS: 1 << 5,
+    KEY_EVENTS: 1 << 6,
+    GAMEPAD: 1 << 7,
+    MACROS: 1 << 8,
+    PASTE_RESUME: 1 << 9,
+    SACK: 1 << 10,
+    RESUME: 1 << 11,
+};
 
 // Create an unencrypted DataPacket from an input string
 export function createUnencryptedPacket(inputString) {
@@ -70,6 +91,34 @@ export function createMouseStream(frames, leftClick = false, rightClick = false,
     return encryptedPacket
 }
 
+// Pack mouse frames into the MousePacket.packedFrames encoding
+// One byte per frame while dx fits -7 - 7 and dy -8 - 7 (a -8 dx would read as a 0x8_ token), else 0x80 then zig-zag varint dx, dy
+export function packMouseFrames(frames) {
+    const packed = [];
+    const varint = (value) => {
+        while (value > 0x7F) {
+            packed.push((value & 0x7F) | 0x80);
+            value >>>= 7;
+        }
+        packed.push(value);
+    };
+    const zigzag = (value) => ((value << 1) ^ (value >> 31)) >>> 0;
+
+    for (const frame of frames) {
+        const dx = Math.round(frame.x);
+        const dy = Math.round(frame.y);
+        if (dx >= -7 && dx <= 7 && dy >= -8 && dy <= 7) {
+            packed.push(((dx & 0x0F) << 4) | (dy & 0x0F));
+        }
+        else {
+            packed.push(0x80);
+            varint(zigzag(dx));
+            varint(zigzag(dy));
+        }
+    }
+    return Uint8Array.from(packed);
+}
+
 // Return an EncryptedData packet containing a KeyboardPacket
 export function createKeyboardPacket(keyString) {
 
@@ -118,6 +167,71 @@ export function createKeyboardStream(keyStrings) {
     return packets;
 }
 
+// Bytes of a bulk paste per KeyboardPacket
+const PASTE_CHUNK_BYTES = 100;
+
+// End of the chunk of <bytes> from <offset>, at most <length> bytes and on a UTF-8 character boundary
+function pasteChunkEnd(bytes, offset, length) {
+    let end = Math.min(offset + length, bytes.length);
+    while (end > offset + 1 && end < bytes.length && (bytes[end] & 0xC0) === 0x80) {
+        end--;
+    }
+    return end;
+}
+
+// Return EncryptedData packets typing a bulk paste from byte <offset>
+// Every chunk carries the paste id and its byte offset, so the device can skip what it already typed after a reconnect
+// With <compress> (the receiver's LZ capability) a chunk is LZ compressed whenever that carries more text than a plain one
+export function createPasteStream(bytes, pasteId, offset = 0, compress = false) {
+    const decoder = new TextDecoder();
+    const packets = [];
+
+    while (offset < bytes.length) {
+        const { end, compressed } = compress ? nextPasteChunk(bytes, offset, PASTE_CHUNK_BYTES)
+                                             : { end: pasteChunkEnd(bytes, offset, PASTE_CHUNK_BYTES), compressed: null };
+
+        const keyboardPacket = create(ToothPacketPB.KeyboardPacketSchema, {});
+        if (compressed) {
+            keyboardPacket.compressed = compressed;
+        }
+        else {
+            keyboardPacket.message = decoder.decode(bytes.subarray(offset, end));
+        }
+        keyboardPacket.length = end - offset;
+        keyboardPacket.pasteId = pasteId;
+        keyboardPacket.pasteOffset = offset;
+
+        packets.push(create(ToothPacketPB.EncryptedDataSchema, {
+            packetType: ToothPacketPB.EncryptedData_PacketType.KEYBOARD_STRING,
+            packetData: {
+                case: "keyboardPacket",
+                value: keyboardPacket,
+            },
+        }));
+        offset = end;
+    }
+
+    return packets;
+}
+
+// Return EncryptedData packets uploading compiled Duckyscript bytecode, the receiver runs it once the last chunk arrives
+export function createScriptStream(code) {
+    return chunkScript(code).map(({ offset, code: chunk, done }) => {
+        const scriptPacket = create(ToothPacketPB.ScriptPacketSchema, {});
+        scriptPacket.offset = offset;
+        scriptPacket.code = chunk;
+        scriptPacket.done = done;
+
+        return create(ToothPacketPB.EncryptedDataSchema, {
+            packetType: ToothPacketPB.EncryptedData_PacketType.SCRIPT,
+            packetData: {
+                case: "scriptPacket",
+                value: scriptPacket,
+            },
+        });
+    });
+}
+
 // Return an EncryptedData packet containing a KeycodePacket
 export function createKeyCodePacket(keycode) {
     const keycodePacket = create(ToothPacketPB.KeycodePacketSchema, {});
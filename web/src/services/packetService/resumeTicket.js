@@ -0,0 +1,74 @@
+/**
+ * resumeTicket.js
+ *
+ * Client side of session resumption: the receiver hands out a ticket with every CHALLENGE and RESUMED
+ * response (firmware/components/ble/ResumeTickets.h), a RESUME_PACKET carrying it skips authentication after a drop
+ */
+
+export const TICKET_SIZE = 16;
+export const TICKET_LIFETIME_MS = 30000; // RESUME_TICKET_LIFETIME_US, the receiver counts from when it notices the drop
+
+/**
+ * Additional data the write in a RESUME_PACKET is encrypted with
+ * @param {Uint8Array} ticket
+ * @param {number} sequence - The write's sequence number, from the RetransmitWindow kept across the drop
+ * @returns {Uint8Array} - The ticket followed by the sequence as 4 little endian bytes
+ */
+export function resumeAad(ticket, sequence) {
+    const aad = new Uint8Array(TICKET_SIZE + 4);
+    aad.set(ticket.subarray(0, TICKET_SIZE));
+    aad[TICKET_SIZE] = sequence & 0xFF;
+    aad[TICKET_SIZE + 1] = (sequence >> 8) & 0xFF;
+    return aad;
+}
+
+export class ResumeTicket {
+    constructor() {
+        this.clear();
+    }
+
+    /**
+     * Keep the ticket from a CHALLENGE or RESUMED response
+     * @param {Uint8Array} ticket - ResponsePacket.resumeTicket
+     * @param {CryptoKey} aesKey - Key of the session it resumes
+     * @param {Object} [capabilities] - The session's Capabilities, a resumed session has no CHALLENGE to bring them
+     */
+    save(ticket, aesKey, capabilities = null) {
+        if (ticket.length !== TICKET_SIZE) {
+            this.clear();
+            return;
+        }
+        this.ticket = Uint8Array.from(ticket);
+        this.aesKey = aesKey;
+        this.capabilities = capabilities;
+        this.droppedAt = null;
+    }
+
+    /**
+     * Note that the connection dropped, the ticket lapses TICKET_LIFETIME_MS later
+     */
+    dropped(now = Date.now()) {
+        if (this.ticket && this.droppedAt === null) {
+            this.droppedAt = now;
+        }
+    }
+
+    /**
+     * The ticket and key to resume with, null to authenticate instead
+     * A ticket is used once: RESUMED brings the next one, RESUME_FAILED means authenticating with an AUTH_PACKET
+     * @returns {Object|null} - { ticket, aesKey, capabilities }
+     */
+    take(now = Date.now()) {
+        const usable = this.ticket && (this.droppedAt === null || now - this.droppedAt < TICKET_LIFETIME_MS);
+        const taken = usable ? { ticket: this.ticket, aesKey: this.aesKey, capabilities: this.capabilities } : null;
+        this.clear();
+        return taken;
+    }
+
+    clear() {
+        this.ticket = null;
+        this.aesKey = null;
+        this.capabilities = null;
+        this.droppedAt = null;
+    }
+}
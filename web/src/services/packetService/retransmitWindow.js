@@ -0,0 +1,114 @@
+/**
+ * retransmitWindow.js
+ *
+ * Sender side of sequenced writes: the receiver reorders and deduplicates them
+ * (firmware/components/ble/ReorderWindow.h) and reports what it holds in SACK responses
+ */
+
+export const WINDOW_SIZE = 32; // ReorderWindow::SIZE, writes further ahead of the acknowledged one are dropped
+export const RESEND_TIMEOUT_MS = 100; // Resend every unacknowledged write when SACKs stop coming, well inside REORDER_GAP_TIMEOUT_US
+const SEQUENCE_MASK = 0xFFFF;
+
+/**
+ * Signed distance from a to b in the 16 bit sequence space
+ */
+function sequenceDelta(a, b) {
+    return ((b - a + 0x8000) & SEQUENCE_MASK) - 0x8000;
+}
+
+/**
+ * Additional data a sequenced DataPacket is encrypted with
+ * @param {number} sequence
+ * @returns {Uint8Array} - The sequence as 4 little endian bytes
+ */
+export function sequenceAad(sequence) {
+    return new Uint8Array([sequence & 0xFF, (sequence >> 8) & 0xFF, 0, 0]);
+}
+
+export class RetransmitWindow {
+    constructor() {
+        this.reset();
+    }
+
+    /**
+     * Forget everything, call on every new session (the receiver resets with its CHALLENGE)
+     */
+    reset() {
+        this.nextSequence = 0;
+        this.acked = SEQUENCE_MASK; // Sequence 0 is the first one not acknowledged
+        this.unacked = new Map(); // sequence -> encoded write
+    }
+
+    /**
+     * Whether another write fits in the receiver's window
+     */
+    canSend() {
+        return sequenceDelta(this.acked, this.nextSequence) <= WINDOW_SIZE;
+    }
+
+    /**
+     * Take the next sequence number, the write is kept until it is acknowledged
+     * @param {function(number): Promise<Uint8Array>} encode - Builds the write for a sequence number
+     * @returns {Promise<Uint8Array>}
+     */
+    async next(encode) {
+        const sequence = this.nextSequence;
+        this.nextSequence = (this.nextSequence + 1) & SEQUENCE_MASK;
+        const write = await encode(sequence);
+        this.unacked.set(sequence, write);
+        return write;
+    }
+
+    /**
+     * Take the next sequence number for a write that is never resent (the write in a RESUME_PACKET)
+     * @returns {number}
+     */
+    skip() {
+        const sequence = this.nextSequence;
+        this.nextSequence = (this.nextSequence + 1) & SEQUENCE_MASK;
+        return sequence;
+    }
+
+    /**
+     * Writes not acknowledged yet, oldest first
+     * @returns {Array<Uint8Array>}
+     */
+    pending() {
+        return [...this.unacked.values()];
+    }
+
+    /**
+     * Apply a SACK response
+     * @param {number} ackSequence - Last write the receiver applied in order
+     * @param {number} sackBits - Bit i = ackSequence + 2 + i is held
+     * @returns {Array<Uint8Array>} - Writes to send again, oldest first (lost writes past the last held one
+     *                              are invisible to the receiver, resend those when a SACK doesn't cover them)
+     */
+    onSack(ackSequence, sackBits) {
+        ackSequence &= SEQUENCE_MASK;
+        if (sequenceDelta(this.acked, ackSequence) < 0) {
+            return []; // Older than a SACK already applied
+        }
+        this.acked = ackSequence;
+
+        let highestHeld = -1;
+        for (let i = 0; i < WINDOW_SIZE; i++) {
+            if (sackBits & (1 << i)) {
+                this.unacked.delete((this.acked + 2 + i) & SEQUENCE_MASK);
+                highestHeld = i;
+            }
+        }
+
+        const resend = [];
+        for (const [sequence, write] of [...this.unacked]) {
+            const ahead = sequenceDelta(this.acked, sequence);
+            if (ahead <= 0) {
+                this.unacked.delete(sequence);
+            }
+            else if (ahead < highestHeld + 2) {
+                resend.push(write); // Missing below a held write
+            }
+        }
+        return resend;
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * textCompression.js
+ *
+ * LZ compression for bulk paste chunks, decompressed by the receiver (firmware/components/lzText/LzText.h)
+ */
+
+// Must match the dictionary in LzText.cpp byte for byte
+const DICTIONARY = new TextEncoder().encode(
+    'http://https://www..com.orglocalhost127.0.0.10.0.0.0#include <#define #!/bin/bash\n' +
+    '#!/usr/bin/env python3\n' +
+    'import from export default const let var function return async await class public private s' +
+    'tatic void int bool string Stringstruct unsigned def self.NonenullundefinedtruefalseTrueFal' +
+    'seif (} else {else:elif for (for  in while try:except catch (print(console.log(printf(echo ' +
+    'sudo apt-get install git docker ERRORErrorerrorWARNINGWarningwarningINFODEBUGfailedsuccessE' +
+    'xceptionTraceback (most recent call last):\n' +
+    '  File "line versionconfigserverclientusernamevaluetypedatapathfiletimedateporthostenabled<' +
+    'div</div><spanclass="href="": "",\n' +
+    '": ":{\n' +
+    '}\n' +
+    '};\n' +
+    ');\n' +
+    '()[] =  ==  !=  =>  ->  &&  || // /*  */# the and that this with for you not are have was i' +
+    'ng tionmentould \r\n' +
+    '\n' +
+    '\n' +
+    '\t\t\n' +
+    '\t        \n' +
+    '        '
+);
+
+const MIN_MATCH = 4;
+const MAX_MATCH = 0x7F + MIN_MATCH;
+const MAX_LITERALS = 0x80;
+const MAX_DISTANCE = 0xFFFF;
+const CHAIN_LENGTH = 16; // Candidates tried per position
+
+export const MAX_COMPRESSED_BYTES = 190; // toothpaste.KeyboardPacket.compressed
+export const MAX_EXPANDED_BYTES = 1024;  // PASTE_MAX_EXPANDED on the receiver
+
+/**
+ * Compress bytes into LZ tokens
+ * @param {Uint8Array} input
+ * @returns {Uint8Array}
+ */
+export function compressText(input) {
+    // Matches may reach back into the dictionary, which sits before the input
+    const buffer = new Uint8Array(DICTIONARY.length + input.length);
+    buffer.set(DICTIONARY);
+    buffer.set(input, DICTIONARY.length);
+
+    const chains = new Map(); // 4 byte prefix -> positions, most recent last
+    const key = (pos) => (buffer[pos] << 24 | buffer[pos + 1] << 16 | buffer[pos + 2] << 8 | buffer[pos + 3]) >>> 0;
+    const remember = (pos) => {
+        if (pos + MIN_MATCH > buffer.length) return;
+        const k = key(pos);
+        const chain = chains.get(k);
+        if (chain) {
+            chain.push(pos);
+            if (chain.length > CHAIN_LENGTH) chain.shift();
+        } else {
+            chains.set(k, [pos]);
+        }
+    };
+
+    for (let pos = 0; pos < DICTIONARY.length; pos++) {
+        remember(pos);
+    }
+
+    const out = [];
+    let literals = [];
+    const flushLiterals = () => {
+        for (let i = 0; i < literals.length; i += MAX_LITERALS) {
+            const run = literals.slice(i, i + MAX_LITERALS);
+            out.push(run.length - 1, ...run);
+        }
+        literals = [];
+    };
+
+    let pos = DICTIONARY.length;
+    while (pos < buffer.length) {
+        let bestLength = 0;
+        let bestDistance = 0;
+
+        if (pos + MIN_MATCH <= buffer.length) {
+            const chain = chains.get(key(pos)) || [];
+            for (let c = chain.length - 1; c >= 0; c--) {
+                const from = chain[c];
+                const distance = pos - from;
+                if (distance > MAX_DISTANCE) break;
+
+                let length = 0;
+                while (length < MAX_MATCH && pos + length < buffer.length && buffer[from + length] === buffer[pos + length]) {
+                    length++;
+                }
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = distance;
+                }
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            flushLiterals();
+            out.push(0x80 | (bestLength - MIN_MATCH), bestDistance & 0xFF, bestDistance >> 8);
+            for (let i = 0; i < bestLength; i++) {
+                remember(pos + i);
+            }
+            pos += bestLength;
+        } else {
+            literals.push(buffer[pos]);
+            remember(pos);
+            pos++;
+        }
+    }
+
+    flushLiterals();
+    return Uint8Array.from(out);
+}
+
+/**
+ * Largest chunk of <bytes> from <offset> that ends on a UTF-8 character boundary
+ */
+function boundary(bytes, offset, length) {
+    let end = Math.min(offset + length, bytes.length);
+    while (end > offset + 1 && end < bytes.length && (bytes[end] & 0xC0) === 0x80) {
+        end--;
+    }
+    return end;
+}
+
+/**
+ * Next paste chunk from <offset>, compressed only when that carries more text than a plain chunk
+ * @param {Uint8Array} bytes - UTF-8 paste
+ * @param {number} offset - Byte offset the chunk starts at (the paste's pasteOffset)
+ * @param {number} plainBytes - Bytes a plain KeyboardPacket chunk would carry
+ * @returns {Object} - { end, compressed: Uint8Array|null }, the chunk is bytes[offset, end)
+ */
+export function nextPasteChunk(bytes, offset, plainBytes) {
+    const plainEnd = boundary(bytes, offset, plainBytes);
+
+    // Shrink the window until it compresses into one packet
+    let length = MAX_EXPANDED_BYTES;
+    for (let attempt = 0; attempt < 8; attempt++) {
+        const end = boundary(bytes, offset, length);
+        if (end <= plainEnd) break;
+
+        const compressed = compressText(bytes.subarray(offset, end));
+        if (compressed.length <= MAX_COMPRESSED_BYTES) {
+            return { end, compressed };
+        }
+        length = Math.floor((end - offset) * MAX_COMPRESSED_BYTES / compressed.length * 0.95);
+    }
+
+    return { end: plainEnd, compressed: null };
+}
@@ -73,6 +73,26 @@ export declare type DataPacket = Message<"toothpaste.DataPacket"> & {
    * @generated from field: bytes tag = 8;
    */
   tag: Uint8Array;
+
+  /**
+   * Per write, shared with lean frames: authenticated and reordered (ReorderWindow.h), absent = applied on arrival
+   * When set the 4 byte little endian sequence is the AES-GCM additional data
+   *
+   * 1 - 3 bytes
+   *
+   * @generated from field: optional uint32 sequence = 9;
+   */
+  sequence?: number;
+
+  /**
+   * RESUME_PACKET: ticket from the last CHALLENGE or RESUMED, valid for a short time after the session drops
+   * The write is encrypted with that session's key and <resumeTicket> + the 4 byte sequence as additional data
+   *
+   * 16 bytes
+   *
+   * @generated from field: bytes resumeTicket = 10;
+   */
+  resumeTicket: Uint8Array;
 };
 
 /**
@@ -96,6 +116,13 @@ export enum DataPacket_PacketID {
    * @generated from enum value: AUTH_PACKET = 1;
    */
   AUTH_PACKET = 1,
+
+  /**
+   * Resumes a dropped session in place of AUTH, carries the first write
+   *
+   * @generated from enum value: RESUME_PACKET = 2;
+   */
+  RESUME_PACKET = 2,
 }
 
 /**
@@ -151,7 +178,81 @@ export declare type EncryptedData = Message<"toothpaste.EncryptedData"> & {
      */
     value: MouseJigglePacket;
     case: "mouseJigglePacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.TouchpadPacket touchpadPacket = 8;
+     */
+    value: TouchpadPacket;
+    case: "touchpadPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.GamepadPacket gamepadPacket = 9;
+     */
+    value: GamepadPacket;
+    case: "gamepadPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.KeyEventPacket keyEventPacket = 10;
+     */
+    value: KeyEventPacket;
+    case: "keyEventPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.ChordSequencePacket chordSequencePacket = 11;
+     */
+    value: ChordSequencePacket;
+    case: "chordSequencePacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.ConfigPacket configPacket = 12;
+     */
+    value: ConfigPacket;
+    case: "configPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.SyncPacket syncPacket = 13;
+     */
+    value: SyncPacket;
+    case: "syncPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.MacroPacket macroPacket = 14;
+     */
+    value: MacroPacket;
+    case: "macroPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.RunMacroPacket runMacroPacket = 15;
+     */
+    value: RunMacroPacket;
+    case: "runMacroPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.ScriptPacket scriptPacket = 16;
+     */
+    value: ScriptPacket;
+    case: "scriptPacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.CompositePacket compositePacket = 17;
+     */
+    value: CompositePacket;
+    case: "compositePacket";
+  } | {
+    /**
+     * @generated from field: toothpaste.ClockSyncPacket clockSyncPacket = 18;
+     */
+    value: ClockSyncPacket;
+    case: "clockSyncPacket";
   } | { case: undefined; value?: undefined };
+
+  /**
+   * When the input was captured, in device time (esp_timer us) through the offset measured with CLOCK_SYNC
+   * With a playout delay configured the device applies the packet at timestamp + delay, 0 = apply on arrival
+   *
+   * @generated from field: uint64 timestamp = 19;
+   */
+  timestamp: bigint;
 };
 
 /**
@@ -195,6 +296,56 @@ export enum EncryptedData_PacketType {
    * @generated from enum value: COMPOSITE = 5;
    */
   COMPOSITE = 5,
+
+  /**
+   * @generated from enum value: TOUCHPAD = 6;
+   */
+  TOUCHPAD = 6,
+
+  /**
+   * @generated from enum value: GAMEPAD = 7;
+   */
+  GAMEPAD = 7,
+
+  /**
+   * @generated from enum value: KEY_EVENTS = 8;
+   */
+  KEY_EVENTS = 8,
+
+  /**
+   * @generated from enum value: CHORD_SEQUENCE = 9;
+   */
+  CHORD_SEQUENCE = 9,
+
+  /**
+   * @generated from enum value: CONFIG = 10;
+   */
+  CONFIG = 10,
+
+  /**
+   * @generated from enum value: SYNC = 11;
+   */
+  SYNC = 11,
+
+  /**
+   * @generated from enum value: MACRO = 12;
+   */
+  MACRO = 12,
+
+  /**
+   * @generated from enum value: RUN_MACRO = 13;
+   */
+  RUN_MACRO = 13,
+
+  /**
+   * @generated from enum value: SCRIPT = 14;
+   */
+  SCRIPT = 14,
+
+  /**
+   * @generated from enum value: CLOCK_SYNC = 15;
+   */
+  CLOCK_SYNC = 15,
 }
 
 /**
@@ -226,6 +377,83 @@ export declare type ResponsePacket = Message<"toothpaste.ResponsePacket"> & {
    * @generated from field: string firmwareVersion = 3;
    */
   firmwareVersion: string;
+
+  /**
+   * Last applied sequence number (GAMEPAD_ACK), last write applied in order (SACK)
+   *
+   * @generated from field: uint32 ackSequence = 4;
+   */
+  ackSequence: number;
+
+  /**
+   * Host keyboard LEDs: bit 0 = num lock, bit 1 = caps lock, bit 2 = scroll lock
+   *
+   * @generated from field: uint32 hostLeds = 5;
+   */
+  hostLeds: number;
+
+  /**
+   * Bulk paste being typed, 0 = none
+   *
+   * @generated from field: uint32 pasteId = 6;
+   */
+  pasteId: number;
+
+  /**
+   * Bytes of that paste emitted to USB, resume from here
+   *
+   * @generated from field: uint32 pasteOffset = 7;
+   */
+  pasteOffset: number;
+
+  /**
+   * Slot a MACRO_STATUS refers to
+   *
+   * @generated from field: uint32 macroSlot = 8;
+   */
+  macroSlot: number;
+
+  /**
+   * The upload was sealed (or the macro ran)
+   *
+   * @generated from field: bool macroStored = 9;
+   */
+  macroStored: boolean;
+
+  /**
+   * CLOCK_SYNC: echo of ClockSyncPacket.clientTime
+   *
+   * @generated from field: uint64 clientTime = 10;
+   */
+  clientTime: bigint;
+
+  /**
+   * CLOCK_SYNC: device time (esp_timer us) when the reply was sent
+   *
+   * @generated from field: uint64 deviceTime = 11;
+   */
+  deviceTime: bigint;
+
+  /**
+   * CHALLENGE: what this receiver supports
+   *
+   * @generated from field: toothpaste.Capabilities capabilities = 12;
+   */
+  capabilities?: Capabilities;
+
+  /**
+   * SACK: bit i = sequence ackSequence + 2 + i arrived and is held
+   *
+   * @generated from field: uint32 sackBits = 13;
+   */
+  sackBits: number;
+
+  /**
+   * CHALLENGE and RESUMED: resumes this session after a drop (16 bytes)
+   *
+   * @generated from field: bytes resumeTicket = 14;
+   */
+  resumeTicket: Uint8Array;
 };
 
 /**
@@ -259,6 +487,50 @@ export enum ResponsePacket_ResponseType {
    * @generated from enum value: CHALLENGE = 3;
    */
   CHALLENGE = 3,
+
+  /**
+   * @generated from enum value: GAMEPAD_ACK = 4;
+   */
+  GAMEPAD_ACK = 4,
+
+  /**
+   * @generated from enum value: HOST_STATE = 5;
+   */
+  HOST_STATE = 5,
+
+  /**
+   * @generated from enum value: PASTE_PROGRESS = 6;
+   */
+  PASTE_PROGRESS = 6,
+
+  /**
+   * @generated from enum value: MACRO_STATUS = 7;
+   */
+  MACRO_STATUS = 7,
+
+  /**
+   * @generated from enum value: CLOCK_SYNC = 8;
+   */
+  CLOCK_SYNC = 8,
+
+  /**
+   * @generated from enum value: SACK = 9;
+   */
+  SACK = 9,
+
+  /**
+   * The RESUME_PACKET was accepted, the session continues with its old key
+   *
+   * @generated from enum value: RESUMED = 10;
+   */
+  RESUMED = 10,
+
+  /**
+   * Unknown, expired or used ticket, authenticate with an AUTH_PACKET
+   *
+   * @generated from enum value: RESUME_FAILED = 11;
+   */
+  RESUME_FAILED = 11,
 }
 
 /**
@@ -285,6 +557,27 @@ export declare type KeyboardPacket = Message<"toothpaste.KeyboardPacket"> & {
    * @generated from field: uint32 length = 2;
    */
   length: number;
+
+  /**
+   * Bulk paste this chunk belongs to, 0 = plain text
+   *
+   * @generated from field: uint32 pasteId = 3;
+   */
+  pasteId: number;
+
+  /**
+   * Byte offset of <message> in the paste
+   *
+   * @generated from field: uint32 pasteOffset = 4;
+   */
+  pasteOffset: number;
+
+  /**
+   * 190 bytes, replaces <message> in a bulk paste: LZ tokens (see LzText.h) expanding to at most 1024 bytes
+   *
+   * @generated from field: bytes compressed = 5;
+   */
+  compressed: Uint8Array;
 };
 
 /**
@@ -412,6 +705,21 @@ export declare type MousePacket = Message<"toothpaste.MousePacket"> & {
    * @generated from field: int32 wheel = 5;
    */
   wheel: number;
+
+  /**
+   * 190 bytes, replaces <frames>: one byte per frame, int4 dx, dy in the high, low nibble - or 0x80 then zig-zag varint dx, dy
+   * 0x81 then a varint ms sets the spacing of the timed frames after it, 0x82 - 0x8F are reserved
+   *
+   * @generated from field: bytes packedFrames = 6;
+   */
+  packedFrames: Uint8Array;
+
+  /**
+   * Packed frames are spaced by the last 0x81 spacing (0 before one), the device replays that spacing
+   *
+   * @generated from field: bool timedFrames = 7;
+   */
+  timedFrames: boolean;
 };
 
 /**
@@ -461,3 +769,520 @@ export declare type MouseJigglePacket = Message<"toothpaste.MouseJigglePacket">
  */
 export declare const MouseJigglePacketSchema: GenMessage<MouseJigglePacket>;
 
+/**
+ * Raw multi-touch contact frames for the precision touchpad interface
+ * Each frame is [count | button << 3][delay ms] followed by <count> contacts of [id | tip << 4][x lo][x hi][y lo][y hi]
+ *
+ * @generated from message toothpaste.TouchpadPacket
+ */
+export declare type TouchpadPacket = Message<"toothpaste.TouchpadPacket"> & {
+  /**
+   * 180 bytes
+   *
+   * @generated from field: bytes frames = 1;
+   */
+  frames: Uint8Array;
+};
+
+/**
+ * Describes the message toothpaste.TouchpadPacket.
+ * Use `create(TouchpadPacketSchema)` to create a new message.
+ */
+export declare const TouchpadPacketSchema: GenMessage<TouchpadPacket>;
+
+/**
+ * Gamepad state delta against the last acknowledged state, only the fields flagged in <changed> are present in <values>
+ * changed: bits 0-5 = x, y, z, rz, rx, ry (1 byte each) | bit 6 = hat (1 byte) | bit 7 = buttons (4 bytes LE)
+ *
+ * @generated from message toothpaste.GamepadPacket
+ */
+export declare type GamepadPacket = Message<"toothpaste.GamepadPacket"> & {
+  /**
+   * Increments per packet, echoed back in GAMEPAD_ACK
+   *
+   * @generated from field: uint32 sequence = 1;
+   */
+  sequence: number;
+
+  /**
+   * 1 - 2 bytes
+   *
+   * @generated from field: uint32 changed = 2;
+   */
+  changed: number;
+
+  /**
+   * 11 bytes
+   *
+   * @generated from field: bytes values = 3;
+   */
+  values: Uint8Array;
+};
+
+/**
+ * Describes the message toothpaste.GamepadPacket.
+ * Use `create(GamepadPacketSchema)` to create a new message.
+ */
+export declare const GamepadPacketSchema: GenMessage<GamepadPacket>;
+
+/**
+ * Raw key press/release events applied to the held key state, 3 bytes per event
+ * [usage][state][delay ms]: usage = HID keyboard usage (HID_KEY_*), state bit 0 = down, delay = ms since the previous event
+ *
+ * @generated from message toothpaste.KeyEventPacket
+ */
+export declare type KeyEventPacket = Message<"toothpaste.KeyEventPacket"> & {
+  /**
+   * 180 bytes
+   *
+   * @generated from field: bytes events = 1;
+   */
+  events: Uint8Array;
+};
+
+/**
+ * Describes the message toothpaste.KeyEventPacket.
+ * Use `create(KeyEventPacketSchema)` to create a new message.
+ */
+export declare const KeyEventPacketSchema: GenMessage<KeyEventPacket>;
+
+/**
+ * A sequence of chords executed back to back, each chord is [count | text << 7][hold ms lo][hold hi] followed by <count> bytes
+ * Key chords use KeycodePacket encoding and are held for <hold> ms (0 = default), text chords are typed through the keyboard layout
+ *
+ * @generated from message toothpaste.ChordSequencePacket
+ */
+export declare type ChordSequencePacket = Message<"toothpaste.ChordSequencePacket"> & {
+  /**
+   * 190 bytes
+   *
+   * @generated from field: bytes chords = 1;
+   */
+  chords: Uint8Array;
+};
+
+/**
+ * Describes the message toothpaste.ChordSequencePacket.
+ * Use `create(ChordSequencePacketSchema)` to create a new message.
+ */
+export declare const ChordSequencePacketSchema: GenMessage<ChordSequencePacket>;
+
+/**
+ * Device behaviour settings for the current session, settings a packet leaves out keep their current value
+ *
+ * @generated from message toothpaste.ConfigPacket
+ */
+export declare type ConfigPacket = Message<"toothpaste.ConfigPacket"> & {
+  /**
+   * Pace typing by lock-key LED echoes from the host
+   *
+   * @generated from field: optional bool ackTyping = 1;
+   */
+  ackTyping?: boolean;
+
+  /**
+   * @generated from field: optional toothpaste.ConfigPacket.UnicodeFallback unicodeFallback = 2;
+   */
+  unicodeFallback?: ConfigPacket_UnicodeFallback;
+
+  /**
+   * @generated from field: toothpaste.ConfigPacket.KeyboardLayout layout = 3;
+   */
+  layout: ConfigPacket_KeyboardLayout;
+
+  /**
+   * Hold timestamped input this long and replay it at its original spacing, 0 = off
+   *
+   * @generated from field: optional uint32 playoutDelayMs = 4;
+   */
+  playoutDelayMs?: number;
+};
+
+/**
+ * Describes the message toothpaste.ConfigPacket.
+ * Use `create(ConfigPacketSchema)` to create a new message.
+ */
+export declare const ConfigPacketSchema: GenMessage<ConfigPacket>;
+
+/**
+ * How characters the keyboard layout can't type are entered on the host
+ *
+ * @generated from enum toothpaste.ConfigPacket.UnicodeFallback
+ */
+export enum ConfigPacket_UnicodeFallback {
+  /**
+   * Skip them
+   *
+   * @generated from enum value: NONE = 0;
+   */
+  NONE = 0,
+
+  /**
+   * Windows Alt + numpad codes, above U+00FF needs the EnableHexNumpad registry value (see firmware/README.MD)
+   *
+   * @generated from enum value: ALT_NUMPAD = 1;
+   */
+  ALT_NUMPAD = 1,
+
+  /**
+   * Linux (IBus / GTK) Ctrl+Shift+U hex entry
+   *
+   * @generated from enum value: CTRL_SHIFT_U = 2;
+   */
+  CTRL_SHIFT_U = 2,
+
+  /**
+   * macOS Unicode Hex Input source
+   *
+   * @generated from enum value: MAC_HEX = 3;
+   */
+  MAC_HEX = 3,
+}
+
+/**
+ * Describes the enum toothpaste.ConfigPacket.UnicodeFallback.
+ */
+export declare const ConfigPacket_UnicodeFallbackSchema: GenEnum<ConfigPacket_UnicodeFallback>;
+
+/**
+ * Host keyboard layout text is typed for, remembered per paired client
+ *
+ * @generated from enum toothpaste.ConfigPacket.KeyboardLayout
+ */
+export enum ConfigPacket_KeyboardLayout {
+  /**
+   * Keep the current layout
+   *
+   * @generated from enum value: UNCHANGED = 0;
+   */
+  UNCHANGED = 0,
+
+  /**
+   * @generated from enum value: EN_US = 1;
+   */
+  EN_US = 1,
+
+  /**
+   * @generated from enum value: DE_DE = 2;
+   */
+  DE_DE = 2,
+
+  /**
+   * @generated from enum value: FR_FR = 3;
+   */
+  FR_FR = 3,
+
+  /**
+   * @generated from enum value: ES_ES = 4;
+   */
+  ES_ES = 4,
+
+  /**
+   * @generated from enum value: IT_IT = 5;
+   */
+  IT_IT = 5,
+
+  /**
+   * @generated from enum value: PT_PT = 6;
+   */
+  PT_PT = 6,
+
+  /**
+   * @generated from enum value: PT_BR = 7;
+   */
+  PT_BR = 7,
+
+  /**
+   * @generated from enum value: SV_SE = 8;
+   */
+  SV_SE = 8,
+
+  /**
+   * @generated from enum value: DA_DK = 9;
+   */
+  DA_DK = 9,
+
+  /**
+   * @generated from enum value: HU_HU = 10;
+   */
+  HU_HU = 10,
+}
+
+/**
+ * Describes the enum toothpaste.ConfigPacket.KeyboardLayout.
+ */
+export declare const ConfigPacket_KeyboardLayoutSchema: GenEnum<ConfigPacket_KeyboardLayout>;
+
+/**
+ * Target text for sync mode, the device types only the difference from the text it typed last
+ * A target is sent as consecutive chunks starting at offset 0, the edit runs when the chunk with <done> arrives
+ *
+ * @generated from message toothpaste.SyncPacket
+ */
+export declare type SyncPacket = Message<"toothpaste.SyncPacket"> & {
+  /**
+   * Byte offset of <text> in the target
+   *
+   * @generated from field: uint32 offset = 1;
+   */
+  offset: number;
+
+  /**
+   * 180 bytes of UTF-8
+   *
+   * @generated from field: bytes text = 2;
+   */
+  text: Uint8Array;
+
+  /**
+   * Last chunk of the target
+   *
+   * @generated from field: bool done = 3;
+   */
+  done: boolean;
+
+  /**
+   * Forget the previous text, the cursor is in an empty field
+   *
+   * @generated from field: bool reset = 4;
+   */
+  reset: boolean;
+};
+
+/**
+ * Describes the message toothpaste.SyncPacket.
+ * Use `create(SyncPacketSchema)` to create a new message.
+ */
+export declare const SyncPacketSchema: GenMessage<SyncPacket>;
+
+/**
+ * Upload a macro into an on-device slot, sent as consecutive chunks starting at offset 0
+ * The macro is a list of records [delay ms lo][delay ms hi][length] followed by <length> bytes of a serialized EncryptedData
+ *
+ * @generated from message toothpaste.MacroPacket
+ */
+export declare type MacroPacket = Message<"toothpaste.MacroPacket"> & {
+  /**
+   * 0 - 15, slot 0 also runs from the button
+   *
+   * @generated from field: uint32 slot = 1;
+   */
+  slot: number;
+
+  /**
+   * Byte offset of <data> in the macro
+   *
+   * @generated from field: uint32 offset = 2;
+   */
+  offset: number;
+
+  /**
+   * 180 bytes
+   *
+   * @generated from field: bytes data = 3;
+   */
+  data: Uint8Array;
+
+  /**
+   * Last chunk, seals the slot
+   *
+   * @generated from field: bool done = 4;
+   */
+  done: boolean;
+};
+
+/**
+ * Describes the message toothpaste.MacroPacket.
+ * Use `create(MacroPacketSchema)` to create a new message.
+ */
+export declare const MacroPacketSchema: GenMessage<MacroPacket>;
+
+/**
+ * Run a stored macro
+ *
+ * @generated from message toothpaste.RunMacroPacket
+ */
+export declare type RunMacroPacket = Message<"toothpaste.RunMacroPacket"> & {
+  /**
+   * @generated from field: uint32 slot = 1;
+   */
+  slot: number;
+};
+
+/**
+ * Describes the message toothpaste.RunMacroPacket.
+ * Use `create(RunMacroPacketSchema)` to create a new message.
+ */
+export declare const RunMacroPacketSchema: GenMessage<RunMacroPacket>;
+
+/**
+ * Compiled Duckyscript bytecode (see firmware/components/duckyVM/DuckyVM.h), sent as consecutive chunks starting at offset 0
+ * The script runs on the device once the last chunk arrives, in order with any queued text
+ *
+ * @generated from message toothpaste.ScriptPacket
+ */
+export declare type ScriptPacket = Message<"toothpaste.ScriptPacket"> & {
+  /**
+   * Byte offset of <code> in the script
+   *
+   * @generated from field: uint32 offset = 1;
+   */
+  offset: number;
+
+  /**
+   * 180 bytes
+   *
+   * @generated from field: bytes code = 2;
+   */
+  code: Uint8Array;
+
+  /**
+   * Last chunk, run the script
+   *
+   * @generated from field: bool done = 3;
+   */
+  done: boolean;
+};
+
+/**
+ * Describes the message toothpaste.ScriptPacket.
+ * Use `create(ScriptPacketSchema)` to create a new message.
+ */
+export declare const ScriptPacketSchema: GenMessage<ScriptPacket>;
+
+/**
+ * Keyboard, keycode, mouse and consumer events in one packet, run in order by the device
+ * Each event is [kind][delay ms lo][delay ms hi][length] followed by <length> bytes, delay = ms after the previous event was due
+ * kind 0 = UTF-8 text, 1 = KeycodePacket encoding (pressed then released), 2 = [usage][state bit 0 = down],
+ * 3 = [dx lo][dx hi][dy lo][dy hi][buttons: bit 0 = left, bit 1 = right][wheel] (int16/int8, buttons are the held state),
+ * 4 = consumer control [usage lo][usage hi]
+ *
+ * @generated from message toothpaste.CompositePacket
+ */
+export declare type CompositePacket = Message<"toothpaste.CompositePacket"> & {
+  /**
+   * 180 bytes
+   *
+   * @generated from field: bytes events = 1;
+   */
+  events: Uint8Array;
+};
+
+/**
+ * Describes the message toothpaste.CompositePacket.
+ * Use `create(CompositePacketSchema)` to create a new message.
+ */
+export declare const CompositePacketSchema: GenMessage<CompositePacket>;
+
+/**
+ * Clock sync probe, answered with a CLOCK_SYNC response carrying the device time
+ * The client keeps the probe with the shortest round trip: offset = deviceTime - (clientTime + rtt / 2)
+ *
+ * @generated from message toothpaste.ClockSyncPacket
+ */
+export declare type ClockSyncPacket = Message<"toothpaste.ClockSyncPacket"> & {
+  /**
+   * Client clock (us), echoed back
+   *
+   * @generated from field: uint64 clientTime = 1;
+   */
+  clientTime: bigint;
+};
+
+/**
+ * Describes the message toothpaste.ClockSyncPacket.
+ * Use `create(ClockSyncPacketSchema)` to create a new message.
+ */
+export declare const ClockSyncPacketSchema: GenMessage<ClockSyncPacket>;
+
+/**
+ * What this receiver supports, sent with every CHALLENGE so a client can pick its fastest protocol features
+ * features: bit 0 = ScriptPacket, 1 = CompositePacket, 2 = MousePacket.packedFrames, 3 = ClockSyncPacket and playout delay,
+ * 4 = SyncPacket, 5 = ChordSequencePacket, 6 = KeyEventPacket, 7 = GamepadPacket, 8 = MacroPacket, 9 = resumable pastes,
+ * 10 = sequenced writes acknowledged with SACK, 11 = session resumption (RESUME_PACKET)
+ *
+ * @generated from message toothpaste.Capabilities
+ */
+export declare type Capabilities = Message<"toothpaste.Capabilities"> & {
+  /**
+   * Largest input characteristic write in bytes (negotiated ATT MTU - 3)
+   *
+   * @generated from field: uint32 maxWriteSize = 1;
+   */
+  maxWriteSize: number;
+
+  /**
+   * Writes the device can take right now before it drops one
+   *
+   * @generated from field: uint32 queueCredits = 2;
+   */
+  queueCredits: number;
+
+  /**
+   * bit 0 = protobuf DataPacket, bit 1 = lean frames (LeanFrame.h)
+   *
+   * @generated from field: uint32 wireFormats = 3;
+   */
+  wireFormats: number;
+
+  /**
+   * bit 0 = LZ paste chunks (KeyboardPacket.compressed)
+   *
+   * @generated from field: uint32 compression = 4;
+   */
+  compression: number;
+
+  /**
+   * Keyboard reports hold any number of keys, otherwise 6 keys + modifiers
+   *
+   * @generated from field: bool nkro = 5;
+   */
+  nkro: boolean;
+
+  /**
+   * Touchpad interface with absolute contacts (TouchpadPacket)
+   *
+   * @generated from field: bool absolutePointer = 6;
+   */
+  absolutePointer: boolean;
+
+  /**
+   * Shortest time between keyboard reports, a typed character takes two
+   *
+   * @generated from field: uint32 keyReportIntervalUs = 7;
+   */
+  keyReportIntervalUs: number;
+
+  /**
+   * Extra delay per character in slow mode
+   *
+   * @generated from field: uint32 slowModeDelayMs = 8;
+   */
+  slowModeDelayMs: number;
+
+  /**
+   * @generated from field: uint32 macroSlots = 9;
+   */
+  macroSlots: number;
+
+  /**
+   * Bytes of records one slot holds
+   *
+   * @generated from field: uint32 macroSlotSize = 10;
+   */
+  macroSlotSize: number;
+
+  /**
+   * Packet types beyond text and keycodes, see above
+   *
+   * @generated from field: uint32 features = 11;
+   */
+  features: number;
+};
+
+/**
+ * Describes the message toothpaste.Capabilities.
+ * Use `create(CapabilitiesSchema)` to create a new message.
+ */
+export declare const CapabilitiesSchema: GenMessage<Capabilities>;
+
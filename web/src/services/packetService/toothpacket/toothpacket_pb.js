@@ -8,7 +8,7 @@ import { enumDesc, fileDesc, messageDesc, tsEnum } from "@bufbuild/protobuf/code
  * Describes the file toothpacket.proto.
  */
 export const file_toothpacket = /*@__PURE__*/
-  fileDesc("ChF0b290aHBhY2tldC5wcm90bxIKdG9vdGhwYXN0ZSLsAQoKRGF0YVBhY2tldBIxCghwYWNrZXRJRBgBIAEoDjIfLnRvb3RocGFzdGUuRGF0YVBhY2tldC5QYWNrZXRJRBIUCgxwYWNrZXROdW1iZXIYAiABKA0SFAoMdG90YWxQYWNrZXRzGAMgASgNEhAKCHNsb3dNb2RlGAQgASgIEgoKAml2GAUgASgMEg8KB2RhdGFMZW4YBiABKA0SFQoNZW5jcnlwdGVkRGF0YRgHIAEoDBILCgN0YWcYCCABKAwiLAoIUGFja2V0SUQSDwoLREFUQV9QQUNLRVQQABIPCgtBVVRIX1BBQ0tFVBABIpgECg1FbmNyeXB0ZWREYXRhEjgKCnBhY2tldFR5cGUYASABKA4yJC50b290aHBhc3RlLkVuY3J5cHRlZERhdGEuUGFja2V0VHlwZRI0Cg5rZXlib2FyZFBhY2tldBgCIAEoCzIaLnRvb3RocGFzdGUuS2V5Ym9hcmRQYWNrZXRIABIyCg1rZXljb2RlUGFja2V0GAMgASgLMhkudG9vdGhwYXN0ZS5LZXljb2RlUGFja2V0SAASLgoLbW91c2VQYWNrZXQYBCABKAsyFy50b290aHBhc3RlLk1vdXNlUGFja2V0SAASMAoMcmVuYW1lUGFja2V0GAUgASgLMhgudG9vdGhwYXN0ZS5SZW5hbWVQYWNrZXRIABJCChVjb25zdW1lckNvbnRyb2xQYWNrZXQYBiABKAsyIS50b290aHBhc3RlLkNvbnN1bWVyQ29udHJvbFBhY2tldEgAEjoKEW1vdXNlSmlnZ2xlUGFja2V0GAcgASgLMh0udG9vdGhwYXN0ZS5Nb3VzZUppZ2dsZVBhY2tldEgAInMKClBhY2tldFR5cGUSEwoPS0VZQk9BUkRfU1RSSU5HEAASFAoQS0VZQk9BUkRfS0VZQ09ERRABEgkKBU1PVVNFEAISCgoGUkVOQU1FEAMSFAoQQ09OU1VNRVJfQ09OVFJPTBAEEg0KCUNPTVBPU0lURRAFQgwKCnBhY2tldERhdGEizwEKDlJlc3BvbnNlUGFja2V0Ej0KDHJlc3BvbnNlVHlwZRgBIAEoDjInLnRvb3RocGFzdGUuUmVzcG9uc2VQYWNrZXQuUmVzcG9uc2VUeXBlEhUKDWNoYWxsZW5nZURhdGEYAiABKAwSFwoPZmlybXdhcmVWZXJzaW9uGAMgASgJIk4KDFJlc3BvbnNlVHlwZRINCglLRUVQQUxJVkUQABIQCgxQRUVSX1VOS05PV04QARIOCgpQRUVSX0tOT1dOEAISDQoJQ0hBTExFTkdFEAMiMQoOS2V5Ym9hcmRQYWNrZXQSDwoHbWVzc2FnZRgBIAEoCRIOCgZsZW5ndGgYAiABKA0iLwoMUmVuYW1lUGFja2V0Eg8KB21lc3NhZ2UYASABKAkSDgoGbGVuZ3RoGAIgASgNIi0KDUtleWNvZGVQYWNrZXQSDAoEY29kZRgBIAEoDBIOCgZsZW5ndGgYAiABKA0iHQoFRnJhbWUSCQoBeBgBIAEoBRIJCgF5GAIgASgFInUKC01vdXNlUGFja2V0EhIKCm51bV9mcmFtZXMYASABKA0SIQoGZnJhbWVzGAIgAygLMhEudG9vdGhwYXN0ZS5GcmFtZRIPCgdsX2NsaWNrGAMgASgFEg8KB3JfY2xpY2sYBCABKAUSDQoFd2hlZWwYBSABKAUiNQoVQ29uc3VtZXJDb250cm9sUGFja2V0EgwKBGNvZGUYASADKA0SDgoGbGVuZ3RoGAIgASgNIiMKEU1vdXNlSmlnZ2xlUGFja2V0Eg4KBmVuYWJsZRgBIAEoCGIGcHJvdG8z");
+  fileDesc("ChF0b290aHBhY2tldC5wcm90bxIKdG9vdGhwYXN0ZSK5AgoKRGF0YVBhY2tldBIxCghwYWNrZXRJRBgBIAEoDjIfLnRvb3RocGFzdGUuRGF0YVBhY2tldC5QYWNrZXRJRBIUCgxwYWNrZXROdW1iZXIYAiABKA0SFAoMdG90YWxQYWNrZXRzGAMgASgNEhAKCHNsb3dNb2RlGAQgASgIEgoKAml2GAUgASgMEg8KB2RhdGFMZW4YBiABKA0SFQoNZW5jcnlwdGVkRGF0YRgHIAEoDBILCgN0YWcYCCABKAwSFQoIc2VxdWVuY2UYCSABKA1IAIgBARIUCgxyZXN1bWVUaWNrZXQYCiABKAwiPwoIUGFja2V0SUQSDwoLREFUQV9QQUNLRVQQABIPCgtBVVRIX1BBQ0tFVBABEhEKDVJFU1VNRV9QQUNLRVQQAkILCglfc2VxdWVuY2Ui/wkKDUVuY3J5cHRlZERhdGESOAoKcGFja2V0VHlwZRgBIAEoDjIkLnRvb3RocGFzdGUuRW5jcnlwdGVkRGF0YS5QYWNrZXRUeXBlEjQKDmtleWJvYXJkUGFja2V0GAIgASgLMhoudG9vdGhwYXN0ZS5LZXlib2FyZFBhY2tldEgAEjIKDWtleWNvZGVQYWNrZXQYAyABKAsyGS50b290aHBhc3RlLktleWNvZGVQYWNrZXRIABIuCgttb3VzZVBhY2tldBgEIAEoCzIXLnRvb3RocGFzdGUuTW91c2VQYWNrZXRIABIwCgxyZW5hbWVQYWNrZXQYBSABKAsyGC50b290aHBhc3RlLlJlbmFtZVBhY2tldEgAEkIKFWNvbnN1bWVyQ29udHJvbFBhY2tldBgGIAEoCzIhLnRvb3RocGFzdGUuQ29uc3VtZXJDb250cm9sUGFja2V0SAASOgoRbW91c2VKaWdnbGVQYWNrZXQYByABKAsyHS50b290aHBhc3RlLk1vdXNlSmlnZ2xlUGFja2V0SAASNAoOdG91Y2hwYWRQYWNrZXQYCCABKAsyGi50b290aHBhc3RlLlRvdWNocGFkUGFja2V0SAASMgoNZ2FtZXBhZFBhY2tldBgJIAEoCzIZLnRvb3RocGFzdGUuR2FtZXBhZFBhY2tldEgAEjQKDmtleUV2ZW50UGFja2V0GAogASgLMhoudG9vdGhwYXN0ZS5LZXlFdmVudFBhY2tldEgAEj4KE2Nob3JkU2VxdWVuY2VQYWNrZXQYCyABKAsyHy50b290aHBhc3RlLkNob3JkU2VxdWVuY2VQYWNrZXRIABIwCgxjb25maWdQYWNrZXQYDCABKAsyGC50b290aHBhc3RlLkNvbmZpZ1BhY2tldEgAEiwKCnN5bmNQYWNrZXQYDSABKAsyFi50b290aHBhc3RlLlN5bmNQYWNrZXRIABIuCgttYWNyb1BhY2tldBgOIAEoCzIXLnRvb3RocGFzdGUuTWFjcm9QYWNrZXRIABI0Cg5ydW5NYWNyb1BhY2tldBgPIAEoCzIaLnRvb3RocGFzdGUuUnVuTWFjcm9QYWNrZXRIABIwCgxzY3JpcHRQYWNrZXQYECABKAsyGC50b290aHBhc3RlLlNjcmlwdFBhY2tldEgAEjYKD2NvbXBvc2l0ZVBhY2tldBgRIAEoCzIbLnRvb3RocGFzdGUuQ29tcG9zaXRlUGFja2V0SAASNgoPY2xvY2tTeW5jUGFja2V0GBIgASgLMhsudG9vdGhwYXN0ZS5DbG9ja1N5bmNQYWNrZXRIABIRCgl0aW1lc3RhbXAYEyABKAQi/gEKClBhY2tldFR5cGUSEwoPS0VZQk9BUkRfU1RSSU5HEAASFAoQS0VZQk9BUkRfS0VZQ09ERRABEgkKBU1PVVNFEAISCgoGUkVOQU1FEAMSFAoQQ09OU1VNRVJfQ09OVFJPTBAEEg0KCUNPTVBPU0lURRAFEgwKCFRPVUNIUEFEEAYSCwoHR0FNRVBBRBAHEg4KCktFWV9FVkVOVFMQCBISCg5DSE9SRF9TRVFVRU5DRRAJEgoKBkNPTkZJRxAKEggKBFNZTkMQCxIJCgVNQUNSTxAMEg0KCVJVTl9NQUNSTxANEgoKBlNDUklQVBAOEg4KCkNMT0NLX1NZTkMQD0IMCgpwYWNrZXREYXRhIsYECg5SZXNwb25zZVBhY2tldBI9CgxyZXNwb25zZVR5cGUYASABKA4yJy50b290aHBhc3RlLlJlc3BvbnNlUGFja2V0LlJlc3BvbnNlVHlwZRIVCg1jaGFsbGVuZ2VEYXRhGAIgASgMEhcKD2Zpcm13YXJlVmVyc2lvbhgDIAEoCRITCgthY2tTZXF1ZW5jZRgEIAEoDRIQCghob3N0TGVkcxgFIAEoDRIPCgdwYXN0ZUlkGAYgASgNEhMKC3Bhc3RlT2Zmc2V0GAcgASgNEhEKCW1hY3JvU2xvdBgIIAEoDRITCgttYWNyb1N0b3JlZBgJIAEoCBISCgpjbGllbnRUaW1lGAogASgEEhIKCmRldmljZVRpbWUYCyABKAQSLgoMY2FwYWJpbGl0aWVzGAwgASgLMhgudG9vdGhwYXN0ZS5DYXBhYmlsaXRpZXMSEAoIc2Fja0JpdHMYDSABKA0SFAoMcmVzdW1lVGlja2V0GA4gASgMIs8BCgxSZXNwb25zZVR5cGUSDQoJS0VFUEFMSVZFEAASEAoMUEVFUl9VTktOT1dOEAESDgoKUEVFUl9LTk9XThACEg0KCUNIQUxMRU5HRRADEg8KC0dBTUVQQURfQUNLEAQSDgoKSE9TVF9TVEFURRAFEhIKDlBBU1RFX1BST0dSRVNTEAYSEAoMTUFDUk9fU1RBVFVTEAcSDgoKQ0xPQ0tfU1lOQxAIEggKBFNBQ0sQCRILCgdSRVNVTUVEEAoSEQoNUkVTVU1FX0ZBSUxFRBALImsKDktleWJvYXJkUGFja2V0Eg8KB21lc3NhZ2UYASABKAkSDgoGbGVuZ3RoGAIgASgNEg8KB3Bhc3RlSWQYAyABKA0SEwoLcGFzdGVPZmZzZXQYBCABKA0SEgoKY29tcHJlc3NlZBgFIAEoDCIvCgxSZW5hbWVQYWNrZXQSDwoHbWVzc2FnZRgBIAEoCRIOCgZsZW5ndGgYAiABKA0iLQoNS2V5Y29kZVBhY2tldBIMCgRjb2RlGAEgASgMEg4KBmxlbmd0aBgCIAEoDSIdCgVGcmFtZRIJCgF4GAEgASgFEgkKAXkYAiABKAUioAEKC01vdXNlUGFja2V0EhIKCm51bV9mcmFtZXMYASABKA0SIQoGZnJhbWVzGAIgAygLMhEudG9vdGhwYXN0ZS5GcmFtZRIPCgdsX2NsaWNrGAMgASgFEg8KB3JfY2xpY2sYBCABKAUSDQoFd2hlZWwYBSABKAUSFAoMcGFja2VkRnJhbWVzGAYgASgMEhMKC3RpbWVkRnJhbWVzGAcgASgIIjUKFUNvbnN1bWVyQ29udHJvbFBhY2tldBIMCgRjb2RlGAEgAygNEg4KBmxlbmd0aBgCIAEoDSIjChFNb3VzZUppZ2dsZVBhY2tldBIOCgZlbmFibGUYASABKAgiIAoOVG91Y2hwYWRQYWNrZXQSDgoGZnJhbWVzGAEgASgMIkIKDUdhbWVwYWRQYWNrZXQSEAoIc2VxdWVuY2UYASABKA0SDwoHY2hhbmdlZBgCIAEoDRIOCgZ2YWx1ZXMYAyABKAwiIAoOS2V5RXZlbnRQYWNrZXQSDgoGZXZlbnRzGAEgASgMIiUKE0Nob3JkU2VxdWVuY2VQYWNrZXQSDgoGY2hvcmRzGAEgASgMItUDCgxDb25maWdQYWNrZXQSFgoJYWNrVHlwaW5nGAEgASgISACIAQESRgoPdW5pY29kZUZhbGxiYWNrGAIgASgOMigudG9vdGhwYXN0ZS5Db25maWdQYWNrZXQuVW5pY29kZUZhbGxiYWNrSAGIAQESNwoGbGF5b3V0GAMgASgOMicudG9vdGhwYXN0ZS5Db25maWdQYWNrZXQuS2V5Ym9hcmRMYXlvdXQSGwoOcGxheW91dERlbGF5TXMYBCABKA1IAogBASJKCg9Vbmljb2RlRmFsbGJhY2sSCAoETk9ORRAAEg4KCkFMVF9OVU1QQUQQARIQCgxDVFJMX1NISUZUX1UQAhILCgdNQUNfSEVYEAMijQEKDktleWJvYXJkTGF5b3V0Eg0KCVVOQ0hBTkdFRBAAEgkKBUVOX1VTEAESCQoFREVfREUQAhIJCgVGUl9GUhADEgkKBUVTX0VTEAQSCQoFSVRfSVQQBRIJCgVQVF9QVBAGEgkKBVBUX0JSEAcSCQoFU1ZfU0UQCBIJCgVEQV9ESxAJEgkKBUhVX0hVEApCDAoKX2Fja1R5cGluZ0ISChBfdW5pY29kZUZhbGxiYWNrQhEKD19wbGF5b3V0RGVsYXlNcyJHCgpTeW5jUGFja2V0Eg4KBm9mZnNldBgBIAEoDRIMCgR0ZXh0GAIgASgMEgwKBGRvbmUYAyABKAgSDQoFcmVzZXQYBCABKAgiRwoLTWFjcm9QYWNrZXQSDAoEc2xvdBgBIAEoDRIOCgZvZmZzZXQYAiABKA0SDAoEZGF0YRgDIAEoDBIMCgRkb25lGAQgASgIIh4KDlJ1bk1hY3JvUGFja2V0EgwKBHNsb3QYASABKA0iOgoMU2NyaXB0UGFja2V0Eg4KBm9mZnNldBgBIAEoDRIMCgRjb2RlGAIgASgMEgwKBGRvbmUYAyABKAgiIQoPQ29tcG9zaXRlUGFja2V0Eg4KBmV2ZW50cxgBIAEoDCIlCg9DbG9ja1N5bmNQYWNrZXQSEgoKY2xpZW50VGltZRgBIAEoBCL+AQoMQ2FwYWJpbGl0aWVzEhQKDG1heFdyaXRlU2l6ZRgBIAEoDRIUCgxxdWV1ZUNyZWRpdHMYAiABKA0SEwoLd2lyZUZvcm1hdHMYAyABKA0SEwoLY29tcHJlc3Npb24YBCABKA0SDAoEbmtybxgFIAEoCBIXCg9hYnNvbHV0ZVBvaW50ZXIYBiABKAgSGwoTa2V5UmVwb3J0SW50ZXJ2YWxVcxgHIAEoDRIXCg9zbG93TW9kZURlbGF5TXMYCCABKA0SEgoKbWFjcm9TbG90cxgJIAEoDRIVCg1tYWNyb1Nsb3RTaXplGAogASgNEhAKCGZlYXR1cmVzGAsgASgNYgZwcm90bzM");
 
 /**
  * Describes the message toothpaste.DataPacket.
@@ -122,3 +122,115 @@ export const ConsumerControlPacketSchema = /*@__PURE__*/
 export const MouseJigglePacketSchema = /*@__PURE__*/
   messageDesc(file_toothpacket, 9);
 
+/**
+ * Describes the message toothpaste.TouchpadPacket.
+ * Use `create(TouchpadPacketSchema)` to create a new message.
+ */
+export const TouchpadPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 10);
+
+/**
+ * Describes the message toothpaste.GamepadPacket.
+ * Use `create(GamepadPacketSchema)` to create a new message.
+ */
+export const GamepadPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 11);
+
+/**
+ * Describes the message toothpaste.KeyEventPacket.
+ * Use `create(KeyEventPacketSchema)` to create a new message.
+ */
+export const KeyEventPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 12);
+
+/**
+ * Describes the message toothpaste.ChordSequencePacket.
+ * Use `create(ChordSequencePacketSchema)` to create a new message.
+ */
+export const ChordSequencePacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 13);
+
+/**
+ * Describes the message toothpaste.ConfigPacket.
+ * Use `create(ConfigPacketSchema)` to create a new message.
+ */
+export const ConfigPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 14);
+
+/**
+ * Describes the enum toothpaste.ConfigPacket.UnicodeFallback.
+ */
+export const ConfigPacket_UnicodeFallbackSchema = /*@__PURE__*/
+  enumDesc(file_toothpacket, 14, 0);
+
+/**
+ * How characters the keyboard layout can't type are entered on the host
+ *
+ * @generated from enum toothpaste.ConfigPacket.UnicodeFallback
+ */
+export const ConfigPacket_UnicodeFallback = /*@__PURE__*/
+  tsEnum(ConfigPacket_UnicodeFallbackSchema);
+
+/**
+ * Describes the enum toothpaste.ConfigPacket.KeyboardLayout.
+ */
+export const ConfigPacket_KeyboardLayoutSchema = /*@__PURE__*/
+  enumDesc(file_toothpacket, 14, 1);
+
+/**
+ * Host keyboard layout text is typed for, remembered per paired client
+ *
+ * @generated from enum toothpaste.ConfigPacket.KeyboardLayout
+ */
+export const ConfigPacket_KeyboardLayout = /*@__PURE__*/
+  tsEnum(ConfigPacket_KeyboardLayoutSchema);
+
+/**
+ * Describes the message toothpaste.SyncPacket.
+ * Use `create(SyncPacketSchema)` to create a new message.
+ */
+export const SyncPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 15);
+
+/**
+ * Describes the message toothpaste.MacroPacket.
+ * Use `create(MacroPacketSchema)` to create a new message.
+ */
+export const MacroPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 16);
+
+/**
+ * Describes the message toothpaste.RunMacroPacket.
+ * Use `create(RunMacroPacketSchema)` to create a new message.
+ */
+export const RunMacroPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 17);
+
+/**
+ * Describes the message toothpaste.ScriptPacket.
+ * Use `create(ScriptPacketSchema)` to create a new message.
+ */
+export const ScriptPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 18);
+
+/**
+ * Describes the message toothpaste.CompositePacket.
+ * Use `create(CompositePacketSchema)` to create a new message.
+ */
+export const CompositePacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 19);
+
+/**
+ * Describes the message toothpaste.ClockSyncPacket.
+ * Use `create(ClockSyncPacketSchema)` to create a new message.
+ */
+export const ClockSyncPacketSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 20);
+
+/**
+ * Describes the message toothpaste.Capabilities.
+ * Use `create(CapabilitiesSchema)` to create a new message.
+ */
+export const CapabilitiesSchema = /*@__PURE__*/
+  messageDesc(file_toothpacket, 21);
+
@@ -6,6 +6,8 @@ import { HomeIcon, PaperAirplaneIcon, ClipboardIcon, InformationCircleIcon, Spar
 import { keyboardHandler } from '../services/inputHandlers/keyboardHandler';
 import DuckyscriptEditor from '../components/duckyscript/DuckyscriptEditor';
 import { parseDuckyscript, executeDuckyscript } from '../services/duckyscript/DuckyscriptParser';
+import { compileDuckyscript } from '../services/duckyscript/DuckyscriptCompiler';
+import { createScriptStream, Capability } from '../services/packetService/packetFunctions';
 import { DuckyscriptContext } from '../context/DuckyscriptContext';
 
 
@@ -13,7 +15,7 @@ import { DuckyscriptContext } from '../context/DuckyscriptContext';
 export default function BulkSend() {
     const [input, setInput] = useState('');
     const [selectedScript, setSelectedScript] = useState(null);
-    const { status, sendEncrypted } = useContext(BLEContext);
+    const { status, sendEncrypted, sendPaste, capabilities } = useContext(BLEContext);
     const { isUnlocked, scripts } = useContext(DuckyscriptContext);
     const editorRef = useRef(null);
 
@@ -22,13 +24,13 @@ export default function BulkSend() {
         if (!input) return;
 
         try {
-            keyboardHandler.sendKeyboardString(input, sendEncrypted);
+            await sendPaste(input); // Resumes after a dropped connection
         } 
         
         catch (error) { 
             console.error(error); 
         }
-    }, [input, sendEncrypted]);
+    }, [input, sendPaste]);
 
     const sendDuckyscript = useCallback(async () => {
         if (!selectedScript) return;
@@ -44,6 +46,16 @@ export default function BulkSend() {
                 alert('Script has errors:\n' + parseResult.errors.map(e => `Line ${e.line}: ${e.message}`).join('\n'));
                 return;
             }
+
+            // Receivers with the bytecode VM run the script themselves, with DELAYs timed on the device
+            if ((capabilities.current?.features ?? 0) & Capability.SCRIPT) {
+                const { code, errors } = compileDuckyscript(selectedScript.content);
+                if (code) {
+                    await sendEncrypted(createScriptStream(code));
+                    return;
+                }
+                console.warn('[BulkSend] Script can\'t run on the device, running it from the browser:', errors);
+            }
             
             // Helper function for async delay
             const delayFn = (ms) => new Promise(resolve => setTimeout(resolve, ms));
@@ -69,7 +81,7 @@ export default function BulkSend() {
             console.error('[BulkSend] Duckyscript execution error:', error);
             alert('Error executing script: ' + error.message);
         }
-    }, [selectedScript, sendEncrypted]);
+    }, [selectedScript, sendEncrypted, capabilities]);
 
     // Use Ctrl + Shift + Enter to send 
     const handleShortcut = useCallback((event) => {